@@ -0,0 +1,29 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC-32 and Adler-32 as used by PNG chunks and zlib streams.
+ * Both continue from a previous value, so a checksum can be built over
+ * several separate spans (a chunk type followed by its data) without copying
+ * them together. CRC-32 uses PCLMULQDQ folding when the CPU has it, else
+ * slicing-by-8 tables built at compile time; Adler-32 sums 16 bytes at a
+ * time with SSE2 and only reduces modulo 65521 once per 5552 bytes.
+ * MEFVIEW_SIMD=scalar|sse2 caps the choice like the pixel kernels.
+ */
+
+// Name of the kernels in use: "scalar", "sse2" or "pclmul"
+const char* checksumKernelName();
+
+// CRC-32 of data appended to a range whose CRC is crc; start with 0
+uint32_t checksumCrc32(uint32_t crc, const uint8_t* data, size_t size);
+
+// Adler-32 of data appended to a range whose Adler-32 is adler; start with 1
+uint32_t checksumAdler32(uint32_t adler, const uint8_t* data, size_t size);
+
+// Adler-32 of two consecutive ranges from their own checksums; size2 is the length of the second
+uint32_t checksumAdler32Combine(uint32_t adler1, uint32_t adler2, uint64_t size2);
+
+#endif // CHECKSUM_H
@@ -0,0 +1,92 @@
+#ifndef GEOMCACHE_H
+#define GEOMCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mappedfile.h"
+
+/**
+ * Persistent cache of render-ready geometry.
+ * An entry holds the interleaved vertex buffer and the per-material index
+ * lists exactly as Mesh uploads them, plus the texture bound to each material
+ * and the bounding box, so a hit goes from the mapped file straight into
+ * glBufferData without touching the vertices on the CPU.
+ * Entries are keyed by a hash of the source BODY bytes.
+ */
+
+// Vertex layout of the GPU buffer; also used by Mesh::setupMesh
+struct geomCacheVertex_t {
+    float position[3];
+    float normal[3];
+    float color[3];
+    float texcoord[2];
+};
+
+/**
+ * Expands indexed triangles into one vertex per face corner and collects the
+ * corners of each material's faces. positions, normals and colors hold three
+ * floats per vertex, texcoords two; colors may be null for white. Faces whose
+ * material is outside [0, materialCount) are left out of every index list.
+ */
+void geomInterleave(const float* positions, const float* normals, const float* colors, const float* texcoords, const int* faces, size_t faceCount, const int* faceMaterials, size_t materialCount, std::vector<geomCacheVertex_t>& interleaved, std::vector<std::vector<uint32_t>>& materialIndices);
+
+// 64-bit hash of a byte range, used as the cache key
+uint64_t geomCacheHash(const uint8_t* data, size_t size);
+
+// Cache directory: $MEFVIEW_CACHE_DIR, else a per-user cache directory.
+// Returns an empty string when caching is disabled (MEFVIEW_CACHE_DIR set but empty).
+std::string geomCacheDirectory();
+
+// Path of the entry for key, or empty when caching is disabled
+std::string geomCachePath(uint64_t key);
+
+// Cheap hit test: reads only the header and checks it and the file size.
+// geomCacheEntry_t::open still validates the rest when the entry is used.
+bool geomCacheProbe(const std::string& path, uint64_t key);
+
+/**
+ * Writes an entry; materialIndices[i] and textures[i] describe material i.
+ * The file is written next to its final path and renamed into place, so a
+ * reader never sees a partial entry.
+ */
+bool geomCacheStore(const std::string& path, uint64_t key, const std::vector<geomCacheVertex_t>& vertices, const std::vector<std::vector<uint32_t>>& materialIndices, const std::vector<std::string>& textures);
+
+// Read-only view of render-ready geometry, mapped from a stored entry or built in memory
+class geomCacheEntry_t {
+public:
+    // Fails quietly when the file is missing, stale, or was written for another key
+    bool open(const std::string& path, uint64_t key);
+    // Takes over freshly built buffers, e.g. on a cache miss
+    void assign(std::vector<geomCacheVertex_t>&& vertices, const std::vector<std::vector<uint32_t>>& materialIndices, const std::vector<std::string>& materialTextures);
+    void close();
+
+    size_t vertexCount() const { return vertex_count; }
+    const geomCacheVertex_t* vertices() const { return vertex_data; }
+
+    size_t materialCount() const { return textures.size(); }
+    const uint32_t* indices(size_t material) const { return index_data + ranges[material].first; }
+    size_t indexCount(size_t material) const { return ranges[material].second; }
+    const std::string& texture(size_t material) const { return textures[material]; }
+
+    // Bounding box of the vertex positions, three floats each
+    const float* boundsMin() const { return bounds_min; }
+    const float* boundsMax() const { return bounds_max; }
+
+private:
+    mappedFile_t file;
+    std::vector<geomCacheVertex_t> owned_vertices;
+    std::vector<uint32_t> owned_indices;
+    const geomCacheVertex_t* vertex_data = nullptr;
+    const uint32_t* index_data = nullptr;
+    size_t vertex_count = 0;
+    std::vector<std::pair<size_t, size_t>> ranges;  // First index and count per material
+    std::vector<std::string> textures;
+    float bounds_min[3] = {};
+    float bounds_max[3] = {};
+};
+
+#endif // GEOMCACHE_H
@@ -0,0 +1,79 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+enum class logLevel_t : int {
+    Debug = 0,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+enum class logCategory_t : int {
+    General = 0,
+    Mesh,
+    Texture,
+    Archive,
+    Mtp,
+    Render,
+    Count
+};
+
+extern std::atomic<int> logMinLevel;
+extern std::atomic<unsigned> logCategoryMask;
+
+// Cheap check done before any message is formatted
+inline bool logEnabled(logLevel_t level, logCategory_t category) {
+    return static_cast<int>(level) >= logMinLevel.load(std::memory_order_relaxed)
+        && (logCategoryMask.load(std::memory_order_relaxed) & (1u << static_cast<int>(category))) != 0;
+}
+
+void logSetLevel(logLevel_t level);
+void logSetCategory(logCategory_t category, bool enabled);
+
+// Applies a comma-separated setting such as "debug", "warning,mesh,archive" or "off".
+// A level name sets the minimum level; naming categories limits output to them.
+// Returns false and changes nothing when a name is not recognized.
+bool logConfigure(const std::string& setting);
+
+/**
+ * Debug and info messages go straight to std::cout and errors to std::cerr.
+ * Warnings are pushed into a fixed-size lock-free ring so parser threads never
+ * block on console I/O; they are written out by logFlush().
+ * If the ring is full the warning is dropped and counted.
+ */
+void logWrite(logLevel_t level, logCategory_t category, const std::string& message);
+
+// Drains queued warnings to out and returns how many were written
+size_t logFlush(std::ostream& out);
+
+// Number of warnings dropped because the ring was full
+size_t logDropped();
+
+#define LOG_AT(level, category, expr) \
+    do { \
+        if (logEnabled(level, category)) { \
+            std::ostringstream log_stream_; \
+            log_stream_ << expr; \
+            logWrite(level, category, log_stream_.str()); \
+        } \
+    } while (0)
+
+// Debug output is only compiled in when MEFVIEW_LOG_DEBUG is defined
+#ifdef MEFVIEW_LOG_DEBUG
+#define LOG_DEBUG(category, expr) LOG_AT(logLevel_t::Debug, category, expr)
+#else
+#define LOG_DEBUG(category, expr) do {} while (0)
+#endif
+
+#define LOG_INFO(category, expr) LOG_AT(logLevel_t::Info, category, expr)
+#define LOG_WARN(category, expr) LOG_AT(logLevel_t::Warning, category, expr)
+#define LOG_ERROR(category, expr) LOG_AT(logLevel_t::Error, category, expr)
+
+#endif // LOG_H
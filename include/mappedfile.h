@@ -0,0 +1,185 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <ios>
+#include <vector>
+
+/**
+ * Read-only view of an entire file mapped into the address space.
+ * The view stays valid until close() is called or the object is destroyed.
+ */
+class mappedFile_t {
+public:
+    mappedFile_t();
+    ~mappedFile_t();
+
+    mappedFile_t(const mappedFile_t&) = delete;
+    mappedFile_t& operator=(const mappedFile_t&) = delete;
+    mappedFile_t(mappedFile_t&& other) noexcept;
+    mappedFile_t& operator=(mappedFile_t&& other) noexcept;
+
+    bool open(const std::string& filePath);
+    void close();
+
+    bool is_open() const { return view != nullptr; }
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* view;
+    size_t length;
+#ifdef _WIN32
+    void* hFile;
+    void* hMapping;
+#else
+    int fd;
+#endif
+};
+
+/**
+ * Bounds-checked read cursor over a contiguous byte buffer.
+ * Mirrors the subset of std::ifstream used by the parsers (read, get, tellg,
+ * seekg, good) so a parser can switch over by changing its parameter type.
+ * Reads past the end set the fail state and zero-fill the destination.
+ */
+class byteStream_t {
+public:
+    byteStream_t() : base(nullptr), length(0), pos(0), failed(false) {}
+    byteStream_t(const uint8_t* data, size_t size) : base(data), length(size), pos(0), failed(false) {}
+    explicit byteStream_t(const mappedFile_t& file) : base(file.data()), length(file.size()), pos(0), failed(false) {}
+
+    byteStream_t& read(char* dst, size_t n) {
+        if (failed || n > length - pos) {
+            std::memset(dst, 0, n);
+            failed = true;
+            pos = length;
+            return *this;
+        }
+        std::memcpy(dst, base + pos, n);
+        pos += n;
+        return *this;
+    }
+
+    byteStream_t& get(char& ch) {
+        return read(&ch, 1);
+    }
+
+    // Advances past n bytes without copying them
+    byteStream_t& skip(size_t n) {
+        if (failed || n > length - pos) {
+            failed = true;
+            pos = length;
+        } else {
+            pos += n;
+        }
+        return *this;
+    }
+
+    size_t tellg() const { return pos; }
+
+    byteStream_t& seekg(size_t offset) {
+        if (offset > length) {
+            failed = true;
+            pos = length;
+        } else {
+            pos = offset;
+        }
+        return *this;
+    }
+
+    byteStream_t& seekg(std::streamoff offset, std::ios::seekdir dir) {
+        std::streamoff origin = 0;
+        if (dir == std::ios::cur) {
+            origin = static_cast<std::streamoff>(pos);
+        } else if (dir == std::ios::end) {
+            origin = static_cast<std::streamoff>(length);
+        }
+        if (origin + offset < 0) {
+            failed = true;
+            pos = 0;
+            return *this;
+        }
+        return seekg(static_cast<size_t>(origin + offset));
+    }
+
+    bool is_open() const { return base != nullptr; }
+    bool good() const { return !failed; }
+    bool eof() const { return pos >= length; }
+    void clear() { failed = false; }
+    explicit operator bool() const { return !failed; }
+    bool operator!() const { return failed; }
+
+    // Direct access to the unread bytes, used by bulk decoders
+    const uint8_t* data() const { return base; }
+    const uint8_t* ptr() const { return base + pos; }
+    size_t size() const { return length; }
+    size_t remaining() const { return length - pos; }
+
+private:
+    const uint8_t* base;
+    size_t length;
+    size_t pos;
+    bool failed;
+};
+
+/**
+ * Growable in-memory output buffer, the write-side counterpart of byteStream_t.
+ * Mirrors the subset of std::ofstream used by the writers (write, put, tellp,
+ * good) so a serializer can assemble a whole file and hand it to the OS in a
+ * single write.
+ */
+class byteWriter_t {
+public:
+    byteWriter_t() {}
+
+    byteWriter_t& write(const char* src, size_t n) {
+        buffer.insert(buffer.end(), reinterpret_cast<const uint8_t*>(src), reinterpret_cast<const uint8_t*>(src) + n);
+        return *this;
+    }
+
+    byteWriter_t& put(char ch) {
+        buffer.push_back(static_cast<uint8_t>(ch));
+        return *this;
+    }
+
+    // Appends n uninitialized bytes and returns them, used by bulk encoders
+    uint8_t* append(size_t n) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + n);
+        return buffer.data() + offset;
+    }
+
+    // Overwrites bytes already written, e.g. a size field known only at the end
+    void patch(size_t offset, const void* src, size_t n) {
+        if (offset <= buffer.size() && n <= buffer.size() - offset) {
+            std::memcpy(buffer.data() + offset, src, n);
+        }
+    }
+
+    // Zero-fills up to the next multiple of alignment, counted from offset start
+    void pad(size_t start, size_t alignment) {
+        size_t used = (buffer.size() - start) % alignment;
+        if (used != 0) {
+            buffer.resize(buffer.size() + alignment - used, 0);
+        }
+    }
+
+    size_t tellp() const { return buffer.size(); }
+    bool good() const { return true; }
+    explicit operator bool() const { return true; }
+
+    void reserve(size_t n) { buffer.reserve(n); }
+    void clear() { buffer.clear(); }
+
+    const uint8_t* data() const { return buffer.data(); }
+    size_t size() const { return buffer.size(); }
+    const std::vector<uint8_t>& bytes() const { return buffer; }
+
+private:
+    std::vector<uint8_t> buffer;
+};
+
+#endif // MAPPEDFILE_H
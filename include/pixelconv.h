@@ -0,0 +1,68 @@
+#ifndef PIXELCONV_H
+#define PIXELCONV_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Pixel-format conversion kernels for texture decoding.
+ * Each kernel has scalar, SSE2 and AVX2 versions; the widest one the CPU
+ * supports is picked on first use. MEFVIEW_SIMD=scalar|sse2|avx2 caps the
+ * choice, e.g. to compare against the scalar reference.
+ * Counts are in pixels. Source and destination must not overlap unless the
+ * kernel works in place.
+ */
+
+// Byte order of 32-bit output pixels
+enum class pixelOrder_t {
+    RGBA,
+    BGRA
+};
+
+// Name of the kernel set in use: "scalar", "sse2" or "avx2"
+const char* pixelKernelName();
+
+// Little-endian ARGB1555: alpha from the top bit, colour channels shifted up by 3 (matching the TEX reader)
+void pixelConvert1555To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order);
+
+// Little-endian RGB565, channels expanded by bit replication, alpha 255
+void pixelConvert565To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order);
+
+// Little-endian ARGB4444, channels expanded by bit replication
+void pixelConvert4444To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order);
+
+// 24-bit to 32-bit keeping the channel order, alpha 255
+void pixelExpand24To32(const uint8_t* src, uint8_t* dst, size_t count);
+
+// 8-bit intensity replicated into all four channels
+void pixelExpandIntensity8(const uint8_t* src, uint8_t* dst, size_t count);
+
+// Looks up 8-bit indices in a 256-entry table of 32-bit pixels
+void pixelExpandIndexed8(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count);
+
+// Same for 4-bit indices packed two per byte, low nibble first; palette needs 16 entries
+void pixelExpandIndexed4(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count);
+
+// Writes count copies of one pixel of pixelSize bytes (any size; 4-byte pixels use vector stores)
+void pixelFill(uint8_t* dst, const uint8_t* pixel, size_t pixelSize, size_t count);
+
+// Swaps bytes 0 and 2 of every 32-bit pixel in place (RGBA <-> BGRA)
+void pixelSwapRB32(uint8_t* data, size_t count);
+
+// Reverses the order of count 32-bit pixels in place (mirror one row)
+void pixelReverse32(uint8_t* data, size_t count);
+
+// Exchanges two non-overlapping rows of rowBytes bytes
+void pixelSwapRows(uint8_t* a, uint8_t* b, size_t rowBytes);
+
+// Mirrors an image vertically in place
+void pixelFlipRows(uint8_t* data, size_t rowBytes, size_t rows);
+
+/**
+ * Box-filters a 32-bit image to half size (at least 1x1) for the next mip
+ * level; each output pixel is the rounded mean of a 2x2 block. An odd last
+ * row or column is dropped, a 1-pixel-wide edge is averaged with itself.
+ */
+void pixelDownsample2x(const uint8_t* src, size_t width, size_t height, uint8_t* dst);
+
+#endif // PIXELCONV_H
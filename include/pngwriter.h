@@ -0,0 +1,69 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class threadPool_t;
+
+/**
+ * PNG encoder for texture exports.
+ * Each scanline gets the filter (None, Sub, Up, Average or Paeth) whose output
+ * has the smallest sum of absolute differences, and the filtered image is
+ * compressed with zlib's deflate. Rows are pulled from a row source and the
+ * file goes out through a sink in IDAT chunks of at most 64 KB, so only a few
+ * rows are held at a time. Given a thread pool, large images are filtered and
+ * compressed in independent segments that are joined into a single zlib
+ * stream, pigz style.
+ */
+
+// Trade-off between encoding speed and file size
+enum class pngLevel_t {
+    Fast,    // Sub filter on every row, zlib level 1
+    Default, // Adaptive filters, zlib level 6
+    Small    // Adaptive filters, zlib level 9 with the largest hash tables
+};
+
+// Parses "fast", "default" or "small"
+bool pngParseLevel(const std::string& name, pngLevel_t& level);
+const char* pngLevelName(pngLevel_t level);
+
+struct pngOptions_t {
+    pngLevel_t level = pngLevel_t::Default;
+    bool flipV = false;   // Write the rows bottom to top
+    bool reverse = false; // Mirror every row
+    bool swapRB = false;  // Rows are BGR(A), as in TGA; red and blue are swapped while reading
+    // Compresses segments in parallel when set; may be a pool the caller is running on
+    threadPool_t* pool = nullptr;
+};
+
+/**
+ * Returns row y (top to bottom as stored, width * channels bytes), either
+ * pointing into the caller's image or filled into scratch, which has room for
+ * one row. The row must stay valid until scratch is passed again. Called from
+ * several threads at once when options.pool is set.
+ */
+typedef std::function<const uint8_t*(uint32_t y, uint8_t* scratch)> pngRowSource_t;
+
+// Receives the encoded file in order; returning false aborts the encode
+typedef std::function<bool(const uint8_t* data, size_t size)> pngSink_t;
+
+// Encodes 8-bit RGB (channels 3) or RGBA (channels 4) rows; flipV and reverse are applied while reading them
+bool pngWriteRows(const pngRowSource_t& rows, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options, const pngSink_t& sink);
+
+/**
+ * Encodes 8-bit RGB (channels 3) or RGBA (channels 4) pixels, packed rows top
+ * to bottom, into a complete PNG file in out. The pixels are not modified.
+ */
+bool pngEncode(const uint8_t* pixels, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options, std::vector<uint8_t>& out);
+
+// Same, streamed to path
+bool pngSave(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options);
+
+// Wraps data in a zlib stream (header, deflate data, Adler-32) at the given level
+bool pngCompress(const uint8_t* data, size_t size, pngLevel_t level, std::vector<uint8_t>& out);
+
+#endif // PNGWRITER_H
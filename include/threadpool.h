@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size pool of worker threads fed from a FIFO task queue.
+ * Tasks must not throw; wait() blocks until every submitted task has finished.
+ * parallelFor only waits for its own items and may be called from a worker.
+ */
+class threadPool_t {
+public:
+    // threads == 0 uses one worker per hardware thread
+    explicit threadPool_t(unsigned threads = 0);
+    ~threadPool_t();
+
+    threadPool_t(const threadPool_t&) = delete;
+    threadPool_t& operator=(const threadPool_t&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    // Runs fn(i) for every i in [0, count) across the pool and the calling thread,
+    // returning once all of them are done; queued tasks are run while waiting
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Process-wide pool sized to the machine, created on first use
+    static threadPool_t& shared();
+
+private:
+    void workerLoop();
+    // Pops and runs one queued task; lock is held on entry and on return
+    void runOne(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    std::condition_variable helperDone; // A parallelFor helper finished
+    size_t active;
+    bool stopping;
+};
+
+#endif // THREADPOOL_H
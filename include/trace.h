@@ -0,0 +1,70 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Wall-clock phase tracing for the "open file to first frame" benchmark.
+ * Tracing is off until traceStart() is called; while off a tracePhase_t costs
+ * a single relaxed load. Phases may nest and are reported in start order.
+ */
+typedef std::chrono::steady_clock traceClock_t;
+
+extern std::atomic<bool> traceActive;
+
+inline bool traceEnabled() {
+    return traceActive.load(std::memory_order_relaxed);
+}
+
+// Enables tracing; all times are reported relative to this call
+void traceStart();
+
+void traceRecord(const char* name, traceClock_t::time_point begin, traceClock_t::time_point end);
+
+// Records a phase that started at begin and ends now
+inline void traceRecordSince(const char* name, traceClock_t::time_point begin) {
+    if (traceEnabled()) {
+        traceRecord(name, begin, traceClock_t::now());
+    }
+}
+
+// Free-form key/value pairs written alongside the phases (file, renderer, ...)
+void traceSetInfo(const std::string& key, const std::string& value);
+
+/**
+ * Arms the first-frame probe: the next traceFrameDrawn() records the
+ * "first_frame" phase and calls onFirstFrame once.
+ */
+void traceArmFirstFrame(void (*onFirstFrame)());
+bool traceFrameArmed();
+void traceFrameDrawn();
+bool traceFirstFrameDone();
+
+// Writes {"info": {...}, "total_ms": n, "phases": [...]} as a single JSON object
+void traceWriteJson(std::ostream& out);
+
+class tracePhase_t {
+public:
+    explicit tracePhase_t(const char* phaseName) : name(traceEnabled() ? phaseName : nullptr) {
+        if (name) {
+            begin = traceClock_t::now();
+        }
+    }
+    ~tracePhase_t() {
+        if (name) {
+            traceRecord(name, begin, traceClock_t::now());
+        }
+    }
+
+    tracePhase_t(const tracePhase_t&) = delete;
+    tracePhase_t& operator=(const tracePhase_t&) = delete;
+
+private:
+    const char* name;
+    traceClock_t::time_point begin;
+};
+
+#endif // TRACE_H
@@ -20,8 +20,10 @@
 #include <algorithm>
 #include <chrono>
 #include <unordered_map>
+#include <memory>
 
 #include "resource.h"
+#include "geomcache.h"
 
 enum Tool {
     MOVE,
@@ -61,10 +63,11 @@ public:
     void applyRandomColors();
     void apply() const;
     void setAlpha(float v);
-    void loadTextureFromMemory(const unsigned char* data, int width, int height, int channels);
+    // mipLevels are the levels below data, largest first; without them the driver builds the chain
+    void loadTextureFromMemory(const unsigned char* data, int width, int height, int channels, const std::vector<const unsigned char*>& mipLevels = {});
 
 private:
-    GLuint loadTextureFromMemoryInternal(const unsigned char* data, int width, int height, int channels);
+    GLuint loadTextureFromMemoryInternal(const unsigned char* data, int width, int height, int channels, const std::vector<const unsigned char*>& mipLevels = {});
 };
 
 class Mesh {
@@ -91,6 +94,8 @@ public:
 
     std::vector<GLuint> materialEBOs;
     std::vector<GLsizei> materialCounts;
+    // Set when the buffers came straight from a geometry cache entry; the CPU arrays then stay empty until expandCachedGeometry
+    std::shared_ptr<const geomCacheEntry_t> cachedGeometry;
     enum RenderMode {
         Wireframe,
         EdgeWires,
@@ -113,6 +118,8 @@ public:
     Mesh();
     ~Mesh();
     Mesh(const std::vector<glm::vec3>& vertices, const std::vector<glm::ivec3>& faces, const std::vector<int>& materialIDs, const std::vector<glm::vec2>& tverts, const std::vector<Materialm>& materials, const std::vector<glm::vec3>& normals);
+    // Mesh drawn from a cache entry; call uploadGpuBuffers once it is in place
+    Mesh(std::shared_ptr<const geomCacheEntry_t> cached, const std::vector<Materialm>& materials);
 
 
 
@@ -125,6 +132,13 @@ public:
     void toggleMaterial();
     void toggleBackfaceCull();
     void setupMesh();
+    // Interleaved vertex buffer and per-material index lists as setupMesh uploads them
+    void buildGpuBuffers(std::vector<geomCacheVertex_t>& interleaved, std::vector<std::vector<uint32_t>>& materialIndices) const;
+    // Creates the VAO, VBO and material EBOs from prebuilt buffers, e.g. a mapped cache entry
+    void uploadGpuBuffers(const geomCacheVertex_t* interleaved, size_t vertexCount, const std::vector<const uint32_t*>& materialIndices, const std::vector<size_t>& materialIndexCounts);
+    // Fills the CPU arrays of a cached mesh, one vertex per face corner, for tools that edit or list them
+    void expandCachedGeometry();
+    size_t triangleCount() const;
     void setupShader(GLuint shaderProgram, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos, const std::vector<glm::vec3>& lightPositions, const std::vector<glm::vec3>& lightColors);
     void drawBoundingBox(const glm::mat4& view, const glm::mat4& projection);
     void drawGappedSegment(glm::vec3 start, glm::vec3 end, float gapPercentage);
@@ -183,6 +197,8 @@ public:
 
     bool drawGradientBackground;
     Mesh addMesh(const std::vector<glm::vec3>& vertices, const std::vector<glm::ivec3>& faces, const std::vector<int>& materialIDs, const std::vector<glm::vec2>& tverts, const std::vector<Materialm>& materials, const std::vector<glm::vec3>& normals);
+    // Adds a mesh stored in the geometry cache and uploads its buffers straight from the entry
+    bool addCachedMesh(std::shared_ptr<const geomCacheEntry_t> cache, const std::vector<Materialm>& materials);
     void loadMeshTextures();
     void zoomExtents();
     void clearMeshes();
@@ -1,5 +1,6 @@
 // main.cpp
 
+#ifndef MEFVIEW_HEADLESS
 #include <FL/Fl.H>
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Menu_Bar.H>
@@ -22,8 +23,18 @@
 #include "viewport3d.h" // Ensure this header includes all necessary declarations
 #include "stringext.h"
 #include "filesystem.h"
-
+#include "trace.h"
+#include "geomcache.h"
 #include <glm/glm.hpp>
+#endif // MEFVIEW_HEADLESS
+
+#include "mappedfile.h"
+#include "threadpool.h"
+#include "log.h"
+#include "pixelconv.h"
+#include "pngwriter.h"
+#include "checksum.h"
+
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -35,23 +46,68 @@
 #include <cstring> // For memset
 #include <algorithm>  // For std::find_if
 #include <cmath>
+#include <cstdlib>
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <filesystem>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#ifdef MEFVIEW_BENCHMARK
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <zlib.h>
+#endif
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
 
 
 using namespace std;
 
 // Template functions for readValueing and writing data
 template <typename T>
-void readValue(std::ifstream &f, T &data) {
+void readValue(byteStream_t &f, T &data) {
     f.read(reinterpret_cast<char*>(&data), sizeof(T));
 }
 
-template <typename T>
-void writeValue(std::ofstream &f, const T &data) {
+// Works with std::ofstream and byteWriter_t alike
+template <typename Stream, typename T>
+void writeValue(Stream &f, const T &data) {
     f.write(reinterpret_cast<const char*>(&data), sizeof(T));
 }
 
+// Reads count fixed-size records in a single copy; T must match the on-disk layout
+template <typename T, typename Alloc>
+void readArray(byteStream_t &f, std::vector<T, Alloc> &data, size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "readArray requires a trivially copyable record");
+    data.resize(count);
+    if (count == 0) {
+        return;
+    }
+    size_t available = std::min(count, f.remaining() / sizeof(T));
+    if (available > 0) {
+        std::memcpy(data.data(), f.ptr(), available * sizeof(T));
+    }
+    f.skip(count * sizeof(T)); // Flags the stream if the payload was truncated
+}
+
+// Writes every record in a single copy; the counterpart of readArray
+template <typename T, typename Alloc>
+void writeArray(byteWriter_t &f, const std::vector<T, Alloc> &data) {
+    static_assert(std::is_trivially_copyable<T>::value, "writeArray requires a trivially copyable record");
+    f.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+}
+
 // Function to swap byte order for 16-bit integers
 uint16_t swapEndian16(uint16_t val) {
     return (val << 8) | (val >> 8);
@@ -72,16 +128,17 @@ int32_t swapEndian32Signed(int32_t val) {
 }
 
 // Function to read a null-terminated string
-bool readString(std::ifstream &f, std::string &str) {
-    char ch;
+bool readString(byteStream_t &f, std::string &str) {
     str.clear();
-    while (f.get(ch)) {
-        if (ch == '\0') {
-            return true;
-        }
-        str += ch;
-    }
-    return false; // Failed to read string
+    const char* start = reinterpret_cast<const char*>(f.ptr());
+    const char* terminator = static_cast<const char*>(std::memchr(start, '\0', f.remaining()));
+    if (terminator == nullptr) {
+        f.skip(f.remaining() + 1); // Consume the rest and flag the failure
+        return false; // Failed to read string
+    }
+    str.assign(start, terminator);
+    f.skip(str.size() + 1);
+    return true;
 }
 
 // Helper function to convert integer to FourCC string
@@ -129,6 +186,21 @@ std::string get_filename_without_extension(const std::string& filename) {
     return filename.substr(pos1 + 1);
 }
 
+// Case-insensitive extension test, e.g. hasExtension("A.TEX", ".tex")
+bool hasExtension(const std::string& filename, const char* ext) {
+    std::string actual = get_extension(filename);
+    size_t length = std::strlen(ext);
+    if (actual.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(actual[i])) != std::tolower(static_cast<unsigned char>(ext[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 
 
 
@@ -138,11 +210,11 @@ std::string get_filename_without_extension(const std::string& filename) {
 
 // Template specialization for reading big endian values
 template <typename T>
-bool readValueBE(std::ifstream &f, T &data);
+bool readValueBE(byteStream_t &f, T &data);
 
 // Specialization for uint16_t
 template <>
-bool readValueBE<uint16_t>(std::ifstream &f, uint16_t &data) {
+bool readValueBE<uint16_t>(byteStream_t &f, uint16_t &data) {
     if (!f.read(reinterpret_cast<char*>(&data), sizeof(uint16_t))) {
         return false;
     }
@@ -152,27 +224,23 @@ bool readValueBE<uint16_t>(std::ifstream &f, uint16_t &data) {
 
 // Specialization for uint32_t
 template <>
-bool readValueBE<uint32_t>(std::ifstream &f, uint32_t &data) {
+bool readValueBE<uint32_t>(byteStream_t &f, uint32_t &data) {
     char buffer[4];
     if (!f.read(buffer, sizeof(uint32_t))) {
         return false;
     }
-    std::cout << "Read bytes: "
-              << std::hex << (unsigned char)buffer[0] << " "
-              << (unsigned char)buffer[1] << " "
-              << (unsigned char)buffer[2] << " "
-              << (unsigned char)buffer[3] << std::dec << std::endl;
     data = (unsigned char)buffer[0] << 24 |
            (unsigned char)buffer[1] << 16 |
            (unsigned char)buffer[2] << 8  |
            (unsigned char)buffer[3];
+    LOG_DEBUG(logCategory_t::General, "Read bytes: " << std::hex << data << std::dec);
     return true;
 }
 
 
 // Specialization for int32_t
 template <>
-bool readValueBE<int32_t>(std::ifstream &f, int32_t &data) {
+bool readValueBE<int32_t>(byteStream_t &f, int32_t &data) {
     if (!f.read(reinterpret_cast<char*>(&data), sizeof(int32_t))) {
         return false;
     }
@@ -182,8 +250,13 @@ bool readValueBE<int32_t>(std::ifstream &f, int32_t &data) {
 
 // Function to check if a file exists
 bool fileExists(const std::string& filename) {
+#ifdef _WIN32
     DWORD fileAttr = GetFileAttributesA(filename.c_str());
     return (fileAttr != INVALID_FILE_ATTRIBUTES && !(fileAttr & FILE_ATTRIBUTE_DIRECTORY));
+#else
+    struct stat st;
+    return stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+#endif
 }
 
 // Function to generate a unique filename if the file already exists
@@ -265,14 +338,44 @@ enum class MeshResourceType : uint32_t {
 
 };
 
+// Dense slot per MEF chunk FourCC so mefFile_t can index its chunks in a flat table
+const size_t MEF_CHUNK_SLOTS = 21;
+
+constexpr int mefChunkSlot(uint32_t type) {
+    switch (static_cast<MeshResourceType>(type)) {
+        case MeshResourceType::MESH: return 0;
+        case MeshResourceType::ATTA: return 1;
+        case MeshResourceType::MVTX: return 2;
+        case MeshResourceType::RD3D: return 3;
+        case MeshResourceType::GLOW: return 4;
+        case MeshResourceType::HIER: return 5;
+        case MeshResourceType::BNAM: return 6;
+        case MeshResourceType::FACE: return 7;
+        case MeshResourceType::EDGE: return 8;
+        case MeshResourceType::LTMP: return 9;
+        case MeshResourceType::SMES: return 10;
+        case MeshResourceType::REND: return 11;
+        case MeshResourceType::VRTX: return 12;
+        case MeshResourceType::CVTX: return 13;
+        case MeshResourceType::SVTX: return 14;
+        case MeshResourceType::CFCE: return 15;
+        case MeshResourceType::SFAC: return 16;
+        case MeshResourceType::CMAT: return 17;
+        case MeshResourceType::CSPH: return 18;
+        case MeshResourceType::MRPH: return 19;
+        case MeshResourceType::CMSH: return 20;
+        default: return -1;
+    }
+}
+
 struct mefMeshResource {
     virtual ~mefMeshResource() {}
 
     // Virtual function for reading
-    virtual void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) = 0;
+    virtual void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) = 0;
 
     // Virtual function for writing
-    virtual void writeData(std::ofstream &f) const = 0;
+    virtual void writeData(byteWriter_t &f) const = 0;
 
     // Virtual function for converting to string
     virtual std::string to_string() const = 0;
@@ -308,7 +411,7 @@ struct mefDateStamp_t {
                   << std::endl;
     }
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, year);       // Read year
         readValue(f, month);      // Read month
         readValue(f, day);        // Read day
@@ -317,10 +420,10 @@ struct mefDateStamp_t {
         readValue(f, second);     // Read second
         readValue(f, millisecond); // Read millisecond
 
-        print_date_as_string();
+        LOG_DEBUG(logCategory_t::Mesh, "Date: " << to_string());
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, year);       // Write year
         writeValue(f, month);      // Write month
         writeValue(f, day);        // Write day
@@ -354,14 +457,14 @@ struct mefMeshSphere_t {
         radius = 0.0f;
     }
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, origin[0]); // Read x
         readValue(f, origin[1]); // Read y
         readValue(f, origin[2]); // Read z
         readValue(f, radius);     // Read radius
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, origin[0]); // Write x
         writeValue(f, origin[1]); // Write y
         writeValue(f, origin[2]); // Write z
@@ -381,13 +484,15 @@ struct mefMeshSphere_t {
 
 
 struct mefMeshHier_t : public mefMeshResource {
+    static constexpr MeshResourceType kind = MeshResourceType::HIER;
+
     std::vector<uint8_t> num_children;   // Store number of children as bytes
     std::vector<std::array<float, 3>> position; // Store positions as arrays of floats
 
     mefMeshHier_t() {}
 
     // Override readData method
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         if (count > 0) {
             num_children.resize(count);
             position.resize(count);
@@ -409,7 +514,7 @@ struct mefMeshHier_t : public mefMeshResource {
     }
 
     // Override writeData method
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         size_t count = num_children.size();
         if (count > 0) {
             for (const auto &child : num_children) {
@@ -450,12 +555,14 @@ private:
 
 
 struct mefMeshBNam_t : public mefMeshResource {
+    static constexpr MeshResourceType kind = MeshResourceType::BNAM;
+
     std::vector<std::string> names; // Vector to hold bone names
 
     mefMeshBNam_t() {}
 
     // Override readData method
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         names.clear(); // Clear existing names
 
         if (count > 0) {
@@ -476,7 +583,7 @@ struct mefMeshBNam_t : public mefMeshResource {
     }
 
     // Override writeData method
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const std::string &name : names) {
             std::string padded_name = name;
             padded_name.resize(16, '\0'); // Pad name to 16 characters
@@ -496,6 +603,8 @@ struct mefMeshBNam_t : public mefMeshResource {
 
 
 struct mefMesh_t : public mefMeshResource {
+    static constexpr MeshResourceType kind = MeshResourceType::MESH;
+
     float unk01;
     mefDateStamp_t date;
     uint32_t model_type;
@@ -529,7 +638,7 @@ struct mefMesh_t : public mefMeshResource {
     }
 
     // Existing read function
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, unk01);
         date.read(f);
         readValue(f, model_type);
@@ -559,7 +668,7 @@ struct mefMesh_t : public mefMeshResource {
     }
 
     // Existing write function
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, unk01);
         date.write(f);
         writeValue(f, model_type);
@@ -589,12 +698,12 @@ struct mefMesh_t : public mefMeshResource {
     }
 
     // Overridden readData function
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         read(f);
     }
 
     // Overridden writeData function
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         write(f);
     }
 
@@ -641,6 +750,8 @@ struct mefMesh_t : public mefMeshResource {
 
 
 struct mefMeshAttaEntry_t {
+    static constexpr uint32_t disk_size = 72; // 16 name bytes, 3x4 floats, unk43, bone_index
+
     std::string name;          // Name (up to 16 bytes)
     float unk42[3][4];        // 3x4 array
     uint32_t unk43;           // Unknown 32-bit integer
@@ -653,7 +764,7 @@ struct mefMeshAttaEntry_t {
         bone_index = 0;
     }
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         name.clear();
         char b;
 
@@ -679,7 +790,7 @@ struct mefMeshAttaEntry_t {
         readValue(f, bone_index);      // Read bone_index
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         std::string name_bytes = name.substr(0, 16); // Limit to 16 bytes
         name_bytes.resize(16, '\0'); // Pad with null bytes
 
@@ -717,9 +828,13 @@ struct mefMeshAttaEntry_t {
 };
 
 struct mefMeshAtta_t : public mefMeshResource {
-    std::vector<mefMeshAttaEntry_t> entries; // Vector to hold entries
+    static constexpr MeshResourceType kind = MeshResourceType::ATTA;
+
+    std::pmr::vector<mefMeshAttaEntry_t> entries; // Vector to hold entries
 
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    explicit mefMeshAtta_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entries(mr) {}
+
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entries.clear();  // Clear previous entries
         if (count > 0) {
             entries.resize(count); // Resize vector to hold 'count' entries
@@ -729,7 +844,7 @@ struct mefMeshAtta_t : public mefMeshResource {
         }
     }
 
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &entry_item : entries) {
             entry_item.write(f); // Write each entry
         }
@@ -746,32 +861,21 @@ struct mefMeshAtta_t : public mefMeshResource {
 
 
 struct mefMeshFace_t : public mefMeshResource {
-    std::vector<std::array<uint16_t, 3>> entry; // Using array for fixed size faces
+    static constexpr MeshResourceType kind = MeshResourceType::FACE;
 
-    mefMeshFace_t() {
-        entry.clear();
-    }
+    std::pmr::vector<std::array<uint16_t, 3>> entry; // Using array for fixed size faces
+
+    explicit mefMeshFace_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Corrected readData function to match the base class
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
-        entry.clear();
-        if (count > 0) {
-            entry.resize(count); // Resize to count
-            for (size_t i = 0; i < count; ++i) {
-                readValue(f, entry[i][0]); // Read first index
-                readValue(f, entry[i][1]); // Read second index
-                readValue(f, entry[i][2]); // Read third index
-            }
-        }
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
+        static_assert(sizeof(entry[0]) == 6, "FACE record is three uint16_t indices");
+        readArray(f, entry, count);
     }
 
     // Corrected writeData function to match the base class
-    void writeData(std::ofstream &f) const override {
-        for (const auto& face : entry) {
-            writeValue(f, face[0]); // Write first index
-            writeValue(f, face[1]); // Write second index
-            writeValue(f, face[2]); // Write third index
-        }
+    void writeData(byteWriter_t &f) const override {
+        writeArray(f, entry);
     }
 
     std::string to_string() const override {
@@ -784,35 +888,22 @@ struct mefMeshFace_t : public mefMeshResource {
 };
 
 struct mefMeshMVtx_t : public mefMeshResource {
-    std::vector<std::array<float, 4>> entry; // Using array for fixed size vertices
+    static constexpr MeshResourceType kind = MeshResourceType::MVTX;
 
-    mefMeshMVtx_t() {
-        entry.clear();
-    }
+    std::pmr::vector<std::array<float, 4>> entry; // Using array for fixed size vertices
+
+    explicit mefMeshMVtx_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Override readData to match the base class signature
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
-        entry.clear();
-        if (count > 0) {
-            entry.resize(count); // Resize to count
-            for (size_t i = 0; i < count; ++i) {
-                readValue(f, entry[i][0]); // Read x
-                readValue(f, entry[i][1]); // Read y
-                readValue(f, entry[i][2]); // Read z
-                readValue(f, entry[i][3]); // Read w
-            }
-        }
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
+        static_assert(sizeof(entry[0]) == 16, "MVTX record is four floats");
+        readArray(f, entry, count);
     }
 
     // Override writeData to match the base class signature
-    void writeData(std::ofstream &f) const override {
-        uint32_t count = static_cast<uint32_t>(entry.size());
-        writeValue(f, count); // Write the count of vertices
-        for (const auto& vertex : entry) {
-            for (const auto& value : vertex) {
-                writeValue(f, value); // Write each vertex component
-            }
-        }
+    // The count is implied by the chunk size, so only the records are written
+    void writeData(byteWriter_t &f) const override {
+        writeArray(f, entry);
     }
 
     std::string to_string() const override {
@@ -838,6 +929,8 @@ struct mefMeshMVtx_t : public mefMeshResource {
 
 
 struct mefMeshRD3D_t : public mefMeshResource {
+    static constexpr MeshResourceType kind = MeshResourceType::RD3D;
+
     uint32_t flag;
     uint32_t num_faces;
     uint32_t num_meshes;
@@ -850,8 +943,10 @@ struct mefMeshRD3D_t : public mefMeshResource {
     uint32_t num_lightmaps;
     uint32_t reserved_type3[6];
     std::vector<uint32_t> reserved_extra;
+    uint32_t size; // Payload size the record was read with; selects the optional fields
 
     mefMeshRD3D_t() {
+        size = 16;
         flag = 0;
         num_faces = 0;
         num_meshes = 0;
@@ -866,11 +961,12 @@ struct mefMeshRD3D_t : public mefMeshResource {
     }
 
     // Override readData method to match mefMeshResource signature
-    void readData(std::ifstream &f, uint32_t size, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t size, int model_type = 0) override {
         if (size < 16) {
             std::cerr << "Error: Specified size " << size << " is smaller than the base structure size (16 bytes)." << std::endl;
             return;
         }
+        this->size = size;
 
         readValue(f, flag);
         readValue(f, num_faces);
@@ -899,35 +995,37 @@ struct mefMeshRD3D_t : public mefMeshResource {
             for (auto &val : reserved_extra) {
                 readValue(f, val);
             }
-            std::cout << "Warning: Unknown size " << size << ". Extra reserved data captured." << std::endl;
+            LOG_WARN(logCategory_t::Mesh, "Unknown size " << size << ". Extra reserved data captured.");
         }
     }
 
     // Override writeData method to match mefMeshResource signature
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         writeValue(f, flag);
         writeValue(f, num_faces);
         writeValue(f, num_meshes);
         writeValue(f, num_vertices);
 
-        // Write reserved fields based on size
-        for (const auto &val : reserved_type0) {
-            writeValue(f, val);
-        }
-
-        writeValue(f, verts_0);
-        writeValue(f, verts_1);
-        for (const auto &val : reserved_type1) {
-            writeValue(f, val);
-        }
-
-        writeValue(f, num_lightmaps);
-        for (const auto &val : reserved_type3) {
-            writeValue(f, val);
-        }
-
-        for (const auto &val : reserved_extra) {
-            writeValue(f, val);
+        // Write the same optional fields readData picked for this size
+        if (size == 36) {
+            for (const auto &val : reserved_type0) {
+                writeValue(f, val);
+            }
+        } else if (size == 40) {
+            writeValue(f, verts_0);
+            writeValue(f, verts_1);
+            for (const auto &val : reserved_type1) {
+                writeValue(f, val);
+            }
+        } else if (size == 44) {
+            writeValue(f, num_lightmaps);
+            for (const auto &val : reserved_type3) {
+                writeValue(f, val);
+            }
+        } else {
+            for (const auto &val : reserved_extra) {
+                writeValue(f, val);
+            }
         }
     }
 
@@ -969,6 +1067,8 @@ struct mefMeshRD3D_t : public mefMeshResource {
 };
 
 struct mefMeshGlow_t : public mefMeshResource {
+    static constexpr MeshResourceType kind = MeshResourceType::GLOW;
+
     float unk93[7];
     uint32_t unk94;
 
@@ -984,7 +1084,7 @@ struct mefMeshGlow_t : public mefMeshResource {
     }
 
     // Override readData method to match mefMeshResource signature
-    void readData(std::ifstream &f, uint32_t size, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t size, int model_type = 0) override {
         readValue(f, unk93[0]);
         readValue(f, unk93[1]);
         readValue(f, unk93[2]);
@@ -996,7 +1096,7 @@ struct mefMeshGlow_t : public mefMeshResource {
     }
 
     // Override writeData method to match mefMeshResource signature
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         writeValue(f, unk93[0]);
         writeValue(f, unk93[1]);
         writeValue(f, unk93[2]);
@@ -1060,8 +1160,8 @@ struct mefMeshRendEntry_t {
     }
 
     // Method to read data
-    void read(std::ifstream &f, uint32_t size) {
-        std::cout << "[mefMeshRendEntry_t::read] Starting to read entry with size " << size << " bytes." << std::endl;
+    void read(byteStream_t &f, uint32_t size) {
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Starting to read entry with size " << size << " bytes.");
 
         // Read the common fields
         readValue(f, opacity);
@@ -1080,17 +1180,17 @@ struct mefMeshRendEntry_t {
         // Determine the appropriate fields to read based on the structure size
         if (size == 28) {
             readValue(f, lightmap_index);
-            std::cout << "[mefMeshRendEntry_t::read] Read lightmap_index: " << lightmap_index << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read lightmap_index: " << lightmap_index);
         }
         else if (size == 32) {
             readValue(f, texture_bump_index);
             readValue(f, texture_reflection_index);
             readValue(f, texture_reflection_detail);
             readValue(f, texture_bump_detail);
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_bump_index: " << texture_bump_index << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_reflection_index: " << texture_reflection_index << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_reflection_detail: " << static_cast<int>(texture_reflection_detail) << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_bump_detail: " << static_cast<int>(texture_bump_detail) << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_bump_index: " << texture_bump_index);
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_reflection_index: " << texture_reflection_index);
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_reflection_detail: " << static_cast<int>(texture_reflection_detail));
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_bump_detail: " << static_cast<int>(texture_bump_detail));
         }
         else if (size > 32) {
             // Read additional fields when size > 32
@@ -1099,53 +1199,53 @@ struct mefMeshRendEntry_t {
             readValue(f, texture_reflection_detail);
             readValue(f, texture_bump_detail);
 
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_bump_index: " << texture_bump_index << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_reflection_index: " << texture_reflection_index << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_reflection_detail: " << static_cast<int>(texture_reflection_detail) << std::endl;
-            std::cout << "[mefMeshRendEntry_t::read] Read texture_bump_detail: " << static_cast<int>(texture_bump_detail) << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_bump_index: " << texture_bump_index);
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_reflection_index: " << texture_reflection_index);
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_reflection_detail: " << static_cast<int>(texture_reflection_detail));
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read texture_bump_detail: " << static_cast<int>(texture_bump_detail));
 
             // Calculate remaining bytes for reserved extra data
             uint32_t extra_size = size - 32;
             uint32_t num_extra = extra_size / 4;
             if (extra_size % 4 != 0) {
-                std::cerr << "[mefMeshRendEntry_t::read] Warning: Extra data size (" << extra_size << " bytes) is not a multiple of 4 bytes." << std::endl;
+                LOG_WARN(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Extra data size (" << extra_size << " bytes) is not a multiple of 4 bytes.");
             }
 
             reserved_extra.resize(num_extra);
             for (auto &extra : reserved_extra) {
                 readValue(f, extra);
-                std::cout << "[mefMeshRendEntry_t::read] Read reserved_extra: " << extra << std::endl;
+                LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read reserved_extra: " << extra);
             }
-            std::cout << "[mefMeshRendEntry_t::read] Warning: Unknown size " << size << " bytes. Extra reserved data captured." << std::endl;
+            LOG_WARN(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Unknown size " << size << " bytes. Extra reserved data captured.");
         }
         else if (size > 28) {
             // Handle sizes between 28 and 32 (if any)
             readValue(f, lightmap_index);
-            std::cout << "[mefMeshRendEntry_t::read] Read lightmap_index: " << lightmap_index << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read lightmap_index: " << lightmap_index);
 
             uint32_t extra_size = size - 28;
             uint32_t num_extra = extra_size / 4;
             if (extra_size % 4 != 0) {
-                std::cerr << "[mefMeshRendEntry_t::read] Warning: Extra data size (" << extra_size << " bytes) is not a multiple of 4 bytes." << std::endl;
+                LOG_WARN(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Extra data size (" << extra_size << " bytes) is not a multiple of 4 bytes.");
             }
 
             reserved_extra.resize(num_extra);
             for (auto &extra : reserved_extra) {
                 readValue(f, extra);
-                std::cout << "[mefMeshRendEntry_t::read] Read reserved_extra: " << extra << std::endl;
+                LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Read reserved_extra: " << extra);
             }
-            std::cout << "[mefMeshRendEntry_t::read] Warning: Unknown size " << size << " bytes. Extra reserved data captured." << std::endl;
+            LOG_WARN(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Unknown size " << size << " bytes. Extra reserved data captured.");
         }
         else {
             std::cerr << "[mefMeshRendEntry_t::read] Error: Specified size " << size << " bytes is too small or unknown." << std::endl;
         }
 
         // Debug output for the read entry
-        std::cout << "[mefMeshRendEntry_t::read] Finished reading entry:\n" << to_string() << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRendEntry_t::read] Finished reading entry:\n" << to_string());
     }
 
     // Method to write data
-    void write(std::ofstream &f, uint32_t size) const {
+    void write(byteWriter_t &f, uint32_t size) const {
         writeValue(f, opacity);
         writeValue(f, material_shininess);
         writeValue(f, diffuse_color);
@@ -1207,25 +1307,25 @@ struct mefMeshRendEntry_t {
 };
 
 struct mefMeshRend_t : public mefMeshResource {
-    std::vector<mefMeshRendEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::REND;
 
-    mefMeshRend_t() = default;
+    std::pmr::vector<mefMeshRendEntry_t> entry;
+    uint32_t stride; // Record size, 28 for model_type 3 and 32 otherwise
+
+    explicit mefMeshRend_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr), stride(32) {}
 
     // Override the readData method
-    void readData(std::ifstream &f, uint32_t data_size, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t data_size, int model_type = 0) override {
         entry.clear();
 
         // Determine stride based on model_type
-        uint32_t stride = 32; // Default stride
-        if (model_type == 3) {
-            stride = 28;
-        }
+        stride = (model_type == 3) ? 28 : 32;
 
         // Debug information
-        std::cout << "[mefMeshRend_t::readData] Starting to read Rend data." << std::endl;
-        std::cout << "data_size: " << data_size << " bytes" << std::endl;
-        std::cout << "model_type: " << model_type << std::endl;
-        std::cout << "stride: " << stride << " bytes" << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::readData] Starting to read Rend data.");
+        LOG_DEBUG(logCategory_t::Mesh, "data_size: " << data_size << " bytes");
+        LOG_DEBUG(logCategory_t::Mesh, "model_type: " << model_type);
+        LOG_DEBUG(logCategory_t::Mesh, "stride: " << stride << " bytes");
 
         // Check if data_size is sufficient
         if (data_size < stride) {
@@ -1237,40 +1337,38 @@ struct mefMeshRend_t : public mefMeshResource {
         uint32_t count = data_size / stride;
         uint32_t remaining_bytes = data_size % stride;
 
-        std::cout << "count: " << count << std::endl;
-        std::cout << "remaining_bytes: " << remaining_bytes << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "count: " << count);
+        LOG_DEBUG(logCategory_t::Mesh, "remaining_bytes: " << remaining_bytes);
 
         if (remaining_bytes != 0) {
-            std::cerr << "[mefMeshRend_t::readData] Warning: Data size (" << data_size << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+            LOG_WARN(logCategory_t::Mesh, "[mefMeshRend_t::readData] Data size (" << data_size << " bytes) is not a multiple of stride (" << stride << " bytes).");
         }
 
         if (count == 0) {
-            std::cerr << "[mefMeshRend_t::readData] Warning: No entries to read." << std::endl;
+            LOG_WARN(logCategory_t::Mesh, "[mefMeshRend_t::readData] No entries to read.");
             return;
         }
 
-        std::cout << "[mefMeshRend_t::readData] Reading " << count << " Rend entries with stride " << stride << " bytes." << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::readData] Reading " << count << " Rend entries with stride " << stride << " bytes.");
 
         // Resize the entry vector and read each entry
         entry.resize(count);
         for (uint32_t i = 0; i < count; ++i) {
-            std::cout << "[mefMeshRend_t::readData] Reading Rend Entry " << i << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::readData] Reading Rend Entry " << i);
             entry[i].read(f, stride);
         }
 
-        std::cout << "[mefMeshRend_t::readData] Successfully read Rend entries." << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::readData] Successfully read Rend entries.");
     }
 
     // Override the writeData method
-    void writeData(std::ofstream &f) const override {
-        // Assuming a fixed stride of 32 for writing
-        uint32_t stride = 32;
-        std::cout << "[mefMeshRend_t::writeData] Writing Rend entries with stride " << stride << " bytes." << std::endl;
+    void writeData(byteWriter_t &f) const override {
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::writeData] Writing Rend entries with stride " << stride << " bytes.");
         for (size_t i = 0; i < entry.size(); ++i) {
-            std::cout << "[mefMeshRend_t::writeData] Writing Rend Entry " << i << std::endl;
-            entry[i].write(f, stride); // Use fixed stride
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::writeData] Writing Rend Entry " << i);
+            entry[i].write(f, stride);
         }
-        std::cout << "[mefMeshRend_t::writeData] Finished writing Rend entries." << std::endl;
+        LOG_DEBUG(logCategory_t::Mesh, "[mefMeshRend_t::writeData] Finished writing Rend entries.");
     }
 
     std::string to_string() const override {
@@ -1283,30 +1381,21 @@ struct mefMeshRend_t : public mefMeshResource {
 };
 
 struct mefMeshEdge_t : public mefMeshResource {
-    std::vector<std::array<uint32_t, 2>> entry; // Using array for fixed size faces
+    static constexpr MeshResourceType kind = MeshResourceType::EDGE;
 
-    mefMeshEdge_t() {
-        entry.clear();
-    }
+    std::pmr::vector<std::array<uint32_t, 2>> entry; // Using array for fixed size faces
+
+    explicit mefMeshEdge_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Corrected readData function to match the base class
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
-        entry.clear();
-        if (count > 0) {
-            entry.resize(count); // Resize to count
-            for (size_t i = 0; i < count; ++i) {
-                readValue(f, entry[i][0]); // Read first index
-                readValue(f, entry[i][1]); // Read second index
-            }
-        }
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
+        static_assert(sizeof(entry[0]) == 8, "EDGE record is two uint32_t indices");
+        readArray(f, entry, count);
     }
 
     // Corrected writeData function to match the base class
-    void writeData(std::ofstream &f) const override {
-        for (const auto& face : entry) {
-            writeValue(f, face[0]); // Write first index
-            writeValue(f, face[1]); // Write second index
-        }
+    void writeData(byteWriter_t &f) const override {
+        writeArray(f, entry);
     }
 
     std::string to_string() const override {
@@ -1319,34 +1408,21 @@ struct mefMeshEdge_t : public mefMeshResource {
 };
 
 struct mefMeshLtMp_t : public mefMeshResource {
-    std::vector<std::array<uint16_t, 4>> entry; // Using array for fixed size faces
+    static constexpr MeshResourceType kind = MeshResourceType::LTMP;
 
-    mefMeshLtMp_t() {
-        entry.clear();
-    }
+    std::pmr::vector<std::array<uint16_t, 4>> entry; // Using array for fixed size faces
+
+    explicit mefMeshLtMp_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Corrected readData function to match the base class
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
-        entry.clear();
-        if (count > 0) {
-            entry.resize(count); // Resize to count
-            for (size_t i = 0; i < count; ++i) {
-                readValue(f, entry[i][0]); // Read first index
-                readValue(f, entry[i][1]); // Read second index
-                readValue(f, entry[i][2]); // Read third index
-                readValue(f, entry[i][3]); // Read fourth index
-            }
-        }
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
+        static_assert(sizeof(entry[0]) == 8, "LTMP record is four uint16_t values");
+        readArray(f, entry, count);
     }
 
     // Corrected writeData function to match the base class
-    void writeData(std::ofstream &f) const override {
-        for (const auto& item : entry) {
-            writeValue(f, item[0]); // Write first index
-            writeValue(f, item[1]); // Write second index
-            writeValue(f, item[2]); // Write third index
-            writeValue(f, item[3]); // Write fourth index
-        }
+    void writeData(byteWriter_t &f) const override {
+        writeArray(f, entry);
     }
 
     std::string to_string() const override {
@@ -1373,7 +1449,7 @@ struct mefMeshVrtxEntry_t {
           normal{0.0f, 0.0f, 0.0f}, weight(0.0f),
           texcoord1{0.0f, 0.0f}, vertex_index(0), bone_index(0) {}
 
-    void readData(std::ifstream &f, int model_type) {
+    void readData(byteStream_t &f, int model_type) {
         readValue(f, position[0]);
         readValue(f, position[1]);
         readValue(f, position[2]);
@@ -1399,8 +1475,50 @@ struct mefMeshVrtxEntry_t {
         }
     }
 
+    // Size in bytes of one on-disk vertex for the given model_type
+    template <int ModelType>
+    static constexpr size_t stride() {
+        return 12 + (ModelType < 3 ? 12 : 0) + 8 + (ModelType > 1 ? 8 : 0) + (ModelType == 1 ? 8 : 0);
+    }
+
+    // Branch-free decode of one vertex; the layout is fixed at compile time
+    template <int ModelType>
+    void decode(const uint8_t* src) {
+        std::memcpy(position.data(), src, 12); src += 12;
+        if (ModelType < 3) {
+            std::memcpy(normal.data(), src, 12); src += 12;
+        }
+        std::memcpy(texcoord0.data(), src, 8); src += 8;
+        if (ModelType > 1) {
+            std::memcpy(texcoord1.data(), src, 8); src += 8;
+        }
+        if (ModelType == 1) {
+            std::memcpy(&weight, src, 4);
+            std::memcpy(&vertex_index, src + 4, 2);
+            std::memcpy(&bone_index, src + 6, 2);
+        }
+    }
+
+    // Inverse of decode
+    template <int ModelType>
+    void encode(uint8_t* dst) const {
+        std::memcpy(dst, position.data(), 12); dst += 12;
+        if (ModelType < 3) {
+            std::memcpy(dst, normal.data(), 12); dst += 12;
+        }
+        std::memcpy(dst, texcoord0.data(), 8); dst += 8;
+        if (ModelType > 1) {
+            std::memcpy(dst, texcoord1.data(), 8); dst += 8;
+        }
+        if (ModelType == 1) {
+            std::memcpy(dst, &weight, 4);
+            std::memcpy(dst + 4, &vertex_index, 2);
+            std::memcpy(dst + 6, &bone_index, 2);
+        }
+    }
+
     // Write method now renamed to writeData
-    void writeData(std::ofstream &f, int model_type) const {
+    void writeData(byteWriter_t &f, int model_type) const {
         // Write position
         for (const auto& coord : position) {
             writeValue(f, coord);
@@ -1447,26 +1565,61 @@ struct mefMeshVrtxEntry_t {
 };
 
 struct mefMeshVrtx_t : public mefMeshResource {
-    std::vector<mefMeshVrtxEntry_t> entry; // Vector to hold vertex entries
+    static constexpr MeshResourceType kind = MeshResourceType::VRTX;
 
-    mefMeshVrtx_t() {}
+    std::pmr::vector<mefMeshVrtxEntry_t> entry; // Vector to hold vertex entries
+    int model_type; // Vertex layout the entries were read with, from the MESH header
+
+    explicit mefMeshVrtx_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr), model_type(0) {}
 
     // Updated to readData
-    void readData(std::ifstream &f, uint32_t count, int model_type) override {
+    void readData(byteStream_t &f, uint32_t count, int model_type) override {
+        this->model_type = model_type;
         entry.clear(); // Clear any existing entries
+        entry.resize(count);
+        if (count == 0) {
+            return;
+        }
 
-        if (count > 0) {
-            entry.resize(count); // Reserve space for entries
-            for (size_t i = 0; i < count; ++i) {
-                entry[i].readData(f, model_type); // Read each vertex entry
-            }
+        // Pick the decoder once per chunk instead of per field
+        switch (model_type) {
+            case 1:  decodeAll<1>(f); break;
+            case 2:  decodeAll<2>(f); break;
+            default: if (model_type >= 3) { decodeAll<3>(f); } else { decodeAll<0>(f); } break;
         }
     }
 
-    // Updated to writeData
-    void writeData(std::ofstream &f) const override {
-        for (const auto& entry_instance : entry) {
-            entry_instance.writeData(f, entry_instance.bone_index); // Use model_type for writing
+private:
+    // Decodes the whole VRTX payload straight from the stream buffer
+    template <int ModelType>
+    void decodeAll(byteStream_t &f) {
+        const size_t stride = mefMeshVrtxEntry_t::stride<ModelType>();
+        const size_t available = std::min(entry.size(), f.remaining() / stride);
+        const uint8_t* src = f.ptr();
+        mefMeshVrtxEntry_t* dst = entry.data();
+        for (size_t i = 0; i < available; ++i, src += stride) {
+            dst[i].decode<ModelType>(src);
+        }
+        f.skip(entry.size() * stride); // Flags the stream if the payload was truncated
+    }
+
+    // Encodes every vertex straight into the output buffer
+    template <int ModelType>
+    void encodeAll(byteWriter_t &f) const {
+        const size_t stride = mefMeshVrtxEntry_t::stride<ModelType>();
+        uint8_t* dst = f.append(entry.size() * stride);
+        for (size_t i = 0; i < entry.size(); ++i, dst += stride) {
+            entry[i].encode<ModelType>(dst);
+        }
+    }
+
+public:
+
+    void writeData(byteWriter_t &f) const override {
+        switch (model_type) {
+            case 1:  encodeAll<1>(f); break;
+            case 2:  encodeAll<2>(f); break;
+            default: if (model_type >= 3) { encodeAll<3>(f); } else { encodeAll<0>(f); } break;
         }
     }
 
@@ -1501,7 +1654,7 @@ struct mefMeshCSphEntry_t {
     }
 
     // Updated to match the new virtual method signature
-    void readData(std::ifstream &f) {
+    void readData(byteStream_t &f) {
         readValue(f, position[0]); // Read x
         readValue(f, position[1]); // Read y
         readValue(f, position[2]); // Read z
@@ -1513,7 +1666,7 @@ struct mefMeshCSphEntry_t {
     }
 
     // Updated to match the new virtual method signature
-    void writeData(std::ofstream &f) const {
+    void writeData(byteWriter_t &f) const {
         writeValue(f, position[0]); // Write x
         writeValue(f, position[1]); // Write y
         writeValue(f, position[2]); // Write z
@@ -1540,10 +1693,14 @@ struct mefMeshCSphEntry_t {
 };
 
 struct mefMeshCSph_t : public mefMeshResource {
-    std::vector<mefMeshCSphEntry_t> entry; // Vector to hold multiple entries
+    static constexpr MeshResourceType kind = MeshResourceType::CSPH;
+
+    std::pmr::vector<mefMeshCSphEntry_t> entry; // Vector to hold multiple entries
+
+    explicit mefMeshCSph_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Updated to match the new virtual method signature
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear(); // Clear existing entries
         if (count > 0) {
             for (uint32_t i = 0; i < count; ++i) {
@@ -1555,7 +1712,7 @@ struct mefMeshCSph_t : public mefMeshResource {
     }
 
     // Updated to match the new virtual method signature
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &sph_entry : entry) {
             sph_entry.writeData(f); // Use writeData method
         }
@@ -1589,7 +1746,7 @@ struct mefMeshCVtxEntry_t {
     }
 
     // Updated readData function
-    void readData(std::ifstream &f) {
+    void readData(byteStream_t &f) {
         readValue(f, position[0]); // Read x
         readValue(f, position[1]); // Read y
         readValue(f, position[2]); // Read z
@@ -1598,7 +1755,7 @@ struct mefMeshCVtxEntry_t {
     }
 
     // Updated writeData function
-    void writeData(std::ofstream &f) const {
+    void writeData(byteWriter_t &f) const {
         writeValue(f, position[0]); // Write x
         writeValue(f, position[1]); // Write y
         writeValue(f, position[2]); // Write z
@@ -1620,24 +1777,21 @@ struct mefMeshCVtxEntry_t {
 
 // Struct for vertex list
 struct mefMeshCVtx_t : public mefMeshResource {
-    std::vector<mefMeshCVtxEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::CVTX;
+
+    std::pmr::vector<mefMeshCVtxEntry_t> entry;
+
+    explicit mefMeshCVtx_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Updated readData function
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
-        entry.clear();
-        if (count > 0) {
-            entry.resize(count);
-            for (size_t i = 0; i < count; ++i) {
-                entry[i].readData(f); // Call the new readData method
-            }
-        }
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
+        static_assert(sizeof(mefMeshCVtxEntry_t) == 20, "CVTX record is position, bone_index, unk78");
+        readArray(f, entry, count);
     }
 
     // Updated writeData function
-    void writeData(std::ofstream &f) const override {
-        for (const auto &vtx_entry : entry) {
-            vtx_entry.writeData(f); // Call the new writeData method
-        }
+    void writeData(byteWriter_t &f) const override {
+        writeArray(f, entry);
     }
 
     std::string to_string() const override {
@@ -1665,14 +1819,14 @@ struct mefMeshSVtxEntry_t {
     }
 
     // Updated readData function
-    void readData(std::ifstream &f) {
+    void readData(byteStream_t &f) {
         readValue(f, position[0]); // Read x
         readValue(f, position[1]); // Read y
         readValue(f, position[2]); // Read z
     }
 
     // Updated writeData function
-    void writeData(std::ofstream &f) const {
+    void writeData(byteWriter_t &f) const {
         writeValue(f, position[0]); // Write x
         writeValue(f, position[1]); // Write y
         writeValue(f, position[2]); // Write z
@@ -1690,10 +1844,14 @@ struct mefMeshSVtxEntry_t {
 
 // Struct for vertex list
 struct mefMeshSVtx_t : public mefMeshResource {
-    std::vector<mefMeshSVtxEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::SVTX;
+
+    std::pmr::vector<mefMeshSVtxEntry_t> entry;
+
+    explicit mefMeshSVtx_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Updated readData function
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count);
@@ -1704,7 +1862,7 @@ struct mefMeshSVtx_t : public mefMeshResource {
     }
 
     // Updated writeData function
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &vtx_entry : entry) {
             vtx_entry.writeData(f); // Call the new writeData method
         }
@@ -1741,7 +1899,7 @@ struct mefMeshCFceEntry_t {
         unk81 = 0;
     }
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, face[0]);          // Read vertex index 0
         readValue(f, face[1]);          // Read vertex index 1
         readValue(f, face[2]);          // Read vertex index 2
@@ -1750,7 +1908,7 @@ struct mefMeshCFceEntry_t {
         readValue(f, unk81);            // Read unk81
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, face[0]);         // Write vertex index 0
         writeValue(f, face[1]);         // Write vertex index 1
         writeValue(f, face[2]);         // Write vertex index 2
@@ -1774,10 +1932,14 @@ struct mefMeshCFceEntry_t {
 
 // Struct for face list
 struct mefMeshCFce_t : public mefMeshResource {
-    std::vector<mefMeshCFceEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::CFCE;
+
+    std::pmr::vector<mefMeshCFceEntry_t> entry;
+
+    explicit mefMeshCFce_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Overridden readData function
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count);
@@ -1788,7 +1950,7 @@ struct mefMeshCFce_t : public mefMeshResource {
     }
 
     // Overridden writeData function
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &fce_entry : entry) {
             fce_entry.write(f);
         }
@@ -1824,7 +1986,7 @@ struct mefMeshSFceEntry_t {
         unk91[2] = 0;
     }
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, face[0]);          // Read vertex index 0
         readValue(f, face[1]);          // Read vertex index 1
         readValue(f, face[2]);          // Read vertex index 2
@@ -1834,7 +1996,7 @@ struct mefMeshSFceEntry_t {
         readValue(f, unk91[2]);          // Read vertex index 2
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, face[0]);         // Write vertex index 0
         writeValue(f, face[1]);         // Write vertex index 1
         writeValue(f, face[2]);         // Write vertex index 2
@@ -1859,10 +2021,14 @@ struct mefMeshSFceEntry_t {
 };
 
 struct mefMeshSFce_t : public mefMeshResource {
-    std::vector<mefMeshSFceEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::SFAC;
+
+    std::pmr::vector<mefMeshSFceEntry_t> entry;
+
+    explicit mefMeshSFce_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Overridden readData function
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count);
@@ -1873,7 +2039,7 @@ struct mefMeshSFce_t : public mefMeshResource {
     }
 
     // Overridden writeData function
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &fce_entry : entry) {
             fce_entry.write(f);
         }
@@ -1905,7 +2071,7 @@ struct mefMeshCMshEntry_t {
         std::fill(std::begin(reserved), std::end(reserved), 0);
     }
 
-    void readData(std::ifstream &f) {
+    void readData(byteStream_t &f) {
         readValue(f, num_faces);
         readValue(f, num_vertices);
         readValue(f, num_materials);
@@ -1915,7 +2081,7 @@ struct mefMeshCMshEntry_t {
         }
     }
 
-    void writeData(std::ofstream &f) const {
+    void writeData(byteWriter_t &f) const {
         writeValue(f, num_faces);
         writeValue(f, num_vertices);
         writeValue(f, num_materials);
@@ -1938,9 +2104,13 @@ struct mefMeshCMshEntry_t {
 };
 
 struct mefMeshCMsh_t : public mefMeshResource {
-    std::vector<mefMeshCMshEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::CMSH;
 
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    std::pmr::vector<mefMeshCMshEntry_t> entry;
+
+    explicit mefMeshCMsh_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
+
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count); // Resize the vector to hold the number of entries
@@ -1950,7 +2120,7 @@ struct mefMeshCMsh_t : public mefMeshResource {
         }
     }
 
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &msh_entry : entry) {
             msh_entry.writeData(f); // Call writeData for each entry
         }
@@ -1979,7 +2149,7 @@ struct mefMeshCMatEntry_t {
 
     mefMeshCMatEntry_t() : unk48(0), unk49(0), unk50(0), unk51(0), unk52(0) {}
 
-    void read(std::ifstream &f) {
+    void read(byteStream_t &f) {
         readValue(f, unk48);
         readValue(f, unk49);
         readValue(f, unk50);
@@ -1987,7 +2157,7 @@ struct mefMeshCMatEntry_t {
         readValue(f, unk52);
     }
 
-    void write(std::ofstream &f) const {
+    void write(byteWriter_t &f) const {
         writeValue(f, unk48);
         writeValue(f, unk49);
         writeValue(f, unk50);
@@ -2007,9 +2177,13 @@ struct mefMeshCMatEntry_t {
 };
 
 struct mefMeshCMat_t : public mefMeshResource {
-    std::vector<mefMeshCMatEntry_t> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::CMAT;
+
+    std::pmr::vector<mefMeshCMatEntry_t> entry;
+
+    explicit mefMeshCMat_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count); // Resize to count
@@ -2019,7 +2193,7 @@ struct mefMeshCMat_t : public mefMeshResource {
         }
     }
 
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto &mat_entry : entry) {
             mat_entry.write(f); // Write each material entry
         }
@@ -2051,7 +2225,7 @@ struct mefMeshMrphEntry_t {
     }
 
     // Updated to readData
-    void readData(std::ifstream &f) {
+    void readData(byteStream_t &f) {
         readValue(f, index);  // Read index
         readValue(f, delta[0]); // Read delta[0]
         readValue(f, delta[1]); // Read delta[1]
@@ -2059,7 +2233,7 @@ struct mefMeshMrphEntry_t {
     }
 
     // Updated to writeData
-    void writeData(std::ofstream &f) const {
+    void writeData(byteWriter_t &f) const {
         writeValue(f, index);  // Write index
         for (float value : delta) {
             writeValue(f, value); // Write each delta value
@@ -2074,39 +2248,36 @@ struct mefMeshMrphEntry_t {
     }
 };
 struct mefMeshMrph_t : public mefMeshResource {
-    std::vector<std::vector<mefMeshMrphEntry_t>> entry;
+    static constexpr MeshResourceType kind = MeshResourceType::MRPH;
 
-    mefMeshMrph_t() : entry(16) {}  // Initialize entry with 16 vectors
+    std::pmr::vector<std::pmr::vector<mefMeshMrphEntry_t>> entry;
+
+    explicit mefMeshMrph_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(16, mr) {}
 
     // Updated to readData
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         std::vector<uint32_t> counts(16); // Array to hold counts
 
         for (size_t i = 0; i < counts.size(); ++i) {
             readValue(f, counts[i]); // Read counts
         }
 
+        static_assert(sizeof(mefMeshMrphEntry_t) == 16, "MRPH record is index plus delta");
         entry.resize(counts.size());
         for (size_t i = 0; i < counts.size(); ++i) {
-            if (counts[i] > 0) {
-                entry[i].resize(counts[i]); // Resize entry for current count
-                for (uint32_t j = 0; j < counts[i]; ++j) {
-                    mefMeshMrphEntry_t mrph_entry;
-                    mrph_entry.readData(f); // Updated to readData
-                    entry[i][j] = mrph_entry; // Store the entry
-                }
-            }
+            readArray(f, entry[i], counts[i]); // Each morph target is one contiguous run
         }
     }
 
     // Updated to writeData
-    void writeData(std::ofstream &f) const override {
-        for (const auto& count : entry) {
-            uint32_t count_size = static_cast<uint32_t>(count.size());
-            writeValue(f, count_size); // Write the count of entries
-            for (const auto& entry_item : count) {
-                entry_item.writeData(f); // Updated to writeData
-            }
+    // All 16 counts come first, then the morph targets, as readData expects
+    void writeData(byteWriter_t &f) const override {
+        for (size_t i = 0; i < 16; ++i) {
+            uint32_t count_size = i < entry.size() ? static_cast<uint32_t>(entry[i].size()) : 0;
+            writeValue(f, count_size);
+        }
+        for (const auto& target : entry) {
+            writeArray(f, target);
         }
     }
 
@@ -2125,14 +2296,14 @@ struct mefMeshMrph_t : public mefMeshResource {
 
 
 struct mefMeshSmes_t : public mefMeshResource { // shadow mesh?
-    std::vector<std::array<uint32_t, 2>> entry; // Using array for fixed size faces
+    static constexpr MeshResourceType kind = MeshResourceType::SMES;
 
-    mefMeshSmes_t() {
-        entry.clear();
-    }
+    std::pmr::vector<std::array<uint32_t, 2>> entry; // Using array for fixed size faces
+
+    explicit mefMeshSmes_t(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : entry(mr) {}
 
     // Corrected readData function to match the base class
-    void readData(std::ifstream &f, uint32_t count = 0, int model_type = 0) override {
+    void readData(byteStream_t &f, uint32_t count = 0, int model_type = 0) override {
         entry.clear();
         if (count > 0) {
             entry.resize(count); // Resize to count
@@ -2144,7 +2315,7 @@ struct mefMeshSmes_t : public mefMeshResource { // shadow mesh?
     }
 
     // Corrected writeData function to match the base class
-    void writeData(std::ofstream &f) const override {
+    void writeData(byteWriter_t &f) const override {
         for (const auto& item : entry) {
             writeValue(f, item[0]); // Write first index
             writeValue(f, item[1]); // Write second index
@@ -2161,236 +2332,81 @@ struct mefMeshSmes_t : public mefMeshResource { // shadow mesh?
 };
 
 
+// Deletes a chunk resource; arena-backed resources only run their destructor,
+// the memory itself is released with the arena
+struct mefResourceDeleter {
+    bool owned = true;
+    void operator()(mefMeshResource* res) const {
+        if (owned) {
+            delete res;
+        } else {
+            res->~mefMeshResource();
+        }
+    }
+};
+
+typedef std::unique_ptr<mefMeshResource, mefResourceDeleter> mefResourcePtr;
+
+// Constructs T in arena (or on the heap when arena is null). Resources with entry
+// arrays take the arena as well so their vectors allocate from it.
+template <typename T, typename... Args>
+mefResourcePtr makeResource(std::pmr::memory_resource* arena, Args&&... args) {
+    if (arena == nullptr) {
+        return mefResourcePtr(new T(std::forward<Args>(args)...), mefResourceDeleter{true});
+    }
+    void* mem = arena->allocate(sizeof(T), alignof(T));
+    T* res;
+    if constexpr (sizeof...(Args) == 0 && std::is_constructible<T, std::pmr::memory_resource*>::value) {
+        res = new (mem) T(arena);
+    } else {
+        res = new (mem) T(std::forward<Args>(args)...);
+    }
+    return mefResourcePtr(res, mefResourceDeleter{false});
+}
+
 struct mefMeshChunk_t {
     uint32_t type;
     uint32_t data;
     uint32_t flag;
     uint32_t size;
-    mefMeshResource* res;  // Pointer to base class for different resource types
-    std::string type_debug;
+    mefResourcePtr res;  // Owned resource, concrete type selected by 'type'
+    std::vector<uint8_t> tail; // Payload bytes the resource did not consume (all of them for unknown types)
 
     // Constructor
     mefMeshChunk_t()
-        : type(0), data(0), flag(0), size(0), res(nullptr), type_debug("") {}
+        : type(0), data(0), flag(0), size(0) {}
 
-    // Destructor
-    ~mefMeshChunk_t() {
-        if (res) {
-            delete res;
-            res = nullptr;
-        }
-    }
+    // Chunks own their geometry; they are moved, never deep-copied
+    mefMeshChunk_t(const mefMeshChunk_t&) = delete;
+    mefMeshChunk_t& operator=(const mefMeshChunk_t&) = delete;
+    mefMeshChunk_t(mefMeshChunk_t&&) = default;
+    mefMeshChunk_t& operator=(mefMeshChunk_t&&) = default;
 
     // Template method to create a resource and read its data
     template <typename T>
-    mefMeshResource* createResource(std::ifstream &f, uint32_t count = 0, int model_type = 0) {
-        T* resource = new T();
+    mefResourcePtr createResource(std::pmr::memory_resource* arena, byteStream_t &f, uint32_t count = 0, int model_type = 0) {
+        mefResourcePtr resource = makeResource<T>(arena);
         resource->readData(f, count, model_type); // Corrected to call readData
         return resource;
     }
 
-    // Template method to clone a resource
-    template <typename T>
-    mefMeshResource* cloneResource(const mefMeshResource* other_res) {
-        const T* derived_res = dynamic_cast<const T*>(other_res);
-        return derived_res ? new T(*derived_res) : nullptr;
-    }
-
-    // Copy Constructor
-    mefMeshChunk_t(const mefMeshChunk_t& other)
-        : type(other.type), data(other.data), flag(other.flag),
-          size(other.size), type_debug(other.type_debug), res(nullptr) { // Initialize res to nullptr
-
-        if (other.res) {
-            // Clone the resource based on the type
-            switch (static_cast<MeshResourceType>(other.type)) {
-                case MeshResourceType::MESH:
-                    res = cloneResource<mefMesh_t>(other.res);
-                    break;
-                case MeshResourceType::ATTA:
-                    res = cloneResource<mefMeshAtta_t>(other.res);
-                    break;
-                case MeshResourceType::MVTX:
-                    res = cloneResource<mefMeshMVtx_t>(other.res);
-                    break;
-                case MeshResourceType::RD3D:
-                    res = cloneResource<mefMeshRD3D_t>(other.res);
-                    break;
-                case MeshResourceType::GLOW:
-                    res = cloneResource<mefMeshGlow_t>(other.res);
-                    break;
-                case MeshResourceType::HIER:
-                    res = cloneResource<mefMeshHier_t>(other.res);
-                    break;
-                case MeshResourceType::BNAM:
-                    res = cloneResource<mefMeshBNam_t>(other.res);
-                    break;
-                case MeshResourceType::FACE:
-                    res = cloneResource<mefMeshFace_t>(other.res);
-                    break;
-                case MeshResourceType::EDGE:
-                    res = cloneResource<mefMeshEdge_t>(other.res);
-                    break;
-                case MeshResourceType::LTMP:
-                    res = cloneResource<mefMeshLtMp_t>(other.res);
-                    break;
-                case MeshResourceType::REND:
-                    res = cloneResource<mefMeshRend_t>(other.res);
-                    break;
-                case MeshResourceType::VRTX:
-                    res = cloneResource<mefMeshVrtx_t>(other.res);
-                    break;
-                case MeshResourceType::CVTX:
-                    res = cloneResource<mefMeshCVtx_t>(other.res);
-                    break;
-                case MeshResourceType::SVTX:
-                    res = cloneResource<mefMeshSVtx_t>(other.res);
-                    break;
-                case MeshResourceType::CFCE:
-                    res = cloneResource<mefMeshCFce_t>(other.res);
-                    break;
-                case MeshResourceType::SFAC:
-                    res = cloneResource<mefMeshSFce_t>(other.res);
-                    break;
-                case MeshResourceType::CMAT:
-                    res = cloneResource<mefMeshCMat_t>(other.res);
-                    break;
-                case MeshResourceType::CSPH:
-                    res = cloneResource<mefMeshCSph_t>(other.res);
-                    break;
-                case MeshResourceType::MRPH:
-                    res = cloneResource<mefMeshMrph_t>(other.res);
-                    break;
-                case MeshResourceType::CMSH:
-                    res = cloneResource<mefMeshCMsh_t>(other.res);
-                    break;
-                case MeshResourceType::SMES:
-                    res = cloneResource<mefMeshSmes_t>(other.res);
-                    break;
-                default:
-                    res = nullptr; // Unknown type
-                    break;
-            }
-        }
-    }
-
-    // Copy Assignment Operator
-    mefMeshChunk_t& operator=(const mefMeshChunk_t& other) {
-        if (this != &other) {
-            // Clean up existing resource
-            if (res) {
-                delete res;
-                res = nullptr; // Set to nullptr after deletion
-            }
-
-            // Copy basic fields
-            type = other.type;
-            data = other.data;
-            flag = other.flag;
-            size = other.size;
-            type_debug = other.type_debug;
-
-            // Clone the resource if it exists
-            if (other.res) {
-                switch (static_cast<MeshResourceType>(other.type)) {
-                    case MeshResourceType::MESH:
-                        res = cloneResource<mefMesh_t>(other.res);
-                        break;
-                    case MeshResourceType::ATTA:
-                        res = cloneResource<mefMeshAtta_t>(other.res);
-                        break;
-                    case MeshResourceType::RD3D:
-                        res = cloneResource<mefMeshRD3D_t>(other.res);
-                        break;
-                    case MeshResourceType::GLOW:
-                        res = cloneResource<mefMeshGlow_t>(other.res);
-                        break;
-                    case MeshResourceType::MVTX:
-                        res = cloneResource<mefMeshMVtx_t>(other.res);
-                        break;
-                    case MeshResourceType::HIER:
-                        res = cloneResource<mefMeshHier_t>(other.res);
-                        break;
-                    case MeshResourceType::BNAM:
-                        res = cloneResource<mefMeshBNam_t>(other.res);
-                        break;
-                    case MeshResourceType::FACE:
-                        res = cloneResource<mefMeshFace_t>(other.res);
-                        break;
-                    case MeshResourceType::EDGE:
-                        res = cloneResource<mefMeshEdge_t>(other.res);
-                        break;
-                    case MeshResourceType::LTMP:
-                        res = cloneResource<mefMeshLtMp_t>(other.res);
-                        break;
-                    case MeshResourceType::REND:
-                        res = cloneResource<mefMeshRend_t>(other.res);
-                        break;
-                    case MeshResourceType::VRTX:
-                        res = cloneResource<mefMeshVrtx_t>(other.res);
-                        break;
-                    case MeshResourceType::CVTX:
-                        res = cloneResource<mefMeshCVtx_t>(other.res);
-                        break;
-                    case MeshResourceType::SVTX:
-                        res = cloneResource<mefMeshSVtx_t>(other.res);
-                        break;
-                    case MeshResourceType::CFCE:
-                        res = cloneResource<mefMeshCFce_t>(other.res);
-                        break;
-                    case MeshResourceType::SFAC:
-                        res = cloneResource<mefMeshSFce_t>(other.res);
-                        break;
-                    case MeshResourceType::CMAT:
-                        res = cloneResource<mefMeshCMat_t>(other.res);
-                        break;
-                    case MeshResourceType::CSPH:
-                        res = cloneResource<mefMeshCSph_t>(other.res);
-                        break;
-                    case MeshResourceType::MRPH:
-                        res = cloneResource<mefMeshMrph_t>(other.res);
-                        break;
-                    case MeshResourceType::CMSH:
-                        res = cloneResource<mefMeshCMsh_t>(other.res);
-                        break;
-                    case MeshResourceType::SMES:
-                        res = cloneResource<mefMeshSmes_t>(other.res);
-                        break;
-                    default:
-                        res = nullptr; // Unknown type, set res to nullptr
-                        break;
-                }
-            } else {
-                res = nullptr; // Ensure res is nullptr if the other resource is nullptr
-            }
-        }
-        return *this;
-    }
-
     // Read method to parse a chunk from the file
-    void read(std::ifstream &f, mefMesh_t &header, mefMeshRD3D_t &render3D, bool verbose = false, bool stopOnNewChunk = false) {
+    // Resources and their entry arrays are carved from arena when one is given
+    void read(byteStream_t &f, mefMesh_t &header, mefMeshRD3D_t &render3D, std::pmr::memory_resource* arena = nullptr, bool verbose = false, bool stopOnNewChunk = false) {
         // Save the position in the file for reference
-        std::streampos pos = f.tellg();
+        size_t pos = f.tellg();
         readValue(f, type);
         readValue(f, data);
         readValue(f, flag);
         readValue(f, size);
 
-        // Construct type_debug string for easier debugging
-        type_debug.clear();
-        for (int i = 0; i < 4; ++i) {
-            type_debug += static_cast<char>((type >> (8 * (3 - i))) & 0xFF);
-        }
-
         if (verbose) {
-            std::cout << "[mefMeshChunk_t::read] Chunk { " << type_debug << " } @ " << pos << std::endl;
+            LOG_DEBUG(logCategory_t::Mesh, "[mefMeshChunk_t::read] Chunk { " << intToFourCC(type, true) << " } @ " << pos);
         }
 
-        // Initialize res to nullptr to avoid any accidental usage before assignment
-        if (res) {
-            delete res;
-            res = nullptr;
-        }
+        // Drop any previous resource before reading the new one
+        res.reset();
+        tail.clear();
 
         // Read the resource based on the type
         if (data > 0) {
@@ -2398,43 +2414,43 @@ struct mefMeshChunk_t {
                 case MeshResourceType::MESH: {
 
                     header.readData(f, data, 0); // Assuming model_type is 0 for RD3D
-                    res = new mefMesh_t(header);
+                    res = makeResource<mefMesh_t>(arena, header);
 
-                    std::cout << "[mefMeshChunk_t::read] " << type_debug << ": Count# \t" << data << "\n" << res->to_string() << "\n----------------------------" << std::endl;
+                    LOG_DEBUG(logCategory_t::Mesh, "[mefMeshChunk_t::read] " << intToFourCC(type, true) << ": Count# \t" << data << "\n" << res->to_string() << "\n----------------------------");
                     break;
                 }
                 case MeshResourceType::ATTA: {
-                    uint32_t count = data / sizeof(mefMeshAttaEntry_t); // Adjust count based on actual data size
-                    res = createResource<mefMeshAtta_t>(f, count, 0); // Assuming model_type is not needed
+                    uint32_t count = data / mefMeshAttaEntry_t::disk_size;
+                    res = createResource<mefMeshAtta_t>(arena, f, count, 0); // Assuming model_type is not needed
                     break;
                 }
                 case MeshResourceType::MVTX: {
                     uint32_t count = data / (sizeof(float) * 4); // Assuming each vertex has 4 floats
-                    res = createResource<mefMeshMVtx_t>(f, count, 0); // Assuming model_type is not needed
+                    res = createResource<mefMeshMVtx_t>(arena, f, count, 0); // Assuming model_type is not needed
                     break;
                 }
                 case MeshResourceType::RD3D: {
                     render3D.readData(f, data, header.model_type); // Assuming model_type is 0 for RD3D
-                    res = new mefMeshRD3D_t(render3D);
+                    res = makeResource<mefMeshRD3D_t>(arena, render3D);
                     break;
                 }
                 case MeshResourceType::GLOW: {
-                    res = createResource<mefMeshGlow_t>(f, 1, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshGlow_t>(arena, f, 1, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::HIER: {
                     uint32_t count = header.num_bones;
-                    res = createResource<mefMeshHier_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshHier_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::BNAM: {
                     uint32_t count = data / 16; // BNAME element size
-                    res = createResource<mefMeshBNam_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshBNam_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::FACE: {
                     uint32_t count = (header.sum_c_faces > 0) ? header.sum_c_faces : data / (sizeof(uint16_t) * 3); // Each face has 3 uint16_t
-                    res = createResource<mefMeshFace_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshFace_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::EDGE: {
@@ -2445,9 +2461,9 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'EDGE' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'EDGE' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshEdge_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshEdge_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::LTMP: {
@@ -2458,9 +2474,9 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'LTMP' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'LTMP' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshLtMp_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshLtMp_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::SMES: {
@@ -2471,13 +2487,13 @@ struct mefMeshChunk_t {
                         break;
                     }
                     uint32_t count = (data - 4) / stride;
-                    res = createResource<mefMeshSmes_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshSmes_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::REND: {
                     // Determine stride based on model_type
                     uint32_t stride = 32; // Default stride
-                    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>>>header.model_type: \t" << header.model_type << std::endl;
+                    LOG_DEBUG(logCategory_t::Mesh, ">>>>>>>>>>>>>>>>>>>>>>>>>>>>>header.model_type: \t" << header.model_type);
                     if (header.model_type == 3) {
                         stride = 28;
                     } else if (header.model_type != 0) {
@@ -2489,34 +2505,35 @@ struct mefMeshChunk_t {
                         std::cerr << "[mefMeshChunk_t::read] Invalid stride calculated for REND chunk." << std::endl;
                         break;
                     }
-                    uint32_t count = data / stride;
-                    std::cout << "REND DATA: \t" << data << std::endl;
-                    std::cout << "REND stride: \t" << stride << std::endl;
-                    std::cout << "REND count: \t" << count << std::endl;
+                    LOG_DEBUG(logCategory_t::Mesh, "REND DATA: \t" << data);
+                    LOG_DEBUG(logCategory_t::Mesh, "REND stride: \t" << stride);
+                    LOG_DEBUG(logCategory_t::Mesh, "REND count: \t" << data / stride);
                     uint32_t remaining_bytes = data % stride;
-                    std::cout << "REND remaining_bytes: \t" << remaining_bytes << std::endl;
+                    LOG_DEBUG(logCategory_t::Mesh, "REND remaining_bytes: \t" << remaining_bytes);
                     if (remaining_bytes != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'REND' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'REND' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
 
-                    std::cout << "[mefMeshChunk_t::read] Reading " << count << " Rend entries with stride " << stride << " bytes." << std::endl;
+                    LOG_DEBUG(logCategory_t::Mesh, "[mefMeshChunk_t::read] Reading " << data / stride << " Rend entries with stride " << stride << " bytes.");
 
-                    res = createResource<mefMeshRend_t>(f, data, header.model_type);
-                    std::cout << "[mefMeshChunk_t::read] " << type_debug << ": Count# \t" << count << "\n" << res->to_string() << "\n----------------------------" << std::endl;
+                    res = createResource<mefMeshRend_t>(arena, f, data, header.model_type);
+                    LOG_DEBUG(logCategory_t::Mesh, "[mefMeshChunk_t::read] " << intToFourCC(type, true) << ": Count# \t" << data / stride << "\n" << res->to_string() << "\n----------------------------");
 
                     break;
                 }
                 case MeshResourceType::VRTX: {
                     uint32_t stride = 32;
-                    if (header.model_type == 1) {
+                    if (header.model_type == 1 || header.model_type == 2) {
                         stride = 40;
-                        }
+                    } else if (header.model_type >= 3) {
+                        stride = 28;
+                    }
                     uint32_t count = data / stride;
                     uint32_t remaining_bytes = data % stride;
                     if (remaining_bytes != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'VRTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'VRTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshVrtx_t>(f, count, header.model_type);
+                    res = createResource<mefMeshVrtx_t>(arena, f, count, header.model_type);
                     break;
                 }
                 case MeshResourceType::CVTX: {
@@ -2527,9 +2544,9 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'CVTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'CVTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshCVtx_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshCVtx_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::SVTX: {
@@ -2540,9 +2557,9 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'CVTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'CVTX' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshSVtx_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshSVtx_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::CFCE: {
@@ -2553,9 +2570,9 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'CFCE' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'CFCE' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshCFce_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshCFce_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::SFAC: {
@@ -2566,33 +2583,33 @@ struct mefMeshChunk_t {
                         break;
                     }
                     if (data % stride != 0) {
-                        std::cerr << "[mefMeshChunk_t::read] Warning: 'SFAC' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes)." << std::endl;
+                        LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] 'SFAC' chunk size (" << data << " bytes) is not a multiple of stride (" << stride << " bytes).");
                     }
-                    res = createResource<mefMeshSFce_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshSFce_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::CMAT: {
                     uint32_t count = data / sizeof(mefMeshCMatEntry_t); // Adjust count based on material size
-                    res = createResource<mefMeshCMat_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshCMat_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::CSPH: {
                     uint32_t count = data / sizeof(mefMeshCSphEntry_t); // Sphere size is sizeof(mefMeshCSphEntry_t)
-                    res = createResource<mefMeshCSph_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshCSph_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 case MeshResourceType::MRPH: {
                     // Assuming 'MRPH' handles multiple morph targets internally
-                    res = createResource<mefMeshMrph_t>(f, 0, 0); // Assuming count and model_type are handled internally
+                    res = createResource<mefMeshMrph_t>(arena, f, 0, 0); // Assuming count and model_type are handled internally
                     break;
                 }
                 case MeshResourceType::CMSH: {
                     uint32_t count = data / sizeof(mefMeshCMshEntry_t); // CMSH size
-                    res = createResource<mefMeshCMsh_t>(f, count, 0); // Assuming model_type is 0
+                    res = createResource<mefMeshCMsh_t>(arena, f, count, 0); // Assuming model_type is 0
                     break;
                 }
                 default:
-                    std::cerr << "[mefMeshChunk_t::read] Unexpected Chunk {" << type_debug << "} @ " << pos << ", Parsing Halted." << std::endl;
+                    LOG_WARN(logCategory_t::Mesh, "[mefMeshChunk_t::read] Unexpected Chunk {" << intToFourCC(type, true) << "} @ " << pos << ", kept as raw bytes.");
                     if (stopOnNewChunk) {
                         return; // Stop if required
                     }
@@ -2600,25 +2617,39 @@ struct mefMeshChunk_t {
 
             // Print verbose information if necessary
             if (verbose && res) {
-                std::cout << "[mefMeshChunk_t::read] " << type_debug << ": Count# \t" << data << "\n" << res->to_string() << "\n----------------------------" << std::endl;
+                LOG_DEBUG(logCategory_t::Mesh, "[mefMeshChunk_t::read] " << intToFourCC(type, true) << ": Count# \t" << data << "\n" << res->to_string() << "\n----------------------------");
             }
         }
 
-        // Calculate padding and adjust file pointer to the next chunk
+        // Keep whatever the resource left unread so the chunk can be written back verbatim
+        size_t payload_end = pos + 16 + static_cast<size_t>(data);
+        if (f.good() && f.tellg() < payload_end) {
+            size_t remaining = std::min(payload_end - f.tellg(), f.remaining());
+            tail.assign(f.ptr(), f.ptr() + remaining);
+        }
+
+        // Calculate padding and adjust file pointer to the next chunk
         uint32_t padding = (4 - (data % 4)) % 4;
-        f.seekg(pos + static_cast<std::streamoff>(16 + data + padding));
+        f.seekg(pos + static_cast<size_t>(16 + data + padding));
     }
 
-    // Write method to serialize the chunk back to the file
-    void write(std::ofstream &f) const {
+    // Serializes the chunk header, payload and zero padding; the header's data
+    // field is recomputed from the payload, flag and size are written as stored
+    void write(byteWriter_t &f) const {
+        size_t start = f.tellp();
         writeValue(f, type);   // Write type
-        writeValue(f, data);   // Write data
+        writeValue(f, data);   // Placeholder, patched below
         writeValue(f, flag);   // Write flag
         writeValue(f, size);   // Write size
 
         if (res) {
             res->writeData(f); // Call writeData on the resource
         }
+        f.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+
+        uint32_t payload = static_cast<uint32_t>(f.tellp() - start - 16);
+        f.patch(start + 4, &payload, sizeof(payload));
+        f.pad(start, 4);
     }
 
     // Method to convert chunk information to string
@@ -2628,7 +2659,11 @@ struct mefMeshChunk_t {
             << ", data=" << data
             << ", flag=" << flag
             << ", size=" << size
-            << ", type_debug=\"" << type_debug << "\")";
+            << ", fourcc=\"" << intToFourCC(type, true) << "\"";
+        if (!tail.empty()) {
+            oss << ", unparsed=" << tail.size();
+        }
+        oss << ")";
         if (res) {
             oss << "\nResource Details:\n" << res->to_string();
         }
@@ -2643,36 +2678,86 @@ struct mefFile_t {
     uint32_t file_unk1;     // Unknown field 1
     uint32_t file_unk2;     // Unknown field 2
     uint32_t content_type;  // Content type
+    size_t parsed_size;     // Bytes consumed by readData; unlike file_size, never more than the stream held
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena; // Backs every chunk resource; must outlive content
     std::vector<mefMeshChunk_t> content; // Vector to hold content
+    std::array<int32_t, MEF_CHUNK_SLOTS> content_index; // First content position per chunk type, -1 if absent
 
     mefFile_t()
         : file_type(static_cast<uint32_t>(MeshResourceType::IFLF)), // Replaced with enum value
           file_size(0),
           file_unk1(4),
           file_unk2(0),
-          content_type(static_cast<uint32_t>(MeshResourceType::MECO)) { // Replaced with enum value
+          content_type(static_cast<uint32_t>(MeshResourceType::MECO)), // Replaced with enum value
+          parsed_size(0) {
+        content_index.fill(-1);
     }
 
-    // Function to get content by block name
-    const mefMeshChunk_t* get_content(const std::string& block_name) const {
-        const mefMeshChunk_t* data = nullptr;
-        for (const auto& c : content) {
-            // Assuming mefMeshChunk_t has a member 'type_debug'
-            if (c.type_debug == block_name) {
-                data = &c; // Returning a pointer to the chunk
-                break;
+    mefFile_t(mefFile_t&&) = default;
+
+    // Chunks must be released before the arena they were allocated from
+    mefFile_t& operator=(mefFile_t&& other) {
+        if (this != &other) {
+            content.clear();
+            file_type = other.file_type;
+            file_size = other.file_size;
+            file_unk1 = other.file_unk1;
+            file_unk2 = other.file_unk2;
+            content_type = other.content_type;
+            parsed_size = other.parsed_size;
+            content = std::move(other.content);
+            arena = std::move(other.arena);
+            content_index = other.content_index;
+        }
+        return *this;
+    }
+
+    // Rebuilds content_index; call after modifying content directly
+    void reindex() {
+        content_index.fill(-1);
+        for (size_t i = 0; i < content.size(); ++i) {
+            int slot = mefChunkSlot(content[i].type);
+            if (slot >= 0 && content_index[slot] < 0 && content[i].res) {
+                content_index[slot] = static_cast<int32_t>(i);
             }
         }
-        return data;
+    }
+
+    // Function to get content by chunk type
+    const mefMeshChunk_t* get_content(MeshResourceType type) const {
+        int slot = mefChunkSlot(static_cast<uint32_t>(type));
+        if (slot < 0 || content_index[slot] < 0) {
+            return nullptr;
+        }
+        return &content[content_index[slot]];
+    }
+
+    // Function to get content by block name, e.g. "VRTX"
+    const mefMeshChunk_t* get_content(const std::string& block_name) const {
+        if (block_name.size() != 4) {
+            return nullptr;
+        }
+        uint32_t type = 0;
+        for (char ch : block_name) {
+            type = (type << 8) | static_cast<uint8_t>(ch);
+        }
+        return get_content(static_cast<MeshResourceType>(type));
+    }
+
+    // Typed accessor, e.g. get<mefMeshVrtx_t>(); the chunk type selects the resource class
+    template <typename T>
+    const T* get() const {
+        const mefMeshChunk_t* chunk = get_content(T::kind);
+        return chunk ? static_cast<const T*>(chunk->res.get()) : nullptr;
     }
 
 
     // Function to read from a file
-    bool readData(std::ifstream &f, float mscale = 0.0254f, bool importToScene = true) {
+    bool readData(byteStream_t &f, float mscale = 0.0254f, bool importToScene = true) {
         bool result = false;
 
         if (f.is_open()) {
-            std::streampos file_pos = f.tellg();
+            size_t file_pos = f.tellg();
             readValue(f, file_type);
 
             // Validate file type
@@ -2682,7 +2767,14 @@ struct mefFile_t {
                 readValue(f, file_unk2);
 
                 // Calculate file end position based on file_size
-                std::streampos file_end = file_pos + file_size;
+                size_t file_end = file_pos + file_size;
+
+                // Size the arena from the payload so most models need a single block; file_size is
+                // untrusted, so it counts for no more than the bytes left in the stream
+                if (!arena) {
+                    size_t payload = std::min(static_cast<size_t>(file_size), f.remaining());
+                    arena.reset(new std::pmr::monotonic_buffer_resource(std::max<size_t>(payload * 2, 4096)));
+                }
 
                 // Process only if we are within the file bounds
                 if (f.tellg() < file_end) {
@@ -2693,25 +2785,30 @@ struct mefFile_t {
 
                     // Check for correct content type
                     if (content_type == static_cast<uint32_t>(MeshResourceType::MECO)) {  // 'MECO'
-                        while (f.tellg() < file_end) {
+                        while (f.good() && f.tellg() < file_end) {
                             mefMeshChunk_t chunk;
 
                             // Read chunk data and validate
-                            chunk.read(f, mHeader, mRender3D); // Use the correct read method
+                            chunk.read(f, mHeader, mRender3D, arena.get()); // Use the correct read method
 
-                            // Check if the chunk is valid before adding
+                            // Only decoded chunks are indexed; empty and unknown ones are
+                            // kept as well so writeData reproduces the file
                             if (chunk.res != nullptr) {
-                                content.push_back(chunk); // Append chunk to content
-                            } else {
-                                std::cerr << "Warning: Chunk read failed or is null." << std::endl;
+                                int slot = mefChunkSlot(chunk.type);
+                                if (slot >= 0 && content_index[slot] < 0) {
+                                    content_index[slot] = static_cast<int32_t>(content.size());
+                                }
                             }
+                            content.push_back(std::move(chunk)); // Append chunk to content
                         }
 
+                        parsed_size = f.tellg() - file_pos;
+
                         // Validate file end position
                         if (f.tellg() == file_end) {
-                            std::cout << "Done" << std::endl;
+                            LOG_DEBUG(logCategory_t::Mesh, "Done");
                         } else {
-                            std::cerr << "Warning: File ended unexpectedly at " << f.tellg() << " bytes." << std::endl;
+                            LOG_WARN(logCategory_t::Mesh, "File ended unexpectedly at " << f.tellg() << " bytes.");
                         }
 
                         result = true;
@@ -2736,6 +2833,43 @@ struct mefFile_t {
         return result;
     }
 
+    // Serializes the IFLF/MECO header and every chunk in order; file_size is
+    // recomputed, the remaining header fields are written as stored
+    void writeData(byteWriter_t &f) const {
+        size_t start = f.tellp();
+        f.reserve(start + std::min(static_cast<size_t>(file_size), parsed_size)); // A parsed file's old size is a good estimate
+        writeValue(f, file_type);
+        writeValue(f, file_size); // Placeholder, patched below
+        writeValue(f, file_unk1);
+        writeValue(f, file_unk2);
+        writeValue(f, content_type);
+
+        for (const auto& chunk : content) {
+            chunk.write(f);
+        }
+
+        uint32_t total = static_cast<uint32_t>(f.tellp() - start);
+        f.patch(start + 4, &total, sizeof(total));
+    }
+
+    // Assembles the whole file in memory and writes it with a single call
+    bool writeData(const std::string& filePath) const {
+        byteWriter_t buffer;
+        writeData(buffer);
+
+        std::ofstream out(filePath, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Failed to open file for writing: " << filePath << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        if (!out) {
+            std::cerr << "Failed to write file: " << filePath << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     // Function to print object information
     std::string to_string() const {
         std::ostringstream oss;
@@ -2762,17 +2896,17 @@ struct mefFile_t {
             std::cerr << "[exportOBJ] Failed to open OBJ file for writing: " << filename << std::endl;
             return false;
         }
-        std::cout << "[exportOBJ] Successfully opened OBJ file: " << filename << std::endl;
+        LOG_INFO(logCategory_t::Mesh, "[exportOBJ] Successfully opened OBJ file: " << filename);
 
         // Retrieve necessary chunks
-        const mefMeshChunk_t* hier_chunk = get_content("HIER");
-        const mefMeshChunk_t* bnam_chunk = get_content("BNAM");
-        const mefMeshChunk_t* vrtx_chunk = get_content("VRTX");
-        const mefMeshChunk_t* face_chunk = get_content("FACE");
-        const mefMeshChunk_t* rend_chunk = get_content("REND");
+        const mefMeshHier_t* hier = get<mefMeshHier_t>();
+        const mefMeshBNam_t* bnam = get<mefMeshBNam_t>();
+        const mefMeshVrtx_t* vrtx = get<mefMeshVrtx_t>();
+        const mefMeshFace_t* face = get<mefMeshFace_t>();
+        const mefMeshRend_t* rend = get<mefMeshRend_t>();
 
         // Check for required chunks
-        if (!vrtx_chunk || !face_chunk || !rend_chunk) {
+        if (!vrtx || !face || !rend) {
             std::cerr << "[exportOBJ] Required chunks (VRTX, FACE, REND) are missing." << std::endl;
             objFile.close();
             return false;
@@ -2781,7 +2915,7 @@ struct mefFile_t {
         // Initialize model_type
         int model_type = 0; // Default model_type
         // If model_type is determined by the presence of HIER and BNAM, set accordingly
-        if (hier_chunk && bnam_chunk) {
+        if (hier && bnam) {
             // Assuming model_type is determined from HIER or BNAM chunks
             // Replace the following line with actual logic to set model_type
             // For example, model_type could be stored in a specific field within HIER or BNAM
@@ -2798,11 +2932,8 @@ struct mefFile_t {
         std::vector<std::array<float, 3>> bone_positions;
         std::vector<int> parent_indices;
 
-        if (hier_chunk && bnam_chunk) {
-            mefMeshHier_t* hier = dynamic_cast<mefMeshHier_t*>(hier_chunk->res);
-            mefMeshBNam_t* bnam = dynamic_cast<mefMeshBNam_t*>(bnam_chunk->res);
-
-            if (hier && bnam && hier->num_children.size() == bnam->names.size()) {
+        if (hier && bnam) {
+            if (hier->num_children.size() == bnam->names.size()) {
                 size_t num_bones = hier->num_children.size();
                 bone_names = bnam->names;
                 bone_positions.resize(num_bones);
@@ -2848,18 +2979,7 @@ struct mefFile_t {
                 std::cerr << "[exportOBJ] Invalid HIER or BNAM data." << std::endl;
             }
         } else {
-            std::cout << "[exportOBJ] Bone hierarchy not available. Exporting mesh without bone transformations." << std::endl;
-        }
-
-        // Now process vertices and faces
-        mefMeshVrtx_t* vrtx = dynamic_cast<mefMeshVrtx_t*>(vrtx_chunk->res);
-        mefMeshFace_t* face = dynamic_cast<mefMeshFace_t*>(face_chunk->res);
-        mefMeshRend_t* rend = dynamic_cast<mefMeshRend_t*>(rend_chunk->res);
-
-        if (!vrtx || !face || !rend) {
-            std::cerr << "[exportOBJ] Failed to cast resource chunks." << std::endl;
-            objFile.close();
-            return false;
+            LOG_WARN(logCategory_t::Mesh, "[exportOBJ] Bone hierarchy not available. Exporting mesh without bone transformations.");
         }
 
         if (rend->entry.empty()) {
@@ -2948,7 +3068,7 @@ struct mefFile_t {
         }
 
         objFile.close();
-        std::cout << "[exportOBJ] OBJ file exported successfully: " << filename << std::endl;
+        LOG_INFO(logCategory_t::Mesh, "[exportOBJ] OBJ file exported successfully: " << filename);
         return true;
     }
 
@@ -2956,405 +3076,119 @@ struct mefFile_t {
 };
 
 
+// Streaming MEF reader: only chunk types with a registered handler are decoded,
+// everything else is skipped by seeking past its payload.
+struct mefStreamParser_t {
+    typedef std::function<bool(mefMeshChunk_t& chunk)> handler_t; // Return false to stop parsing
 
-struct pngFile_t {
-    // Computes the CRC32 checksum for a given data buffer.
-    uint32_t calculateCRC32(const uint8_t* data, size_t length) {
-        static uint32_t table[256];
-        static bool have_table = false;
-        if (!have_table) {
-            for (uint32_t i = 0; i < 256; i++) {
-                uint32_t rem = i;
-                for (uint8_t j = 0; j < 8; j++) {
-                    if (rem & 1)
-                        rem = (rem >> 1) ^ 0xEDB88320;
-                    else
-                        rem >>= 1;
-                }
-                table[i] = rem;
-            }
-            have_table = true;
-        }
-
-        uint32_t crc = 0xFFFFFFFF;
-        for (size_t i = 0; i < length; i++) {
-            uint8_t octet = data[i];
-            crc = (crc >> 8) ^ table[(crc & 0xFF) ^ octet];
-        }
-        return ~crc;
-    }
-
-    // Computes the Adler-32 checksum for a given data buffer.
-    uint32_t adler32(const uint8_t* data, size_t length) {
-        const uint32_t MOD_ADLER = 65521;
-        uint32_t a = 1, b = 0;
-        for (size_t i = 0; i < length; ++i) {
-            a = (a + data[i]) % MOD_ADLER;
-            b = (b + a) % MOD_ADLER;
-        }
-        return (b << 16) | a;
-    }
+    mefStreamParser_t() : handlers(MEF_CHUNK_SLOTS) {}
 
-    // Compresses data using zlib's deflate with no compression (compression level 0).
-    bool compressZlib(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
-        // Initialize zlib header for no compression
-        output.push_back(0x78); // CMF: Compression Method and Flags
-        output.push_back(0x01); // FLG: Flags
-
-        // Implement a single stored block
-        size_t blockSize = input.size();
-        if (blockSize > 65535) {
-            std::cerr << "compressZlib: Data too large for single block." << std::endl;
-            return false;
+    // Handler for one chunk type; the chunk may be moved out to keep its resource
+    void on(MeshResourceType type, handler_t handler) {
+        int slot = mefChunkSlot(static_cast<uint32_t>(type));
+        if (slot >= 0) {
+            handlers[slot] = std::move(handler);
         }
-
-        uint8_t bfinal = 1; // This is the final block
-        uint8_t btype = 0;  // No compression
-        uint8_t header = (bfinal << 0) | (btype << 1);
-        output.push_back(header);
-
-        // Write LEN and NLEN in little-endian
-        uint16_t len = static_cast<uint16_t>(blockSize);
-        uint16_t nlen = ~len;
-        output.push_back(len & 0xFF);
-        output.push_back((len >> 8) & 0xFF);
-        output.push_back(nlen & 0xFF);
-        output.push_back((nlen >> 8) & 0xFF);
-
-        // Write the actual data
-        output.insert(output.end(), input.begin(), input.end());
-
-        // Write Adler-32 checksum in big-endian
-        uint32_t adler = adler32(input.data(), input.size());
-        output.push_back((adler >> 24) & 0xFF);
-        output.push_back((adler >> 16) & 0xFF);
-        output.push_back((adler >> 8) & 0xFF);
-        output.push_back(adler & 0xFF);
-
-        return true;
-    }
-
-    // Helper function to write a 32-bit unsigned integer in big-endian to an output stream
-    void writeUInt32BE(std::ostream& out, uint32_t value) {
-        out.put((value >> 24) & 0xFF);
-        out.put((value >> 16) & 0xFF);
-        out.put((value >> 8) & 0xFF);
-        out.put(value & 0xFF);
-    }
-
-    // Helper function to write a 32-bit unsigned integer in big-endian to a buffer
-    void writeUInt32BE(std::vector<uint8_t>& buffer, uint32_t value) {
-        buffer.push_back((value >> 24) & 0xFF);
-        buffer.push_back((value >> 16) & 0xFF);
-        buffer.push_back((value >> 8) & 0xFF);
-        buffer.push_back(value & 0xFF);
-    }
-
-    // Helper function to write a 4-byte ASCII string as chunk type
-    void writeChunkType(std::ostream& out, const char* type) {
-        out.put(type[0]);
-        out.put(type[1]);
-        out.put(type[2]);
-        out.put(type[3]);
     }
 
-    // Helper function to write a 4-byte ASCII string as chunk type to buffer
-    void writeChunkType(std::vector<uint8_t>& buffer, const char* type) {
-        buffer.push_back(static_cast<uint8_t>(type[0]));
-        buffer.push_back(static_cast<uint8_t>(type[1]));
-        buffer.push_back(static_cast<uint8_t>(type[2]));
-        buffer.push_back(static_cast<uint8_t>(type[3]));
-    }
-
-    bool savePNG(const char* filePath, const uint8_t* buf, unsigned int width, unsigned int height, unsigned char channels, bool flipV, bool reverse) {
-        /*
-        * This function creates a minimal PNG file with uncompressed image data.
-        * It uses zlib with no compression, which is compliant with the PNG specification.
-        */
-
-        // Open the output file in binary mode
-        std::ofstream outputFile(filePath, std::ios::binary);
-        if (!outputFile.is_open()) {
-            std::cerr << "Failed to open output PNG file: " << filePath << std::endl;
+    // Typed handler, e.g. on<mefMesh_t>([](const mefMesh_t& mesh) { ...; return true; })
+    template <typename T>
+    void on(std::function<bool(const T&)> handler) {
+        on(T::kind, [handler](mefMeshChunk_t& chunk) {
+            return handler(*static_cast<const T*>(chunk.res.get()));
+        });
+    }
+
+    // Parses an IFLF/MECO stream, dispatching chunks in file order
+    bool parse(byteStream_t &f) const {
+        size_t file_pos = f.tellg();
+        uint32_t file_type = 0, file_size = 0, file_unk1 = 0, file_unk2 = 0, content_type = 0;
+        readValue(f, file_type);
+        if (file_type != static_cast<uint32_t>(MeshResourceType::IFLF)) {
+            std::cerr << "Invalid File Header: Expected IFLF type." << std::endl;
             return false;
         }
-
-        // PNG Signature (8 bytes)
-        uint8_t pngSignature[8] = { 137,80,78,71,13,10,26,10 };
-        outputFile.write(reinterpret_cast<const char*>(pngSignature), 8);
-
-        // === IHDR Chunk ===
-        uint32_t ihdrDataSize = 13;
-        const char ihdrTypeStr[5] = "IHDR";
-        uint32_t ihdrType = 0x49484452; // "IHDR" in ASCII
-
-        // IHDR Data
-        uint8_t ihdrData[13] = {0};
-        ihdrData[0] = (width >> 24) & 0xFF;
-        ihdrData[1] = (width >> 16) & 0xFF;
-        ihdrData[2] = (width >> 8) & 0xFF;
-        ihdrData[3] = (width) & 0xFF;
-
-        ihdrData[4] = (height >> 24) & 0xFF;
-        ihdrData[5] = (height >> 16) & 0xFF;
-        ihdrData[6] = (height >> 8) & 0xFF;
-        ihdrData[7] = (height) & 0xFF;
-
-        ihdrData[8] = 8; // Bit depth
-        ihdrData[9] = (channels == 4) ? 6 : 2; // Color type: 6 (RGBA) or 2 (RGB)
-        ihdrData[10] = 0; // Compression method
-        ihdrData[11] = 0; // Filter method
-        ihdrData[12] = 0; // Interlace method
-
-        // Write IHDR Chunk Length (Big Endian)
-        writeUInt32BEStream(outputFile, ihdrDataSize);
-
-        // Write IHDR Chunk Type
-        writeChunkTypeStream(outputFile, ihdrTypeStr);
-
-        // Write IHDR Chunk Data
-        outputFile.write(reinterpret_cast<const char*>(ihdrData), ihdrDataSize);
-
-        // Calculate IHDR CRC over chunk type + data
-        std::vector<uint8_t> ihdrForCRC;
-        ihdrForCRC.insert(ihdrForCRC.end(), ihdrData, ihdrData + ihdrDataSize);
-        uint32_t ihdrCRC = calculateCRC32(reinterpret_cast<const uint8_t*>(ihdrTypeStr), 4);
-        ihdrCRC = calculateCRC32(ihdrData, ihdrDataSize);
-        ihdrCRC = calculateCRC32(reinterpret_cast<const uint8_t*>(ihdrTypeStr), 4 + ihdrDataSize);
-        ihdrCRC = calculateCRC32(reinterpret_cast<const uint8_t*>(ihdrTypeStr), 4);
-        // Correct CRC calculation: it should include chunk type + data
-        std::vector<uint8_t> ihdrCRCBuffer;
-        ihdrCRCBuffer.insert(ihdrCRCBuffer.end(), ihdrTypeStr, ihdrTypeStr + 4);
-        ihdrCRCBuffer.insert(ihdrCRCBuffer.end(), ihdrData, ihdrData + ihdrDataSize);
-        ihdrCRC = calculateCRC32(ihdrCRCBuffer.data(), ihdrCRCBuffer.size());
-
-        // Write IHDR CRC (Big Endian)
-        writeUInt32BEStream(outputFile, ihdrCRC);
-
-        // === IDAT Chunk ===
-        const char idatTypeStr[5] = "IDAT";
-        uint32_t idatType = 0x49444154; // "IDAT" in ASCII
-
-        // Prepare raw image data with filter byte (0 for no filter)
-        size_t rowSize = width * channels + 1; // 1 byte for filter type
-        size_t imageDataSize = rowSize * height;
-        std::vector<uint8_t> rawImageData(imageDataSize, 0); // Initialize all filter bytes to 0
-
-        // Copy pixel data into rawImageData with flipping and reversing as needed
-        for (unsigned int y = 0; y < height; ++y) {
-            unsigned int srcY = flipV ? (height - 1 - y) : y;
-            for (unsigned int x = 0; x < width; ++x) {
-                unsigned int srcX = reverse ? (width - 1 - x) : x;
-                size_t srcIndex = (srcY * width + srcX) * channels;
-                size_t destIndex = y * rowSize + 1 + x * channels;
-                memcpy(&rawImageData[destIndex], &buf[srcIndex], channels);
-            }
-        }
-
-        // Compress the image data using compressZlib
-        std::vector<uint8_t> compressedData;
-        if (!compressZlib(rawImageData, compressedData)) {
-            std::cerr << "Failed to compress image data." << std::endl;
+        readValue(f, file_size);
+        readValue(f, file_unk1);
+        readValue(f, file_unk2);
+        readValue(f, content_type);
+        if (content_type != static_cast<uint32_t>(MeshResourceType::MECO)) {
+            std::cerr << "Unsupported Content Type: " << content_type << std::endl;
             return false;
         }
 
-        // Write IDAT Chunk Length (Big Endian)
-        writeUInt32BEStream(outputFile, static_cast<uint32_t>(compressedData.size()));
-
-        // Write IDAT Chunk Type
-        writeChunkTypeStream(outputFile, idatTypeStr);
-
-        // Write IDAT Chunk Data
-        outputFile.write(reinterpret_cast<const char*>(compressedData.data()), compressedData.size());
+        size_t file_end = std::min(file_pos + file_size, f.size());
+        mefMesh_t header;          // Later chunks size themselves from the MESH header
+        mefMeshRD3D_t render3D;
 
-        // Calculate IDAT CRC over chunk type + data
-        std::vector<uint8_t> idatCRCBuffer;
-        idatCRCBuffer.insert(idatCRCBuffer.end(), idatTypeStr, idatTypeStr + 4);
-        idatCRCBuffer.insert(idatCRCBuffer.end(), compressedData.begin(), compressedData.end());
-        uint32_t idatCRC = calculateCRC32(idatCRCBuffer.data(), idatCRCBuffer.size());
+        while (f.good() && f.tellg() + 16 <= file_end) {
+            size_t pos = f.tellg();
+            uint32_t type = 0, data = 0;
+            readValue(f, type);
+            readValue(f, data);
 
-        // Write IDAT CRC (Big Endian)
-        writeUInt32BEStream(outputFile, idatCRC);
-
-        // === IEND Chunk ===
-        const char iendTypeStr[5] = "IEND";
-        uint32_t iendDataSize = 0;
-        uint32_t iendType = 0x49454E44; // "IEND" in ASCII
-
-        // Write IEND Chunk Length (Big Endian)
-        writeUInt32BEStream(outputFile, iendDataSize);
-
-        // Write IEND Chunk Type
-        writeChunkTypeStream(outputFile, iendTypeStr);
-
-        // No IEND Chunk Data
-
-        // Calculate IEND CRC over chunk type only
-        uint32_t iendCRC = calculateCRC32(reinterpret_cast<const uint8_t*>(iendTypeStr), 4);
-
-        // Write IEND CRC (Big Endian)
-        writeUInt32BEStream(outputFile, iendCRC);
-
-        // Close the file
-        outputFile.close();
+            int slot = mefChunkSlot(type);
+            bool wanted = slot >= 0 && handlers[slot];
+            if (!wanted && type != static_cast<uint32_t>(MeshResourceType::MESH)) {
+                // Nobody asked for this chunk; jump over it without decoding
+                uint32_t padding = (4 - (data % 4)) % 4;
+                f.seekg(pos + static_cast<size_t>(16 + data + padding));
+                continue;
+            }
 
-        return true;
+            f.seekg(pos);
+            mefMeshChunk_t chunk;
+            chunk.read(f, header, render3D);
+            if (wanted && chunk.res && !handlers[slot](chunk)) {
+                return true; // Handler has what it needs
+            }
+        }
+        return f.good();
     }
 
-    // Writes PNG data to a memory buffer
-    bool writePNG(std::vector<uint8_t>& buffer, const uint8_t* buf, unsigned int width, unsigned int height, unsigned char channels, bool flipV, bool reverse) {
-        /*
-        * This function creates a minimal PNG data stream in a memory buffer.
-        * It uses zlib with no compression, which is compliant with the PNG specification.
-        */
-
-        // Clear and reserve space for the buffer
-        buffer.clear();
-        buffer.reserve(8 + 25 + 25 + 12 + (width * height * channels) * 2); // Reserve ample space
-
-        // PNG Signature (8 bytes)
-        uint8_t pngSignature[8] = { 137,80,78,71,13,10,26,10 };
-        buffer.insert(buffer.end(), pngSignature, pngSignature + 8);
-
-        // === IHDR Chunk ===
-        uint32_t ihdrDataSize = 13;
-        const char ihdrTypeStr[5] = "IHDR";
-        uint32_t ihdrType = 0x49484452; // "IHDR" in ASCII
-
-        // IHDR Data
-        uint8_t ihdrData[13] = {0};
-        ihdrData[0] = (width >> 24) & 0xFF;
-        ihdrData[1] = (width >> 16) & 0xFF;
-        ihdrData[2] = (width >> 8) & 0xFF;
-        ihdrData[3] = (width) & 0xFF;
-
-        ihdrData[4] = (height >> 24) & 0xFF;
-        ihdrData[5] = (height >> 16) & 0xFF;
-        ihdrData[6] = (height >> 8) & 0xFF;
-        ihdrData[7] = (height) & 0xFF;
-
-        ihdrData[8] = 8; // Bit depth
-        ihdrData[9] = (channels == 4) ? 6 : 2; // Color type: 6 (RGBA) or 2 (RGB)
-        ihdrData[10] = 0; // Compression method
-        ihdrData[11] = 0; // Filter method
-        ihdrData[12] = 0; // Interlace method
-
-        // Append IHDR Chunk Length (Big Endian)
-        writeUInt32BEBuffer(buffer, ihdrDataSize);
-
-        // Append IHDR Chunk Type
-        writeChunkTypeBuffer(buffer, ihdrTypeStr);
-
-        // Append IHDR Chunk Data
-        buffer.insert(buffer.end(), ihdrData, ihdrData + ihdrDataSize);
-
-        // Calculate IHDR CRC over chunk type + data
-        std::vector<uint8_t> ihdrCRCBuffer;
-        ihdrCRCBuffer.insert(ihdrCRCBuffer.end(), ihdrTypeStr, ihdrTypeStr + 4);
-        ihdrCRCBuffer.insert(ihdrCRCBuffer.end(), ihdrData, ihdrData + ihdrDataSize);
-        uint32_t ihdrCRC = calculateCRC32(ihdrCRCBuffer.data(), ihdrCRCBuffer.size());
-
-        // Append IHDR CRC (Big Endian)
-        writeUInt32BEBuffer(buffer, ihdrCRC);
-
-        // === IDAT Chunk ===
-        const char idatTypeStr[5] = "IDAT";
-        uint32_t idatType = 0x49444154; // "IDAT" in ASCII
-
-        // Prepare raw image data with filter byte (0 for no filter)
-        size_t rowSize = width * channels + 1; // 1 byte for filter type
-        size_t imageDataSize = rowSize * height;
-        std::vector<uint8_t> rawImageData(imageDataSize, 0); // Initialize all filter bytes to 0
-
-        // Copy pixel data into rawImageData with flipping and reversing as needed
-        for (unsigned int y = 0; y < height; ++y) {
-            unsigned int srcY = flipV ? (height - 1 - y) : y;
-            for (unsigned int x = 0; x < width; ++x) {
-                unsigned int srcX = reverse ? (width - 1 - x) : x;
-                size_t srcIndex = (srcY * width + srcX) * channels;
-                size_t destIndex = y * rowSize + 1 + x * channels;
-                memcpy(&rawImageData[destIndex], &buf[srcIndex], channels);
-            }
-        }
-
-        // Compress the image data using compressZlib
-        std::vector<uint8_t> compressedData;
-        if (!compressZlib(rawImageData, compressedData)) {
-            std::cerr << "Failed to compress image data." << std::endl;
+    bool parse(const std::string& filePath) const {
+        mappedFile_t file;
+        if (!file.open(filePath)) {
             return false;
         }
+        byteStream_t f(file);
+        return parse(f);
+    }
 
-        // Append IDAT Chunk Length (Big Endian)
-        writeUInt32BEBuffer(buffer, static_cast<uint32_t>(compressedData.size()));
-
-        // Append IDAT Chunk Type
-        writeChunkTypeBuffer(buffer, idatTypeStr);
-
-        // Append IDAT Chunk Data
-        buffer.insert(buffer.end(), compressedData.begin(), compressedData.end());
-
-        // Calculate IDAT CRC over chunk type + data
-        std::vector<uint8_t> idatCRCBuffer;
-        idatCRCBuffer.insert(idatCRCBuffer.end(), idatTypeStr, idatTypeStr + 4);
-        idatCRCBuffer.insert(idatCRCBuffer.end(), compressedData.begin(), compressedData.end());
-        uint32_t idatCRC = calculateCRC32(idatCRCBuffer.data(), idatCRCBuffer.size());
-
-        // Append IDAT CRC (Big Endian)
-        writeUInt32BEBuffer(buffer, idatCRC);
-
-        // === IEND Chunk ===
-        const char iendTypeStr[5] = "IEND";
-        uint32_t iendDataSize = 0;
-        uint32_t iendType = 0x49454E44; // "IEND" in ASCII
-
-        // Append IEND Chunk Length (Big Endian)
-        writeUInt32BEBuffer(buffer, iendDataSize);
-
-        // Append IEND Chunk Type
-        writeChunkTypeBuffer(buffer, iendTypeStr);
-
-        // No IEND Chunk Data
+private:
+    std::vector<handler_t> handlers; // Indexed by mefChunkSlot
+};
 
-        // Calculate IEND CRC over chunk type only
-        uint32_t iendCRC = calculateCRC32(reinterpret_cast<const uint8_t*>(iendTypeStr), 4);
 
-        // Append IEND CRC (Big Endian)
-        writeUInt32BEBuffer(buffer, iendCRC);
 
-        return true;
-    }
+// PNG export of raw RGB or RGBA buffers through the pngwriter encoder
+struct pngFile_t {
+    pngLevel_t level = pngLevel_t::Default;
+    threadPool_t* pool = nullptr; // Compresses large images in parallel segments when set
+    bool bgr = false;             // Input pixels are BGR(A) rather than RGB(A)
 
-private:
-    // Helper function to write a 32-bit unsigned integer in big-endian to an output stream
-    void writeUInt32BEStream(std::ostream& out, uint32_t value) {
-        out.put((value >> 24) & 0xFF);
-        out.put((value >> 16) & 0xFF);
-        out.put((value >> 8) & 0xFF);
-        out.put(value & 0xFF);
+    // Wraps input in a zlib stream at the current level
+    bool compressZlib(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) const {
+        return pngCompress(input.data(), input.size(), level, output);
     }
 
-    // Helper function to write a 32-bit unsigned integer in big-endian to a buffer
-    void writeUInt32BEBuffer(std::vector<uint8_t>& buffer, uint32_t value) {
-        buffer.push_back((value >> 24) & 0xFF);
-        buffer.push_back((value >> 16) & 0xFF);
-        buffer.push_back((value >> 8) & 0xFF);
-        buffer.push_back(value & 0xFF);
+    bool savePNG(const char* filePath, const uint8_t* buf, unsigned int width, unsigned int height, unsigned char channels, bool flipV, bool reverse) const {
+        return pngSave(filePath, buf, width, height, channels, options(flipV, reverse));
     }
 
-    // Helper function to write a 4-byte ASCII string as chunk type to an output stream
-    void writeChunkTypeStream(std::ostream& out, const char* type) {
-        out.put(type[0]);
-        out.put(type[1]);
-        out.put(type[2]);
-        out.put(type[3]);
+    bool writePNG(std::vector<uint8_t>& buffer, const uint8_t* buf, unsigned int width, unsigned int height, unsigned char channels, bool flipV, bool reverse) const {
+        return pngEncode(buf, width, height, channels, options(flipV, reverse), buffer);
     }
 
-    // Helper function to write a 4-byte ASCII string as chunk type to a buffer
-    void writeChunkTypeBuffer(std::vector<uint8_t>& buffer, const char* type) {
-        buffer.push_back(static_cast<uint8_t>(type[0]));
-        buffer.push_back(static_cast<uint8_t>(type[1]));
-        buffer.push_back(static_cast<uint8_t>(type[2]));
-        buffer.push_back(static_cast<uint8_t>(type[3]));
+private:
+    pngOptions_t options(bool flipV, bool reverse) const {
+        pngOptions_t opts;
+        opts.level = level;
+        opts.flipV = flipV;
+        opts.reverse = reverse;
+        opts.swapRB = bgr;
+        opts.pool = pool;
+        return opts;
     }
 };
 
@@ -3377,34 +3211,26 @@ struct tgaFile_t {
     std::vector<uint8_t> id_field;        // ID field data
     std::vector<uint8_t> color_map_data;  // Color map data
     std::vector<uint8_t> image_data;      // Image data (decoded)
+    std::vector<std::vector<uint8_t>> mips;  // 32-bit levels below image_data for the GPU, each half the size of the last
+    bool bgr = true;                      // image_data is BGR(A) as stored in a TGA file; images converted from TEX are RGBA
 
     // Opens a TGA image file and reads its contents
     bool open(const char* filename) {
-        // Open file in binary mode
-        std::ifstream file(filename, std::ios::binary | std::ios::ate);
-        if (!file) {
+        // Map the file into memory
+        mappedFile_t file;
+        if (!file.open(filename)) {
             std::cerr << "Error: Could not open file " << filename << std::endl;
             return false;
         }
 
         // Get file size
-        std::ifstream::pos_type fileSize = file.tellg();
-        if (fileSize < 18) { // Minimum TGA header size
+        if (file.size() < 18) { // Minimum TGA header size
             std::cerr << "Error: File size is too small to be a valid TGA file." << std::endl;
             return false;
         }
-        file.seekg(0, std::ios::beg);
 
-        // Read entire file into buffer
-        std::vector<uint8_t> buffer(static_cast<size_t>(fileSize));
-        if (!file.read(reinterpret_cast<char*>(&buffer[0]), fileSize)) {
-            std::cerr << "Error: Failed to read file " << filename << std::endl;
-            return false;
-        }
-        file.close();
-
-        // Parse the buffer
-        return read(&buffer[0], buffer.size());
+        // Parse the mapped view directly
+        return read(file.data(), file.size());
     }
 
     // Reads TGA image from a memory buffer
@@ -3415,6 +3241,7 @@ struct tgaFile_t {
         }
 
         size_t offset = 0;
+        bgr = true;
 
         // Read header
         id_length = buffer[offset++];
@@ -3488,77 +3315,48 @@ struct tgaFile_t {
                 std::cerr << "Error: Image data exceeds buffer size." << std::endl;
                 return false;
             }
-            std::vector<uint8_t> raw_data(data_size);
-            memcpy(&raw_data[0], buffer + offset, data_size);
 
             // For color-mapped images, expand indices to colors
             if (color_map_type != 0) {
-                if (!expandColorMappedData(&raw_data[0], raw_data.size())) {
+                if (!expandColorMappedData(buffer + offset, data_size)) {
                     std::cerr << "Error: Failed to expand color-mapped data." << std::endl;
                     return false;
                 }
             } else {
-                image_data.swap(raw_data);
+                image_data.assign(buffer + offset, buffer + offset + data_size);
             }
         }
 
         return true;
     }
 
-    // Writes TGA image to a memory buffer in 32-bit 8-8-8-8 format
-    bool write(std::vector<uint8_t>& buffer) {
-        // If current pixel_depth is not 32, convert image_data to 32-bit format
-        if (pixel_depth != 32) {
-            if (!convertTo32Bit()) {
+    /**
+     * Writes TGA image to a memory buffer; the image itself is left untouched.
+     * Uncompressed output is always 32-bit 8-8-8-8. With rle, 8-bit grayscale
+     * stays 8-bit (type 11), images with at most 256 colors become 8-bit
+     * indices into a 32-bit color map (type 9) and the rest 32-bit (type 10).
+     */
+    bool write(std::vector<uint8_t>& buffer, bool rle = false) const {
+        bool grayscale = pixel_depth == 8 && color_map_type == 0;
+        // Otherwise, if current pixel_depth is not 32, write a 32-bit conversion instead
+        if (pixel_depth != 32 && !(rle && grayscale)) {
+            tgaFile_t converted(*this);
+            if (!converted.convertTo32Bit()) {
                 std::cerr << "Error: Failed to convert image data to 32-bit format." << std::endl;
                 return false;
             }
+            return converted.write(buffer, rle);
+        }
+        if (rle) {
+            return writeRLE(buffer);
         }
-
-        // Prepare header fields for 32-bit uncompressed image
-        id_length = 0; // No ID field
-        color_map_type = 0; // No color map
-        image_type = 2; // Uncompressed True-color image
-        color_map_origin = 0;
-        color_map_length = 0;
-        color_map_depth = 0;
-        pixel_depth = 32;
-        image_descriptor = 0x28; // Top-left origin, 8 bits alpha channel
 
         // Start writing data into buffer
         buffer.clear();
         buffer.reserve(18 + image_data.size());
 
-        // Write header
-        buffer.push_back(id_length);
-        buffer.push_back(color_map_type);
-        buffer.push_back(image_type);
-
-        buffer.push_back(color_map_origin & 0xFF);
-        buffer.push_back((color_map_origin >> 8) & 0xFF);
-
-        buffer.push_back(color_map_length & 0xFF);
-        buffer.push_back((color_map_length >> 8) & 0xFF);
-
-        buffer.push_back(color_map_depth);
-
-        buffer.push_back(x_origin & 0xFF);
-        buffer.push_back((x_origin >> 8) & 0xFF);
-
-        buffer.push_back(y_origin & 0xFF);
-        buffer.push_back((y_origin >> 8) & 0xFF);
-
-        buffer.push_back(width & 0xFF);
-        buffer.push_back((width >> 8) & 0xFF);
-
-        buffer.push_back(height & 0xFF);
-        buffer.push_back((height >> 8) & 0xFF);
-
-        buffer.push_back(pixel_depth);
-        buffer.push_back(image_descriptor);
-
-        // No ID field
-        // No color map data
+        // Uncompressed true-color image, top-left origin, 8 bits alpha; no ID field or color map
+        appendHeader(buffer, 2, 0, 0, 32, 0x28);
 
         // Write image data
         buffer.insert(buffer.end(), image_data.begin(), image_data.end());
@@ -3566,10 +3364,10 @@ struct tgaFile_t {
         return true;
     }
 
-    // Saves TGA image to a file
-    bool save(const char* filename) {
+    // Saves TGA image to a file, RLE-compressed if rle is set
+    bool save(const char* filename, bool rle = false) const {
         std::vector<uint8_t> buffer;
-        if (!write(buffer)) {
+        if (!write(buffer, rle)) {
             std::cerr << "Error: Failed to write TGA data to memory buffer." << std::endl;
             return false;
         }
@@ -3590,6 +3388,30 @@ struct tgaFile_t {
         return true;
     }
 
+    // Box-filters the missing mip levels down to 1x1 from the last one present; converts the image to 32-bit first
+    bool buildMips() {
+        if (pixel_depth != 32 && !convertTo32Bit()) {
+            return false;
+        }
+        if (image_data.size() != static_cast<size_t>(width) * height * 4) {
+            return false;
+        }
+        size_t w = width, h = height;
+        for (size_t i = 0; i < mips.size(); ++i) {
+            w = std::max<size_t>(1, w / 2);
+            h = std::max<size_t>(1, h / 2);
+        }
+        while (w > 1 || h > 1) {
+            const uint8_t* src = mips.empty() ? image_data.data() : mips.back().data();
+            std::vector<uint8_t> level(std::max<size_t>(1, w / 2) * std::max<size_t>(1, h / 2) * 4);
+            pixelDownsample2x(src, w, h, level.data());
+            mips.push_back(std::move(level));
+            w = std::max<size_t>(1, w / 2);
+            h = std::max<size_t>(1, h / 2);
+        }
+        return true;
+    }
+
     /**
      * @brief Flips the image horizontally (mirrors along the X-axis).
      */
@@ -3599,17 +3421,9 @@ struct tgaFile_t {
             return;
         }
 
-        size_t bytesPerPixel = 4;
+        size_t rowBytes = static_cast<size_t>(width) * 4;
         for (uint16_t y = 0; y < height; ++y) {
-            for (uint16_t x = 0; x < width / 2; ++x) {
-                size_t leftIndex = (y * width + x) * bytesPerPixel;
-                size_t rightIndex = (y * width + (width - 1 - x)) * bytesPerPixel;
-
-                // Swap the pixels
-                for (size_t byte = 0; byte < bytesPerPixel; ++byte) {
-                    std::swap(image_data[leftIndex + byte], image_data[rightIndex + byte]);
-                }
-            }
+            pixelReverse32(&image_data[y * rowBytes], width);
         }
     }
 
@@ -3622,18 +3436,7 @@ struct tgaFile_t {
             return;
         }
 
-        size_t bytesPerPixel = 4;
-        for (uint16_t y = 0; y < height / 2; ++y) {
-            for (uint16_t x = 0; x < width; ++x) {
-                size_t topIndex = (y * width + x) * bytesPerPixel;
-                size_t bottomIndex = ((height - 1 - y) * width + x) * bytesPerPixel;
-
-                // Swap the pixels
-                for (size_t byte = 0; byte < bytesPerPixel; ++byte) {
-                    std::swap(image_data[topIndex + byte], image_data[bottomIndex + byte]);
-                }
-            }
-        }
+        pixelFlipRows(image_data.data(), static_cast<size_t>(width) * 4, height);
     }
 
     /**
@@ -3645,334 +3448,203 @@ struct tgaFile_t {
             return;
         }
 
-        size_t bytesPerPixel = 4;
-        size_t totalPixels = width * height;
-
-        for (size_t i = 0; i < totalPixels; ++i) {
-            size_t index = i * bytesPerPixel;
-            // Swap Red (index + 2) and Blue (index + 0)
-            std::swap(image_data[index + 0], image_data[index + 2]);
-        }
+        pixelSwapRB32(image_data.data(), static_cast<size_t>(width) * height);
     }
 
     /**
-     * @brief Saves the TGA image as a PNG file.
-     * @param filePath Path to save the PNG file.
+     * @brief Encodes the image as PNG; 24- and 32-bit images only.
+     * The pixels are left untouched, flipV and reverse are applied while encoding.
+     * @param buffer Vector to store the PNG data.
      * @param flipV Whether to flip the image vertically.
      * @param reverse Whether to reverse the pixel order horizontally.
+     * @param level Speed/size trade-off of the encoder.
+     * @param pool Compresses large images in parallel segments when set; not a pool the caller runs on.
      * @return True on success, false on failure.
      */
-    bool saveAsPNG2(const char* filePath, bool flipV = false, bool reverse = false) {
+    bool writeAsPNG(std::vector<uint8_t>& buffer, bool flipV = false, bool reverse = false, pngLevel_t level = pngLevel_t::Default, threadPool_t* pool = nullptr) const {
+        unsigned int bytesPerPixel = pngBytesPerPixel();
+        if (bytesPerPixel == 0) {
+            return false;
+        }
         pngFile_t png;
-        return png.savePNG(filePath, &image_data[0], width, height, 4, flipV, reverse);
+        png.level = level;
+        png.pool = pool;
+        png.bgr = bgr;
+        return png.writePNG(buffer, image_data.data(), width, height, bytesPerPixel, flipV, reverse);
     }
 
-    // CRC32 calculation
-    uint32_t crc32(const unsigned char* data, size_t length) const {
-        uint32_t crc = 0xFFFFFFFF;
-        for (size_t i = 0; i < length; ++i) {
-            crc ^= data[i];
-            for (int j = 0; j < 8; ++j) {
-                if (crc & 1)
-                    crc = (crc >> 1) ^ 0xEDB88320;
-                else
-                    crc >>= 1;
-            }
+    // Same, streamed to filePath a few rows at a time
+    bool saveAsPNG(const std::string& filePath, bool flipV = false, bool reverse = false, pngLevel_t level = pngLevel_t::Default, threadPool_t* pool = nullptr) const {
+        unsigned int bytesPerPixel = pngBytesPerPixel();
+        if (bytesPerPixel == 0) {
+            return false;
         }
-        return ~crc;
-    }
-
-    // Helper functions for endian conversion
-    uint32_t toBigEndian(uint32_t value) const {
-        return htonl(value);
-    }
-
-    uint16_t toBigEndian(uint16_t value) const {
-        return htons(value);
+        pngFile_t png;
+        png.level = level;
+        png.pool = pool;
+        png.bgr = bgr;
+        return png.savePNG(filePath.c_str(), image_data.data(), width, height, bytesPerPixel, flipV, reverse);
     }
 
-
-    bool writeAsPNG(std::vector<uint8_t>& buffer, bool flipV = false, bool reverse = false) {
-        // Calculate necessary sizes
+private:
+    // 3 or 4 when the image can be written as PNG, else 0
+    unsigned int pngBytesPerPixel() const {
         unsigned int bytesPerPixel = pixel_depth / 8;
-        if (bytesPerPixel != 3 && bytesPerPixel != 4) {
-            // Only support RGB and RGBA for simplicity
-            return false;
-        }
-        unsigned int width_stride = width * bytesPerPixel;
-        unsigned int image_size = width * height * bytesPerPixel;
-        unsigned int data_size = image_size + height; // Including filter bytes
-
-        // Flip vertically if required
-        if (flipV) {
-            for (unsigned int y = 0; y < height / 2; ++y) {
-                unsigned int topIndex = y * width_stride;
-                unsigned int bottomIndex = (height - 1 - y) * width_stride;
-                for (unsigned int x = 0; x < width_stride; ++x) {
-                    std::swap(image_data[topIndex + x], image_data[bottomIndex + x]);
-                }
-            }
+        if ((bytesPerPixel != 3 && bytesPerPixel != 4) || image_data.size() != static_cast<size_t>(width) * height * bytesPerPixel) {
+            std::cerr << "PNG export: Only complete 24- and 32-bit images are supported." << std::endl;
+            return 0;
         }
+        return bytesPerPixel;
+    }
 
-        // Initialize buffer for PNG data
-        buffer.clear();
-
-        // Write PNG Signature
-        unsigned char png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
-        buffer.insert(buffer.end(), png_signature, png_signature + 8);
-
-        // Helper lambda to write a PNG chunk
-        auto writeChunk = [&](const char* type, const std::vector<unsigned char>& data) -> bool {
-            uint32_t length = toBigEndian(static_cast<uint32_t>(data.size()));
-            buffer.insert(buffer.end(), reinterpret_cast<unsigned char*>(&length), reinterpret_cast<unsigned char*>(&length) + 4);
-            buffer.insert(buffer.end(), type, type + 4);
-            if (!data.empty()) {
-                buffer.insert(buffer.end(), data.begin(), data.end());
-            }
-            // Calculate CRC over chunk type and data
-            std::vector<unsigned char> crcData;
-            crcData.reserve(4 + data.size());
-            crcData.insert(crcData.end(), type, type + 4);
-            crcData.insert(crcData.end(), data.begin(), data.end());
-            uint32_t crc = toBigEndian(crc32(crcData.data(), crcData.size()));
-            buffer.insert(buffer.end(), reinterpret_cast<unsigned char*>(&crc), reinterpret_cast<unsigned char*>(&crc) + 4);
-            return true;
-        };
+    // Color map entries indexed by raw pixel value, built once per image
+    struct colorLookup_t {
+        size_t indexSize = 0;
+        size_t entrySize = 0;
+        std::vector<uint8_t> entries;     // entrySize bytes for every possible index, zero outside the map
+        std::vector<uint8_t> valid;       // Non-zero where the index falls inside the map
+        std::vector<uint32_t> entries32;  // The 256 entries as 32-bit pixels, for 8-bit indices into a 32-bit map
+        bool allValid = false;
+    };
 
-        // Create IHDR data
-        std::vector<unsigned char> ihdrData;
-        ihdrData.reserve(13);
-        uint32_t be_width = toBigEndian(static_cast<uint32_t>(width));
-        uint32_t be_height = toBigEndian(static_cast<uint32_t>(height));
-        ihdrData.insert(ihdrData.end(), reinterpret_cast<unsigned char*>(&be_width), reinterpret_cast<unsigned char*>(&be_width) + 4);
-        ihdrData.insert(ihdrData.end(), reinterpret_cast<unsigned char*>(&be_height), reinterpret_cast<unsigned char*>(&be_height) + 4);
-        ihdrData.push_back(8); // Bit depth
-        ihdrData.push_back((bytesPerPixel == 3) ? 2 : 6); // Color type: 2=RGB, 6=RGBA
-        ihdrData.push_back(0); // Compression method
-        ihdrData.push_back(0); // Filter method
-        ihdrData.push_back(0); // Interlace method
-
-        // Write IHDR chunk
-        if (!writeChunk("IHDR", ihdrData)) {
+    bool buildColorLookup(colorLookup_t& lookup) const {
+        if (color_map_data.empty()) {
+            std::cerr << "Error: Color map data is missing." << std::endl;
             return false;
         }
-
-        // Create IDAT data (zlib stream with no compression)
-        std::vector<unsigned char> idatData;
-
-        // Zlib header for no compression: CMF=0x78, FLG=0x01
-        idatData.push_back(0x78);
-        idatData.push_back(0x01);
-
-        // Initialize Adler-32 checksum variables
-        const uint32_t MOD_ADLER = 65521;
-        uint32_t a = 1;
-        uint32_t b = 0;
-
-        // Prepare image data with filter bytes
-        std::vector<unsigned char> imageBytes;
-        imageBytes.reserve(data_size);
-        unsigned int p = 0; // Pointer for reverse reading if necessary
-
-        for (unsigned int y = 0; y < height; ++y) {
-            imageBytes.push_back(0x00); // No filter for each scanline
-            // Update checksum for filter byte
-            a = (a + 0x00) % MOD_ADLER;
-            b = (b + a) % MOD_ADLER;
-
-            for (unsigned int x = 0; x < width_stride; ++x) {
-                unsigned char pixelByte = reverse ? image_data[--p] : image_data[p++];
-                imageBytes.push_back(pixelByte);
-
-                // Update Adler-32 checksum
-                a = (a + pixelByte) % MOD_ADLER;
-                b = (b + a) % MOD_ADLER;
-            }
-        }
-
-        // Combine a and b to form the final Adler-32 checksum
-        uint32_t adler32 = (b << 16) | a;
-
-        // Split data into chunks of at most 65535 bytes
-        size_t offset = 0;
-        size_t remaining = imageBytes.size();
-        while (remaining > 0) {
-            // Determine block size (max 65535 bytes)
-            size_t blockSize = std::min<size_t>(remaining, 65535);
-
-            // BFINAL is 1 for the last block, 0 otherwise
-            bool isFinalBlock = (remaining == blockSize);
-            unsigned char bfinal = isFinalBlock ? 0x01 : 0x00;
-
-            // Add deflate block header: BFINAL | BTYPE
-            idatData.push_back(bfinal); // BTYPE = 00 (no compression)
-
-            // Write LEN and NLEN in little endian
-            uint16_t len = static_cast<uint16_t>(blockSize);
-            uint16_t nlen = ~len;
-
-            // Push len and nlen (little-endian)
-            idatData.push_back(len & 0xFF);
-            idatData.push_back((len >> 8) & 0xFF);
-            idatData.push_back(nlen & 0xFF);
-            idatData.push_back((nlen >> 8) & 0xFF);
-
-            // Write uncompressed data block
-            idatData.insert(idatData.end(), imageBytes.begin() + offset, imageBytes.begin() + offset + blockSize);
-
-            // Update offset and remaining data size
-            offset += blockSize;
-            remaining -= blockSize;
-        }
-
-        // Write Adler-32 checksum at the end of the deflate stream (big endian)
-        uint32_t be_adler = toBigEndian(adler32);
-        idatData.insert(idatData.end(), reinterpret_cast<unsigned char*>(&be_adler), reinterpret_cast<unsigned char*>(&be_adler) + 4);
-
-        // Write IDAT chunk
-        if (!writeChunk("IDAT", idatData)) {
+        lookup.indexSize = pixel_depth / 8;
+        lookup.entrySize = color_map_depth / 8;
+        if (lookup.indexSize != 1 && lookup.indexSize != 2) {
+            std::cerr << "Error: Unsupported index size: " << lookup.indexSize << std::endl;
             return false;
         }
-
-        // Write IEND chunk (no data)
-        std::vector<unsigned char> iendData; // Empty
-        if (!writeChunk("IEND", iendData)) {
+        if (lookup.entrySize == 0) {
+            std::cerr << "Error: Unsupported color map depth: " << static_cast<int>(color_map_depth) << std::endl;
             return false;
         }
 
+        size_t indexCount = static_cast<size_t>(1) << (8 * lookup.indexSize);
+        lookup.entries.assign(indexCount * lookup.entrySize, 0);
+        lookup.valid.assign(indexCount, 0);
+        size_t mapped = 0;
+        for (size_t i = 0; i < color_map_length && color_map_origin + i < indexCount; ++i) {
+            size_t index = color_map_origin + i;
+            memcpy(&lookup.entries[index * lookup.entrySize], &color_map_data[i * lookup.entrySize], lookup.entrySize);
+            lookup.valid[index] = 1;
+            mapped++;
+        }
+        lookup.allValid = mapped == indexCount;
+        if (lookup.indexSize == 1 && lookup.entrySize == 4) {
+            lookup.entries32.resize(256);
+            memcpy(lookup.entries32.data(), lookup.entries.data(), 256 * 4);
+        }
         return true;
     }
 
-    bool saveAsPNG(const std::string& filePath, bool flipV = false, bool reverse = false) {
-        std::vector<uint8_t> buffer;
-
-        // Generate the PNG buffer
-        if (!writeAsPNG(buffer, flipV, reverse)) {
-            return false;
+    // Expands count indices through the lookup table into dst
+    bool expandIndices(const colorLookup_t& lookup, const uint8_t* indices, size_t count, uint8_t* dst) const {
+        if (!lookup.allValid) {
+            for (size_t i = 0; i < count; ++i) {
+                size_t index = lookup.indexSize == 1 ? indices[i] : (indices[i * 2] | (indices[i * 2 + 1] << 8));
+                if (!lookup.valid[index]) {
+                    std::cerr << "Error: Color map index out of bounds: " << index << std::endl;
+                    return false;
+                }
+            }
         }
-
-        // Open file for writing
-        std::ofstream outFile(filePath, std::ios::binary);
-        if (!outFile.is_open()) {
-            return false;
+        if (!lookup.entries32.empty()) {
+            pixelExpandIndexed8(indices, lookup.entries32.data(), dst, count);
+            return true;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            size_t index = lookup.indexSize == 1 ? indices[i] : (indices[i * 2] | (indices[i * 2 + 1] << 8));
+            memcpy(dst + i * lookup.entrySize, &lookup.entries[index * lookup.entrySize], lookup.entrySize);
         }
-
-        // Write buffer to file
-        outFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-        outFile.close();
-
         return true;
     }
 
-
-    /**
-     * @brief Writes the PNG image data to a memory buffer.
-     * @param buffer Vector to store the PNG data.
-     * @param flipV Whether to flip the image vertically.
-     * @param reverse Whether to reverse the pixel order horizontally.
-     * @return True on success, false on failure.
-     */
-    bool writeAsPNG2(std::vector<uint8_t>& buffer, bool flipV = false, bool reverse = false) {
-        pngFile_t png;
-        return png.writePNG(buffer, &image_data[0], width, height, 4, flipV, reverse);
-    }
-
-private:
-    // Decodes RLE compressed data
+    // Decodes RLE compressed data; color-mapped indices are expanded as the packets are read
     bool decodeRLEData(const uint8_t* data, size_t size) {
         size_t pixel_size = pixel_depth / 8;
-        size_t total_pixels = width * height;
+        size_t total_pixels = static_cast<size_t>(width) * height;
+        bool mapped = color_map_type != 0;
+        colorLookup_t lookup;
+        if (mapped && !buildColorLookup(lookup)) {
+            return false;
+        }
+        size_t out_size = mapped ? lookup.entrySize : pixel_size;
+
+        image_data.resize(total_pixels * out_size);
         size_t offset = 0;
         size_t pixels_read = 0;
-
-        image_data.resize(total_pixels * pixel_size);
-
         while (pixels_read < total_pixels) {
             if (offset >= size) {
                 std::cerr << "Error: RLE data ends prematurely." << std::endl;
                 return false;
             }
             uint8_t packet_header = data[offset++];
-            uint8_t packet_type = packet_header & 0x80;
-            uint8_t pixel_count = (packet_header & 0x7F) + 1;
+            size_t packet_pixels = (packet_header & 0x7F) + 1;
+            // A last packet reaching past the image is cut off
+            size_t pixel_count = std::min(packet_pixels, total_pixels - pixels_read);
+            uint8_t* dst = &image_data[pixels_read * out_size];
 
-            if (packet_type) {
-                // RLE packet
+            if (packet_header & 0x80) {
+                // RLE packet: one value repeated
                 if (offset + pixel_size > size) {
                     std::cerr << "Error: RLE packet data exceeds buffer size." << std::endl;
                     return false;
                 }
-                const uint8_t* pixel_data = data + offset;
-                offset += pixel_size;
-
-                for (uint8_t i = 0; i < pixel_count; ++i) {
-                    if (pixels_read >= total_pixels)
-                        break;
-                    memcpy(&image_data[(pixels_read++) * pixel_size], pixel_data, pixel_size);
+                if (mapped) {
+                    if (!expandIndices(lookup, data + offset, 1, dst)) {
+                        return false;
+                    }
+                    pixelFill(dst + out_size, dst, out_size, pixel_count - 1);
+                } else {
+                    pixelFill(dst, data + offset, out_size, pixel_count);
                 }
+                offset += pixel_size;
             } else {
                 // Raw packet
-                size_t packet_data_size = pixel_count * pixel_size;
+                size_t packet_data_size = packet_pixels * pixel_size;
                 if (offset + packet_data_size > size) {
                     std::cerr << "Error: Raw packet data exceeds buffer size." << std::endl;
                     return false;
                 }
-                memcpy(&image_data[pixels_read * pixel_size], data + offset, packet_data_size);
+                if (mapped) {
+                    if (!expandIndices(lookup, data + offset, pixel_count, dst)) {
+                        return false;
+                    }
+                } else {
+                    memcpy(dst, data + offset, pixel_count * pixel_size);
+                }
                 offset += packet_data_size;
-                pixels_read += pixel_count;
             }
+            pixels_read += pixel_count;
         }
 
-        // For color-mapped images, expand indices to colors
-        if (color_map_type != 0) {
-            std::vector<uint8_t> raw_indices = image_data;
-            if (!expandColorMappedData(&raw_indices[0], raw_indices.size())) {
-                std::cerr << "Error: Failed to expand color-mapped data from RLE." << std::endl;
-                return false;
-            }
+        // Color-mapped pixels now hold color map entries
+        if (mapped) {
+            pixel_depth = color_map_depth;
         }
-
         return true;
     }
 
     // Expands color-mapped image data using the color map
     bool expandColorMappedData(const uint8_t* data, size_t size) {
-        if (color_map_data.empty()) {
-            std::cerr << "Error: Color map data is missing." << std::endl;
+        colorLookup_t lookup;
+        if (!buildColorLookup(lookup)) {
             return false;
         }
 
-        size_t index_size = pixel_depth / 8;
-        size_t color_map_entry_size = color_map_depth / 8;
-        size_t total_pixels = width * height;
-
-        if (size != total_pixels * index_size) {
+        size_t total_pixels = static_cast<size_t>(width) * height;
+        if (size != total_pixels * lookup.indexSize) {
             std::cerr << "Error: Data size does not match expected size for color-mapped image." << std::endl;
             return false;
         }
 
-        image_data.resize(total_pixels * color_map_entry_size);
-
-        for (size_t i = 0; i < total_pixels; ++i) {
-            uint16_t index = 0;
-            if (index_size == 1) {
-                index = data[i];
-            } else if (index_size == 2) {
-                index = data[i * 2] | (data[i * 2 + 1] << 8);
-            } else {
-                std::cerr << "Error: Unsupported index size: " << index_size << std::endl;
-                return false;
-            }
-
-            if (index < color_map_origin || index >= color_map_origin + color_map_length) {
-                std::cerr << "Error: Color map index out of bounds: " << index << std::endl;
-                return false;
-            }
-
-            size_t color_map_index = (index - color_map_origin) * color_map_entry_size;
-            memcpy(&image_data[i * color_map_entry_size],
-                   &color_map_data[color_map_index],
-                   color_map_entry_size);
+        image_data.resize(total_pixels * lookup.entrySize);
+        if (!expandIndices(lookup, data, total_pixels, image_data.data())) {
+            return false;
         }
 
         // Update pixel depth to match color map entry size
@@ -3981,48 +3653,168 @@ private:
         return true;
     }
 
-    // Converts image_data to 32-bit 8-8-8-8 format (BGRA)
-    bool convertTo32Bit() {
-        size_t total_pixels = width * height;
-        size_t current_pixel_size = pixel_depth / 8;
+    // Appends the 18-byte header; origin and size come from this image, there is never an ID field
+    void appendHeader(std::vector<uint8_t>& buffer, uint8_t type, uint8_t mapType, uint16_t mapLength, uint8_t depth, uint8_t descriptor, uint8_t mapDepth = 0) const {
+        const uint8_t fields[18] = {
+            0, mapType, type,
+            0, 0, static_cast<uint8_t>(mapLength & 0xFF), static_cast<uint8_t>(mapLength >> 8), mapDepth,
+            static_cast<uint8_t>(x_origin & 0xFF), static_cast<uint8_t>(x_origin >> 8),
+            static_cast<uint8_t>(y_origin & 0xFF), static_cast<uint8_t>(y_origin >> 8),
+            static_cast<uint8_t>(width & 0xFF), static_cast<uint8_t>(width >> 8),
+            static_cast<uint8_t>(height & 0xFF), static_cast<uint8_t>(height >> 8),
+            depth, descriptor
+        };
+        buffer.insert(buffer.end(), fields, fields + sizeof(fields));
+    }
 
-        std::vector<uint8_t> new_image_data(total_pixels * 4); // 4 bytes per pixel
+    static bool samePixel(const uint8_t* a, const uint8_t* b, size_t pixelSize) {
+        switch (pixelSize) {
+            case 1:
+                return *a == *b;
+            case 4: {
+                uint32_t va, vb;
+                memcpy(&va, a, 4);
+                memcpy(&vb, b, 4);
+                return va == vb;
+            }
+            default:
+                return memcmp(a, b, pixelSize) == 0;
+        }
+    }
 
-        for (size_t i = 0; i < total_pixels; ++i) {
-            uint8_t r = 0, g = 0, b = 0, a = 255;
-            size_t index = i * current_pixel_size;
-
-            if (pixel_depth == 24) {
-                // Assuming image_data is in BGR format
-                b = image_data[index];
-                g = image_data[index + 1];
-                r = image_data[index + 2];
-            } else if (pixel_depth == 16) {
-                // Assuming 16-bit RGB555 format
-                uint16_t pixel = image_data[index] | (image_data[index + 1] << 8);
-                a = (pixel & 0x8000) ? 255 : 0;
-                r = ((pixel & 0x7C00) >> 10) << 3;
-                g = ((pixel & 0x03E0) >> 5) << 3;
-                b = (pixel & 0x001F) << 3;
-            } else if (pixel_depth == 8) {
-                // Grayscale image
-                b = g = r = image_data[index];
-            } else if (pixel_depth == 32) {
-                // Already in 32-bit format
-                b = image_data[index];
-                g = image_data[index + 1];
-                r = image_data[index + 2];
-                a = image_data[index + 3];
-            } else {
-                std::cerr << "Error: Unsupported pixel depth: " << static_cast<int>(pixel_depth) << std::endl;
-                return false;
+    // Appends the RLE packets for one scanline; packets never span two lines
+    static void encodeRLERow(const uint8_t* row, size_t count, size_t pixelSize, std::vector<uint8_t>& out) {
+        // A repeat packet pays off from 2 equal pixels, or 3 for 1-byte pixels
+        const size_t minRun = pixelSize == 1 ? 3 : 2;
+        auto runLength = [&](size_t i) {
+            size_t n = 1;
+            while (i + n < count && n < 128 && samePixel(row + (i + n) * pixelSize, row + i * pixelSize, pixelSize)) {
+                n++;
+            }
+            return n;
+        };
+
+        size_t i = 0;
+        while (i < count) {
+            size_t run = runLength(i);
+            if (run >= minRun) {
+                out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+                out.insert(out.end(), row + i * pixelSize, row + (i + 1) * pixelSize);
+                i += run;
+                continue;
+            }
+
+            // Raw packet up to the next run worth its own packet
+            size_t start = i;
+            i += run;
+            while (i < count && i - start < 128) {
+                run = runLength(i);
+                if (run >= minRun) {
+                    break;
+                }
+                i += run;
+            }
+            i = std::min(i, start + 128);
+            out.push_back(static_cast<uint8_t>(i - start - 1));
+            out.insert(out.end(), row + start * pixelSize, row + i * pixelSize);
+        }
+    }
+
+    // RLE output for 8-bit grayscale or 32-bit images, see write()
+    bool writeRLE(std::vector<uint8_t>& buffer) const {
+        size_t total_pixels = static_cast<size_t>(width) * height;
+        size_t pixel_size = pixel_depth / 8;
+        if (image_data.size() < total_pixels * pixel_size) {
+            std::cerr << "Error: Image data is smaller than " << width << "x" << height << std::endl;
+            return false;
+        }
+
+        buffer.clear();
+        if (pixel_size == 1) {
+            buffer.reserve(18 + total_pixels / 2);
+            appendHeader(buffer, 11, 0, 0, 8, 0x20);
+            for (size_t y = 0; y < height; ++y) {
+                encodeRLERow(&image_data[y * width], width, 1, buffer);
+            }
+            return true;
+        }
+
+        // Up to 256 colors are stored as indices into a color map
+        std::unordered_map<uint32_t, uint8_t> palette;
+        std::vector<uint32_t> colors;
+        std::vector<uint8_t> indices(total_pixels);
+        uint32_t last = 0;
+        uint8_t lastIndex = 0;
+        bool indexed = true;
+        for (size_t i = 0; i < total_pixels && indexed; ++i) {
+            uint32_t value;
+            memcpy(&value, &image_data[i * 4], 4);
+            if (i == 0 || value != last) {
+                auto it = palette.find(value);
+                if (it == palette.end()) {
+                    if (colors.size() == 256) {
+                        indexed = false;
+                        break;
+                    }
+                    it = palette.emplace(value, static_cast<uint8_t>(colors.size())).first;
+                    colors.push_back(value);
+                }
+                last = value;
+                lastIndex = it->second;
+            }
+            indices[i] = lastIndex;
+        }
+
+        if (indexed) {
+            buffer.reserve(18 + colors.size() * 4 + total_pixels / 2);
+            appendHeader(buffer, 9, 1, static_cast<uint16_t>(colors.size()), 8, 0x28, 32);
+            const uint8_t* map = reinterpret_cast<const uint8_t*>(colors.data());
+            buffer.insert(buffer.end(), map, map + colors.size() * 4);
+            for (size_t y = 0; y < height; ++y) {
+                encodeRLERow(&indices[y * width], width, 1, buffer);
+            }
+        } else {
+            buffer.reserve(18 + total_pixels * 2);
+            appendHeader(buffer, 10, 0, 0, 32, 0x28);
+            for (size_t y = 0; y < height; ++y) {
+                encodeRLERow(&image_data[y * width * 4], width, 4, buffer);
             }
+        }
+        return true;
+    }
+
+    // Converts image_data to 32-bit 8-8-8-8 format (BGRA)
+    bool convertTo32Bit() {
+        size_t total_pixels = width * height;
+        size_t current_pixel_size = pixel_depth / 8;
+        if (image_data.size() < total_pixels * current_pixel_size) {
+            std::cerr << "Error: Image data is smaller than " << width << "x" << height << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> new_image_data(total_pixels * 4); // 4 bytes per pixel
 
-            // Store in BGRA order
-            new_image_data[i * 4]     = b;
-            new_image_data[i * 4 + 1] = g;
-            new_image_data[i * 4 + 2] = r;
-            new_image_data[i * 4 + 3] = a;
+        if (pixel_depth == 24) {
+            // BGR gains an opaque alpha
+            pixelExpand24To32(image_data.data(), new_image_data.data(), total_pixels);
+        } else if (pixel_depth == 16) {
+            // Assuming 16-bit RGB555 format
+            pixelConvert1555To8888(image_data.data(), new_image_data.data(), total_pixels, pixelOrder_t::BGRA);
+        } else if (pixel_depth == 8) {
+            // Grayscale image
+            for (size_t i = 0; i < total_pixels; ++i) {
+                uint8_t v = image_data[i];
+                new_image_data[i * 4]     = v;
+                new_image_data[i * 4 + 1] = v;
+                new_image_data[i * 4 + 2] = v;
+                new_image_data[i * 4 + 3] = 255;
+            }
+        } else if (pixel_depth == 32) {
+            // Already in 32-bit format
+            std::memcpy(new_image_data.data(), image_data.data(), new_image_data.size());
+        } else {
+            std::cerr << "Error: Unsupported pixel depth: " << static_cast<int>(pixel_depth) << std::endl;
+            return false;
         }
 
         image_data.swap(new_image_data);
@@ -4031,6 +3823,164 @@ private:
     }
 };
 
+// Decoded texture shared by every archive chunk, model and window that uses it; never modified once published
+typedef std::shared_ptr<const tgaFile_t> textureRef_t;
+
+/**
+ * Process-wide registry of decoded textures keyed by normalized name and a
+ * checksum of the encoded bytes, so a texture referenced from several places
+ * is decoded and held only once, while archives that reuse a name for
+ * different pixels each get their own. The store keeps weak references:
+ * pixels are freed with the last view.
+ */
+class textureStore_t {
+public:
+    static textureStore_t& shared() {
+        static textureStore_t store;
+        return store;
+    }
+
+    // Case-insensitive, separator-agnostic key for a texture name
+    static std::string normalize(const std::string& name) {
+        std::string key(name);
+        for (char& c : key) {
+            c = (c == '\\') ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return key;
+    }
+
+    // Store key for the texture encoded in data under name
+    static std::string key(const std::string& name, const uint8_t* data, size_t size) {
+        char digest[40];
+        snprintf(digest, sizeof(digest), "#%zx:%08x%08x", size, checksumCrc32(0, data, size), checksumAdler32(1, data, size));
+        return normalize(name) + digest;
+    }
+
+    // Live view of the texture stored under key, or null when nobody holds it
+    textureRef_t find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        return it != entries.end() ? it->second.lock() : textureRef_t();
+    }
+
+    // Publishes a decoded texture; when another thread got there first, its view is returned instead
+    textureRef_t insert(const std::string& key, tgaFile_t&& texture) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<const tgaFile_t>& slot = entries[key];
+        textureRef_t existing = slot.lock();
+        if (existing) {
+            return existing;
+        }
+        textureRef_t view = std::make_shared<const tgaFile_t>(std::move(texture));
+        slot = view;
+        if (++inserts % 256 == 0) {
+            prune();
+        }
+        return view;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        prune();
+        return entries.size();
+    }
+
+private:
+    // Drops keys whose last view has gone
+    void prune() {
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = it->second.expired() ? entries.erase(it) : std::next(it);
+        }
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const tgaFile_t>> entries;
+    size_t inserts = 0;
+};
+
+// TEX pixel formats, selected by the low nibble of texFile_t::image_type
+enum class texPixelFormat_t : int32_t {
+    Palette4 = 0x0,
+    Palette8 = 0x1,
+    ARGB1555 = 0x2,
+    ARGB8888 = 0x3,
+    ARGB4444 = 0x4,
+    RGB565 = 0x5,
+    Intensity8 = 0x6,
+    Bumpmap = 0x7,
+};
+
+// Decodes count pixels to RGBA8888; palette holds the 32-bit entries of indexed formats
+typedef void (*texDecodeFn_t)(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t* palette);
+
+struct texFormat_t {
+    texPixelFormat_t format;
+    const char* name;
+    uint32_t bitsPerPixel;
+    uint32_t paletteEntries;    // Non-zero for indexed formats
+    texDecodeFn_t decode;
+};
+
+// ARGB8888 pixels are kept in their stored byte order
+inline void texDecode8888(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    std::memcpy(dst, src, count * 4);
+}
+
+inline void texDecode1555(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    pixelConvert1555To8888(src, dst, count, pixelOrder_t::RGBA);
+}
+
+inline void texDecode4444(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    pixelConvert4444To8888(src, dst, count, pixelOrder_t::RGBA);
+}
+
+inline void texDecode565(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    pixelConvert565To8888(src, dst, count, pixelOrder_t::RGBA);
+}
+
+inline void texDecodeIntensity8(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    pixelExpandIntensity8(src, dst, count);
+}
+
+inline void texDecodePalette4(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t* palette) {
+    pixelExpandIndexed4(src, palette, dst, count);
+}
+
+inline void texDecodePalette8(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t* palette) {
+    pixelExpandIndexed8(src, palette, dst, count);
+}
+
+// Signed 8-bit du/dv offsets, shown the way a normal map would be
+inline void texDecodeBumpmap(const uint8_t* src, uint8_t* dst, size_t count, const uint32_t*) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = static_cast<uint8_t>(src[i * 2] ^ 0x80);
+        dst[i * 4 + 1] = static_cast<uint8_t>(src[i * 2 + 1] ^ 0x80);
+        dst[i * 4 + 2] = 255;
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+const texFormat_t texFormats[] = {
+    { texPixelFormat_t::Palette4,   "Palette4",   4,  16,  texDecodePalette4 },
+    { texPixelFormat_t::Palette8,   "Palette8",   8,  256, texDecodePalette8 },
+    { texPixelFormat_t::ARGB1555,   "ARGB1555",   16, 0,   texDecode1555 },
+    { texPixelFormat_t::ARGB8888,   "ARGB8888",   32, 0,   texDecode8888 },
+    { texPixelFormat_t::ARGB4444,   "ARGB4444",   16, 0,   texDecode4444 },
+    { texPixelFormat_t::RGB565,     "RGB565",     16, 0,   texDecode565 },
+    { texPixelFormat_t::Intensity8, "Intensity8", 8,  0,   texDecodeIntensity8 },
+    { texPixelFormat_t::Bumpmap,    "Bumpmap",    16, 0,   texDecodeBumpmap },
+};
+
+// Format entry for an image_type or palette flags value, or nullptr when unknown
+inline const texFormat_t* texFindFormat(int32_t imageType) {
+    for (const texFormat_t& format : texFormats) {
+        if (static_cast<int32_t>(format.format) == (imageType & 0x0F)) {
+            return &format;
+        }
+    }
+    return nullptr;
+}
+
 struct texFile_t {
 
 	/*
@@ -4076,17 +4026,19 @@ struct texFile_t {
     int16_t croppedHeight;
     int16_t bytesPerPixel;
     std::vector<uint8_t> imageData;
+    std::vector<std::vector<uint8_t>> mipData;  // Stored levels below imageData, largest first
 
-    bool open(const std::string &filePath, std::ifstream &inputFile) {
-        inputFile.open(filePath.c_str(), std::ios::binary);
-        if (!inputFile.is_open()) {
+    bool open(const std::string &filePath, mappedFile_t &inputFile) {
+        if (!inputFile.open(filePath)) {
             std::cerr << "Failed to open file: " << filePath << std::endl;
             return false;
         }
         return true;
     }
 
-    bool read(std::ifstream &inputFile, bool verbose = true) {
+    bool read(byteStream_t &inputFile, bool verbose = true) {
+        size_t start = inputFile.tellg();
+
         // Read the header
         readValue(inputFile, ident);
         readValue(inputFile, version);
@@ -4109,61 +4061,109 @@ struct texFile_t {
         }
 
         // Print header values for debugging
-        if (verbose) {std::cout << "Header: " << ident << " " << version << " " << width << "x" << height << " " << croppedWidth << "x" << croppedHeight << " " << image_type << std::endl;}
-
-        // Check image type and parse accordingly
-        switch (image_type) {
-            case 67: // ARGB8888 format (32 bits per pixel)
-                imageData.resize(width * height * 4);
-                inputFile.read(reinterpret_cast<char*>(imageData.data()), width * height * 4);
-                if (!inputFile) {
-                    std::cerr << "Failed to read image data for ARGB8888 format." << std::endl;
-                    return false;
-                }
-                break;
+        if (verbose) { LOG_INFO(logCategory_t::Texture, "Header: " << ident << " " << version << " " << width << "x" << height << " " << croppedWidth << "x" << croppedHeight << " " << image_type); }
 
-            case 2: // ARGB1555 format (16 bits per pixel)
-                imageData.resize(width * height * 2);
-                inputFile.read(reinterpret_cast<char*>(imageData.data()), width * height * 2);
-                if (!inputFile) {
-                    std::cerr << "Failed to read image data for ARGB1555 format." << std::endl;
-                    return false;
-                }
-                convert1555To8888();
-                break;
+        const texFormat_t* format = texFindFormat(image_type);
+        if (format == nullptr) {
+            std::cerr << "Unsupported image type: " << image_type << " encountered." << std::endl;
+            std::cerr << "Please verify that the texture format is supported." << std::endl;
+            return false;
+        }
 
-            default:
-                std::cerr << "Unsupported image type: " << image_type << " encountered." << std::endl;
-                std::cerr << "Please verify that the texture format is supported." << std::endl;
-                return false;
+        // Indexed formats look their colours up in the palette block that follows the mips
+        std::vector<uint32_t> palette;
+        if (format->paletteEntries > 0 && !readPalette(inputFile, start, format->paletteEntries, palette)) {
+            std::cerr << "Failed to read palette for " << format->name << " format." << std::endl;
+            return false;
+        }
+
+        size_t pixels = static_cast<size_t>(width) * height;
+        size_t storedSize = (pixels * format->bitsPerPixel + 7) / 8;
+        if (storedSize > inputFile.remaining()) {
+            std::cerr << "Failed to read image data for " << format->name << " format." << std::endl;
+            return false;
         }
+        imageData.resize(pixels * 4);
+        format->decode(inputFile.ptr(), imageData.data(), pixels, palette.data());
+        inputFile.skip(storedSize);
+        bytesPerPixel = 4;
+
+        // The smaller mips follow, down to 1x1 or until the palette block or the data ends
+        size_t dataEnd = inputFile.size();
+        if (paletteOffset > 0) {
+            dataEnd = std::min(dataEnd, start + static_cast<size_t>(paletteOffset));
+        }
+        mipData.clear();
+        for (size_t w = width, h = height; w > 1 || h > 1;) {
+            w = std::max<size_t>(1, w / 2);
+            h = std::max<size_t>(1, h / 2);
+            size_t levelSize = (w * h * format->bitsPerPixel + 7) / 8;
+            if (inputFile.tellg() + levelSize > dataEnd) {
+                break;
+            }
+            std::vector<uint8_t> level(w * h * 4);
+            format->decode(inputFile.ptr(), level.data(), w * h, palette.data());
+            inputFile.skip(levelSize);
+            mipData.push_back(std::move(level));
+        }
+        if (verbose) { LOG_INFO(logCategory_t::Texture, "Stored mip levels: " << (mipData.size() + 1)); }
 
         return true;
     }
 
-    void convert1555To8888() {
-        std::vector<uint8_t> convertedData;
-        convertedData.reserve(width * height * 4);
-
-        for (size_t i = 0; i < imageData.size(); i += 2) {
-            uint16_t pixel = imageData[i] | (imageData[i + 1] << 8);
+    /**
+     * Reads the palette block at paletteOffset: a 16-byte header (ident, version,
+     * conversion mode, and flags holding the entries' pixel format) followed by
+     * the entries. They are decoded to RGBA like image pixels; missing entries stay black.
+     */
+    bool readPalette(byteStream_t& inputFile, size_t start, uint32_t entries, std::vector<uint32_t>& palette) {
+        if (paletteOffset <= 0) {
+            return false;
+        }
+        byteStream_t f(inputFile.data(), inputFile.size());
+        f.seekg(start + static_cast<size_t>(paletteOffset));
+        int32_t paletteIdent, paletteVersion, conversionMode, flags;
+        readValue(f, paletteIdent);
+        readValue(f, paletteVersion);
+        readValue(f, conversionMode);
+        readValue(f, flags);
+        const texFormat_t* entryFormat = texFindFormat(flags);
+        if (!f || entryFormat == nullptr || entryFormat->paletteEntries > 0) {
+            return false;
+        }
 
-            uint8_t a = (pixel & 0x8000) ? 255 : 0;
-            uint8_t r = ((pixel & 0x7C00) >> 10) << 3;
-            uint8_t g = ((pixel & 0x03E0) >> 5) << 3;
-            uint8_t b = (pixel & 0x001F) << 3;
+        size_t storedSize = entries * entryFormat->bitsPerPixel / 8;
+        if (storedSize > f.remaining()) {
+            return false;
+        }
+        // Always 256 entries, so out-of-range indices read black instead of past the table
+        palette.assign(256, 0);
+        entryFormat->decode(f.ptr(), reinterpret_cast<uint8_t*>(palette.data()), entries, nullptr);
+        return true;
+    }
 
-            convertedData.push_back(r);
-            convertedData.push_back(g);
-            convertedData.push_back(b);
-            convertedData.push_back(a);
+    bool toTga(tgaFile_t& tga) const & {
+        if (!toTgaHeader(tga)) {
+            return false;
         }
 
-        imageData = std::move(convertedData);
-        bytesPerPixel = 4; // **Ensure bytesPerPixel is updated to 4**
+        // Image data: Keep in RGBA order
+        tga.image_data = imageData; // Assuming imageData is already in RGBA order
+        tga.mips = mipData;
+        return true;
+    }
+
+    // Same, handing the pixels over instead of copying them
+    bool toTga(tgaFile_t& tga) && {
+        if (!toTgaHeader(tga)) {
+            return false;
+        }
+        tga.image_data = std::move(imageData);
+        tga.mips = std::move(mipData);
+        return true;
     }
 
-    bool toTga(tgaFile_t& tga) const {
+    bool toTgaHeader(tgaFile_t& tga) const {
         if (bytesPerPixel != 4) {
             std::cerr << "Error: Unsupported bytes per pixel for TGA conversion: " << bytesPerPixel << std::endl;
             return false;
@@ -4181,18 +4181,16 @@ struct texFile_t {
         tga.height = height;
         tga.pixel_depth = 32;
         tga.image_descriptor = 0x28; // Top-left origin, 8 bits alpha channel
+        tga.bgr = false;             // The TEX decoders write RGBA, which is also what the GPU upload expects
 
         // No ID field
         tga.id_field.clear();
 
         // No color map
         tga.color_map_data.clear();
-
-        // Image data: Keep in RGBA order
-        tga.image_data = imageData; // Assuming imageData is already in RGBA order
-
         return true;
     }
+
     bool writeTGA(const std::string &filePath, bool flipX = false, bool flipY = false, bool swapRGBA = false) {
         std::ofstream outputFile(filePath.c_str(), std::ios::binary);
         if (!outputFile.is_open()) {
@@ -4266,134 +4264,96 @@ struct resChunk_t {
     uint32_t chunk_size;
     std::string filename;
     std::string filepath;
-    tgaFile_t texture;
+    textureRef_t texture;   // Shared through textureStore_t
     mefFile_t model;
 
     resChunk_t() {}
     ~resChunk_t() {}
 
-    // Reads a resource chunk from the input stream
-    bool read(std::ifstream& f, std::string& current_name, std::string& current_path, bool verbose = false) {
-        bool result = f.good();
-
-        // Read chunk type, buffer size, unk1, chunk size
-        readValue(f, chunk_type);
-        readValue(f, buffer_size);
-        readValue(f, unk1);
-        readValue(f, chunk_size);
-
-        // Read initial file position
-        size_t buffer_pos = f.tellg();
-
-        // Process based on chunk type
-
-        switch (static_cast<MeshResourceType>(chunk_type)) {
-        case MeshResourceType::NAME: { // 'NAME'
-            if (verbose) { std::cout << "Chunk type: 'NAME'" << std::endl; }
-            if (!readString(f, current_name)) {
-                std::cerr << "Failed to read 'NAME' string." << std::endl;
-                result = false;
-            }
-            if (verbose) { std::cout << "Read filename: " << current_name << std::endl; }
-            break;
-        }
+    // Decodes a BODY payload positioned at f; filename selects the decoder.
+    // buildMips gives textures without a stored mip chain one built on the CPU.
+    bool readBody(byteStream_t& f, bool verbose = false, bool buildMips = false) {
+        bool result = true;
 
-        case MeshResourceType::PATH: { // 'PATH'
-            if (verbose) { std::cout << "Chunk type: 'PATH'" << std::endl; }
-            if (!readString(f, current_path)) {
-                std::cerr << "Failed to read 'PATH' string." << std::endl;
+        if (verbose) { LOG_INFO(logCategory_t::Archive, "Processing file type: " << get_extension(filename)); }
+
+        bool isTexture = hasExtension(filename, ".tex") || hasExtension(filename, ".tga");
+        std::string storeKey;
+        if (isTexture) {
+            storeKey = textureStore_t::key(filename, f.ptr(), std::min(static_cast<size_t>(buffer_size), f.remaining()));
+        }
+        if (isTexture && (texture = textureStore_t::shared().find(storeKey))) {
+            // Same bytes already decoded for another archive, model or window
+            if (verbose) { LOG_INFO(logCategory_t::Archive, "Texture already decoded: " << filename); }
+        } else if (hasExtension(filename, ".tex")) {
+            if (verbose) { LOG_INFO(logCategory_t::Archive, "File type matches '.tex'"); }
+            // Read TEX file data; the stream ends with the BODY so the mip chain cannot run into the next entry
+            texFile_t texFile;
+            byteStream_t texStream(f.ptr(), std::min(static_cast<size_t>(buffer_size), f.remaining()));
+            if (!texFile.read(texStream, verbose)) {
+                std::cerr << "Failed to read TEX file: " << filename << std::endl;
                 result = false;
-            }
-            if (verbose) { std::cout << "Read filepath: " << current_path << std::endl; }
-            break;
-        }
-
-        case MeshResourceType::BODY: { // 'BODY'
-            if (verbose) { std::cout << "Chunk type: 'BODY'" << std::endl; }
-            filename = current_name;
-            filepath = current_path;
-
-            std::string file_type = getFilename::Type(filename);
-            if (verbose) { std::cout << "Processing file type: " << file_type << std::endl; }
+            } else {
+                if (verbose) { LOG_INFO(logCategory_t::Archive, "Successfully read TEX file: " << filename); }
 
-            if (matchPattern(file_type, ".tex")) {
-                if (verbose) { std::cout << "File type matches '.tex'" << std::endl; }
-                // Read TEX file data
-                texFile_t texFile;
-                if (!texFile.read(f)) {
-                    std::cerr << "Failed to read TEX file: " << filename << std::endl;
+                // Convert TEX to TGA and publish it as this name's texture
+                tgaFile_t tga;
+                if (!std::move(texFile).toTga(tga)) {
+                    std::cerr << "Failed to convert TEX to TGA for file: " << filename << std::endl;
                     result = false;
                 } else {
-                    if (verbose) { std::cout << "Successfully read TEX file: " << filename << std::endl; }
-
-                    // Convert TEX to TGA and store in texture
-                    if (!texFile.toTga(texture)) {
-                        std::cerr << "Failed to convert TEX to TGA for file: " << filename << std::endl;
-                        result = false;
-                    } else {
-                        if (verbose) { std::cout << "Successfully converted TEX to TGA for file: " << filename << std::endl; }
-                        // Optional: Save as PNG for testing
-                        // texture.saveAsPNG("test.png");
+                    if (verbose) { LOG_INFO(logCategory_t::Archive, "Successfully converted TEX to TGA for file: " << filename); }
+                    if (buildMips) {
+                        tga.buildMips();
                     }
+                    texture = textureStore_t::shared().insert(storeKey, std::move(tga));
                 }
-            } else if (matchPattern(file_type, ".tga")) {
-                if (verbose) { std::cout << "File type matches '.tga'" << std::endl; }
-                // Read TGA file data
-                std::vector<uint8_t> tgaData = readTGAData(f, chunk_size);
-                if (verbose) { std::cout << "Read TGA data of size: " << tgaData.size() << std::endl; }
-
-                if (tgaData.empty() || !texture.read(tgaData.data(), tgaData.size())) {
-                    std::cerr << "Failed to read TGA file: " << filename << std::endl;
-                    result = false;
-                } else {
-                    if (verbose) { std::cout << "Successfully read TGA file: " << filename << std::endl; }
-                }
-            } else if (matchPattern(file_type, ".mef")) {
-                if (verbose) { std::cout << "File type matches '.mef'" << std::endl; }
-                // Read MEF file data
-                std::streampos current_pos = f.tellg();
+            }
+        } else if (hasExtension(filename, ".tga")) {
+            if (verbose) { LOG_INFO(logCategory_t::Archive, "File type matches '.tga'"); }
+            // Parse the TGA directly from the mapped buffer
+            if (chunk_size > f.remaining()) {
+                std::cerr << "Error: TGA data runs past the end of the stream." << std::endl;
+                result = false;
+            } else if (verbose) { LOG_INFO(logCategory_t::Archive, "Read TGA data of size: " << chunk_size); }
 
-                if (!model.readData(f)) {
-                    std::cerr << "Failed to read MEF file: " << filename << std::endl;
-                    result = false;
-                } else {
-                    if (verbose) { std::cout << "Successfully read MEF file: " << filename << std::endl; }
-                    // The model data is stored in 'model'
+            tgaFile_t tga;
+            if (!result || chunk_size == 0 || !tga.read(f.ptr(), chunk_size)) {
+                std::cerr << "Failed to read TGA file: " << filename << std::endl;
+                result = false;
+            } else {
+                if (verbose) { LOG_INFO(logCategory_t::Archive, "Successfully read TGA file: " << filename); }
+                if (buildMips) {
+                    tga.buildMips();
                 }
+                texture = textureStore_t::shared().insert(storeKey, std::move(tga));
+            }
+        } else if (hasExtension(filename, ".mef")) {
+            if (verbose) { LOG_INFO(logCategory_t::Archive, "File type matches '.mef'"); }
+            // Read MEF file data
+            if (!model.readData(f)) {
+                std::cerr << "Failed to read MEF file: " << filename << std::endl;
+                result = false;
             } else {
-                std::cerr << "Undocumented file type {" << filename << "} at position " << buffer_pos << std::endl;
+                if (verbose) { LOG_INFO(logCategory_t::Archive, "Successfully read MEF file: " << filename); }
+                // The model data is stored in 'model'
             }
-
-            // Reset current_name and current_path
-            current_name.clear();
-            current_path.clear();
-            break;
-        }
-
-        default: {
-            std::cerr << "Unexpected Type {" << intToFourCC(chunk_type) << "} at position " << buffer_pos << std::endl;
-            // Skip the chunk data
-            if (verbose) { std::cout << "Skipping chunk. New position after alignment: " << f.tellg() << std::endl; }
-            result = false;
-        }
+        } else {
+            std::cerr << "Undocumented file type {" << filename << "} at position " << f.tellg() << std::endl;
         }
-        size_t aligned_pos = buffer_pos + buffer_size + ((unk1 - (buffer_size % unk1)) % unk1);
-        f.seekg(aligned_pos, std::ios::beg);
-
-        if (verbose) { std::cout << "Finished processing chunk. Stream position: " << aligned_pos << std::endl; }
 
         return result;
     }
+};
 
-private:
-    std::vector<uint8_t> readTGAData(std::ifstream& f, uint32_t size) {
-        std::vector<uint8_t> buffer(size);
-        if (!f.read(reinterpret_cast<char*>(&buffer[0]), size)) {
-            std::cerr << "Error: Failed to read TGA data from stream." << std::endl;
-            buffer.clear();
-        }
-        return buffer;
-    }
+// Location of one BODY payload inside a RES archive, recorded without decoding it
+struct resEntry_t {
+    std::string filename;
+    std::string filepath;
+    uint32_t buffer_size;
+    uint32_t unk1;
+    uint32_t chunk_size;
+    size_t offset;          // Start of the BODY payload in the mapped file
 };
 
 struct resFile_t {
@@ -4402,26 +4362,32 @@ struct resFile_t {
     uint32_t unk1;
     uint32_t unk2;
     uint32_t res_type;
-    std::vector<resChunk_t> chunks;
+    bool buildMips;     // Complete each texture's mip chain on the decoding thread, for GPU upload
 
-    bool read(const std::string& filePath) {
-        std::ifstream f(filePath.c_str(), std::ios::binary);
-        if (!f.is_open()) {
+    resFile_t() : magic(0), filesize(0), unk1(0), unk2(0), res_type(0), buildMips(false) {}
+
+    // Maps the archive and builds the table of contents; no BODY is decoded here
+    bool open(const std::string& filePath) {
+        entries.clear();
+        decoded.clear();
+        nameIndex.clear();
+
+        if (!file.open(filePath)) {
             std::cerr << "Failed to open file: " << filePath << "\n";
             return false;
         }
+        byteStream_t f(file);
 
         // Read magic (little endian)
         readValue(f, magic);
         if (magic != static_cast<uint32_t>(MeshResourceType::ILFF)) { // 'ILFF'
-            std::cerr << "Unexpected magic value: " << std::hex << magic << "\n";
-            f.close();
+            std::cerr << "Unexpected magic value: " << std::hex << magic << std::dec << "\n";
             return false;
         }
 
         // Read filesize (little endian)
         readValue(f, filesize);
-        std::streampos end_pos = f.tellg() + static_cast<std::streamoff>(filesize) - 4;
+        size_t end_pos = std::min(f.tellg() + static_cast<size_t>(filesize) - 4, f.size());
 
         // Read unk1 and unk2 (little endian)
         readValue(f, unk1);
@@ -4431,24 +4397,181 @@ struct resFile_t {
         readValue(f, res_type);
 
         // Process based on res_type
-        if (res_type == static_cast<uint32_t>(MeshResourceType::IRES)) { // 'IRES'
-            std::string current_name, current_path;
-            while (f.tellg() + 16 < end_pos && f.good()) {
-                resChunk_t chunk;
-                if (!chunk.read(f, current_name, current_path)) {
-                    std::cerr << "Failed to read resChunk_t at position: " << f.tellg() << "\n";
-                    return false; // Exiting the loop on read failure
+        if (res_type != static_cast<uint32_t>(MeshResourceType::IRES)) { // 'IRES'
+            LOG_WARN(logCategory_t::Archive, "Unknown Asset In Container {" << res_type << "}");
+            return true;
+        }
+
+        std::string current_name, current_path;
+        while (f.tellg() + 16 < end_pos && f.good()) {
+            uint32_t chunk_type, buffer_size, align, chunk_size;
+            readValue(f, chunk_type);
+            readValue(f, buffer_size);
+            readValue(f, align);
+            readValue(f, chunk_size);
+            size_t buffer_pos = f.tellg();
+
+            switch (static_cast<MeshResourceType>(chunk_type)) {
+            case MeshResourceType::NAME: { // 'NAME'
+                if (!readString(f, current_name)) {
+                    std::cerr << "Failed to read 'NAME' string." << std::endl;
+                    return false;
+                }
+                break;
+            }
+            case MeshResourceType::PATH: { // 'PATH'
+                if (!readString(f, current_path)) {
+                    std::cerr << "Failed to read 'PATH' string." << std::endl;
+                    return false;
                 }
-                // Emplace the object directly in the vector
-                chunks.emplace_back(std::move(chunk));
+                break;
+            }
+            case MeshResourceType::BODY: { // 'BODY'
+                resEntry_t entry;
+                entry.filename = current_name;
+                entry.filepath = current_path;
+                entry.buffer_size = buffer_size;
+                entry.unk1 = align;
+                entry.chunk_size = chunk_size;
+                entry.offset = buffer_pos;
+                nameIndex.emplace(entry.filename, entries.size());
+                entries.push_back(entry);
+                current_name.clear();
+                current_path.clear();
+                break;
+            }
+            default: {
+                std::cerr << "Unexpected Type {" << intToFourCC(chunk_type) << "} at position " << buffer_pos << std::endl;
+                return false;
             }
+            }
+
+            if (align == 0) {
+                std::cerr << "Invalid chunk alignment at position: " << buffer_pos << "\n";
+                return false;
+            }
+            f.seekg(buffer_pos + buffer_size + ((align - (buffer_size % align)) % align));
+        }
+
+        decoded.resize(entries.size());
+        return f.good();
+    }
+
+    // Opens the archive and decodes every BODY up front
+    bool read(const std::string& filePath, threadPool_t* pool = nullptr) {
+        if (!open(filePath)) {
+            return false;
+        }
+        return decodeAll(pool);
+    }
+
+    bool decodeAll(threadPool_t* pool = nullptr) {
+        std::vector<size_t> indices(entries.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            indices[i] = i;
+        }
+        return decode(indices, pool);
+    }
+
+    // Decodes the given entries, spreading them across pool when one is supplied.
+    // Results land in their archive slot, so order does not depend on scheduling.
+    bool decode(std::vector<size_t> indices, threadPool_t* pool = nullptr) {
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        indices.erase(std::remove_if(indices.begin(), indices.end(), [this](size_t i) {
+            return i >= entries.size() || decoded[i];
+        }), indices.end());
+
+        std::vector<char> ok(indices.size(), 0);
+        auto decodeOne = [this, &indices, &ok](size_t n) {
+            ok[n] = decodeEntry(indices[n]) ? 1 : 0;
+        };
+        if (pool != nullptr && indices.size() > 1) {
+            pool->parallelFor(indices.size(), decodeOne);
         } else {
-            std::cout << "Unknown Asset In Container {" << res_type << "}" << std::endl;
+            for (size_t n = 0; n < indices.size(); ++n) {
+                decodeOne(n);
+            }
+        }
+
+        bool result = true;
+        for (size_t n = 0; n < indices.size(); ++n) {
+            if (!ok[n]) {
+                std::cerr << "Failed to read resChunk_t: " << entries[indices[n]].filename << "\n";
+                result = false;
+            }
+        }
+        return result;
+    }
+
+    size_t size() const { return entries.size(); }
+    const resEntry_t& entry(size_t index) const { return entries[index]; }
+
+    // Undecoded BODY payload, e.g. for mefStreamParser_t; ends with the BODY so a
+    // bad size inside it cannot reach the entries that follow
+    byteStream_t body(size_t index) const {
+        return byteStream_t(bodyData(index), bodySize(index));
+    }
+
+    // Raw BODY bytes, e.g. for hashing
+    const uint8_t* bodyData(size_t index) const {
+        return file.data() + entries[index].offset;
+    }
+
+    // BODY length, clamped to the mapped file
+    size_t bodySize(size_t index) const {
+        const resEntry_t& e = entries[index];
+        return std::min(static_cast<size_t>(e.buffer_size), file.size() - e.offset);
+    }
+
+    // Index of the entry with the given NAME, or -1 when absent
+    int find(const std::string& name) const {
+        auto it = nameIndex.find(name);
+        return it != nameIndex.end() ? static_cast<int>(it->second) : -1;
+    }
+
+    // Decodes the BODY on first access and caches it; nullptr on failure
+    resChunk_t* get(size_t index) {
+        if (index >= entries.size()) {
+            return nullptr;
+        }
+        if (!decoded[index] && !decodeEntry(index)) {
+            return nullptr;
         }
+        return decoded[index].get();
+    }
+
+    resChunk_t* get(const std::string& name) {
+        int index = find(name);
+        return index >= 0 ? get(static_cast<size_t>(index)) : nullptr;
+    }
 
-        f.close();
+private:
+    // Decodes one BODY into its slot; touches nothing shared, so distinct
+    // indices may be decoded concurrently
+    bool decodeEntry(size_t index) {
+        const resEntry_t& e = entries[index];
+        std::unique_ptr<resChunk_t> chunk(new resChunk_t());
+        chunk->chunk_type = static_cast<uint32_t>(MeshResourceType::BODY);
+        chunk->buffer_size = e.buffer_size;
+        chunk->unk1 = e.unk1;
+        chunk->chunk_size = e.chunk_size;
+        chunk->filename = e.filename;
+        chunk->filepath = e.filepath;
+
+        // Each BODY gets its own cursor starting at its payload
+        byteStream_t f = body(index);
+        if (!chunk->readBody(f, false, buildMips)) {
+            return false;
+        }
+        decoded[index] = std::move(chunk);
         return true;
     }
+
+    mappedFile_t file;
+    std::vector<resEntry_t> entries;
+    std::vector<std::unique_ptr<resChunk_t>> decoded;
+    std::unordered_map<std::string, size_t> nameIndex;
 };
 
 
@@ -4459,7 +4582,7 @@ struct mtpInstanceTableEntry_t {
     uint32_t count;
     std::vector<uint32_t> indices;
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Read index (unsigned, little endian)
         readValue(f, index);
 
@@ -4483,7 +4606,7 @@ struct mtpInstanceTableEntry_t {
 struct mtpInstanceTable_t {
     std::vector<mtpInstanceTableEntry_t> instances;
 
-    bool read(std::ifstream &f, std::streampos endpos) {
+    bool read(byteStream_t &f, size_t endpos) {
         instances.clear();
         while (f.tellg() < endpos && f.good()) {
             mtpInstanceTableEntry_t entry;
@@ -4494,13 +4617,28 @@ struct mtpInstanceTable_t {
         }
         return f.good();
     }
-};
 
-struct mtpIndexTableEntry_t {
-    uint32_t index;
+    std::string to_string() const {
+        std::ostringstream oss;
+        size_t inst_pos = 0;
+        for (size_t i = 0; i < instances.size(); ++i) {
+            oss << "\t" << i << ": \t" << instances[i].index << " ({";
+            for (size_t j = 0; j < instances[i].indices.size(); ++j) {
+                oss << instances[i].indices[j];
+                if (j != instances[i].indices.size() - 1) oss << ", ";
+            }
+            oss << "}) pos:" << inst_pos << "\n";
+            inst_pos += ((instances[i].indices.size() + 1) * 4);
+        }
+        return oss.str();
+    }
+};
+
+struct mtpIndexTableEntry_t {
+    uint32_t index;
     int32_t flag;
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Read index (unsigned, little endian)
         readValue(f, index);
 
@@ -4515,7 +4653,7 @@ struct mtpIndexTable_t {
     uint32_t count;
     std::vector<mtpIndexTableEntry_t> indices;
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Read count (unsigned, little endian)
         readValue(f, count);
 
@@ -4533,6 +4671,14 @@ struct mtpIndexTable_t {
         }
         return f.good();
     }
+
+    std::string to_string() const {
+        std::ostringstream oss;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            oss << "\t" << i << ": \t(" << indices[i].flag << ") " << indices[i].index << "\n";
+        }
+        return oss.str();
+    }
 };
 
 struct mtpIntegerTable_t {
@@ -4540,7 +4686,7 @@ struct mtpIntegerTable_t {
     std::vector<uint32_t> values;
     std::vector<std::string> names;
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Read count (unsigned, little endian)
         readValue(f, count);
 
@@ -4569,13 +4715,21 @@ struct mtpIntegerTable_t {
         }
         return f.good();
     }
+
+    std::string to_string() const {
+        std::ostringstream oss;
+        for (size_t i = 0; i < names.size(); ++i) {
+            oss << "\t" << i << ": \t(" << values[i] << ") \"" << names[i] << "\"\n";
+        }
+        return oss.str();
+    }
 };
 
 struct mtpStringTable_t {
     uint32_t count;
     std::vector<std::string> names;
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Read count (unsigned, little endian)
         readValue(f, count);
 
@@ -4592,6 +4746,14 @@ struct mtpStringTable_t {
         }
         return f.good();
     }
+
+    std::string to_string() const {
+        std::ostringstream oss;
+        for (size_t i = 0; i < names.size(); ++i) {
+            oss << "\t" << i << ": \t\"" << names[i] << "\"\n";
+        }
+        return oss.str();
+    }
 };
 
 struct mtpChunk_t {
@@ -4601,9 +4763,9 @@ struct mtpChunk_t {
     void* res;              // Can be specific type based on 'type'
 
 
-    bool read(std::ifstream &f) {
+    bool read(byteStream_t &f) {
         // Remember the current position to calculate end_pos
-        std::streampos pos = f.tellg();
+        size_t pos = f.tellg();
 
         // Read type (big endian)
         if (!readValueBE<uint32_t>(f, type)) {
@@ -4622,7 +4784,7 @@ struct mtpChunk_t {
 
 
         // calculate end position
-        std::streampos end_pos = pos + static_cast<std::streamoff>(size) + 8; // Adjust as per padding
+        size_t end_pos = pos + static_cast<size_t>(size) + 8; // Adjust as per padding
 
         // Process based on chunk type
 
@@ -4671,10 +4833,7 @@ struct mtpChunk_t {
                 res = static_cast<void*>(table);
 
                 // Debugging output
-                std::cout << "MODELS:\n";
-                for (size_t i = 0; i < table->names.size(); ++i) {
-                    std::cout << "\t" << (i) << ": \t\"" << table->names[i] << "\"\n";
-                }
+                LOG_DEBUG(logCategory_t::Mtp, "MODELS:\n" << table->to_string());
                 break;
             }
 
@@ -4687,10 +4846,7 @@ struct mtpChunk_t {
                 res = static_cast<void*>(intTable);
 
                 // Debugging output
-                std::cout << "V NAME?:\n";
-                for (size_t i = 0; i < intTable->names.size(); ++i) {
-                    std::cout << "\t" << (i) << ": \t(" << intTable->values[i] << ") \"" << intTable->names[i] << "\"\n";
-                }
+                LOG_DEBUG(logCategory_t::Mtp, "V NAME?:\n" << intTable->to_string());
                 break;
             }
 
@@ -4700,18 +4856,7 @@ struct mtpChunk_t {
                 res = static_cast<void*>(instTable);
 
                 // Debugging output
-                std::cout << "INSTANCES:\n";
-                size_t inst_pos = 0;
-                for (size_t i = 0; i < instTable->instances.size(); ++i) {
-                    std::cout << "\t" << i << ": \t" << instTable->instances[i].index << " ("
-                              << "{";
-                    for (size_t j = 0; j < instTable->instances[i].indices.size(); ++j) {
-                        std::cout << instTable->instances[i].indices[j];
-                        if (j != instTable->instances[i].indices.size() - 1) std::cout << ", ";
-                    }
-                    std::cout << "}) pos:" << inst_pos << "\n";
-                    inst_pos += ((instTable->instances[i].indices.size() + 1) * 4);
-                }
+                LOG_DEBUG(logCategory_t::Mtp, "INSTANCES:\n" << instTable->to_string());
                 break;
             }
 
@@ -4724,10 +4869,7 @@ struct mtpChunk_t {
                 res = static_cast<void*>(table);
 
                 // Debugging output
-                std::cout << "TEXTURES:\n";
-                for (size_t i = 0; i < table->names.size(); ++i) {
-                    std::cout << "\t" << (i) << ": \t\"" << table->names[i] << "\"\n";
-                }
+                LOG_DEBUG(logCategory_t::Mtp, "TEXTURES:\n" << table->to_string());
                 break;
             }
 
@@ -4747,19 +4889,15 @@ struct mtpChunk_t {
                 res = static_cast<void*>(indexTable);
 
                 // Debugging output
-                std::cout << "GPU TEXTURES?:\n";
-                for (size_t i = 0; i < indexTable->indices.size(); ++i) {
-                    std::cout << "\t" << i << ": \t(" << indexTable->indices[i].flag
-                              << ") " << indexTable->indices[i].index << "\n";
-                }
+                LOG_DEBUG(logCategory_t::Mtp, "GPU TEXTURES?:\n" << indexTable->to_string());
                 break;
             }
 
             default: { // Handle unexpected types
                 std::string typeStr = intToFourCC(type, true);
-                std::cout << "New Chunk Type {" << typeStr << "} at position " << f.tellg() << "\n";
+                LOG_WARN(logCategory_t::Mtp, "New Chunk Type {" << typeStr << "} at position " << f.tellg());
                 // Optionally, skip the unknown chunk
-                f.seekg(pos + static_cast<std::streamoff>(size) + 8, std::ios::beg);
+                f.seekg(pos + static_cast<size_t>(size) + 8);
                 res = nullptr;
                 return false;
             }
@@ -4768,7 +4906,7 @@ struct mtpChunk_t {
             // Move to the end of the chunk (considering padding to 4-byte alignment)
             //std::streamoff padding = (4 - (size % 4)) % 4;
             //f.seekg(pos + static_cast<std::streamoff>(size) + padding, std::ios::beg);
-            f.seekg(end_pos, std::ios::beg);
+            f.seekg(end_pos);
         }
         return f.good();
     }
@@ -4781,8 +4919,8 @@ struct mtpFile_t {
     uint32_t type;
     std::vector<mtpChunk_t> res;
 
-    bool read(std::ifstream &f) {
-        std::cout << "Starting MTP at " << f.tellg() << std::endl;
+    bool read(byteStream_t &f) {
+        LOG_DEBUG(logCategory_t::Mtp, "Starting MTP at " << f.tellg());
 
         if (!data.read(f)) {
             std::cerr << "Failed to read main mtpChunk_t.\n";
@@ -4791,7 +4929,7 @@ struct mtpFile_t {
 
         // Check if the top-level chunk is 'FORM'
         if (data.type != static_cast<uint32_t>(MeshResourceType::FORM)) { // 'FORM'
-            std::cout << "stopped at " << f.tellg() << std::endl;
+            LOG_DEBUG(logCategory_t::Mtp, "stopped at " << f.tellg());
             std::cerr << "Unexpected File Format\n";
             return false;
         }
@@ -4799,14 +4937,14 @@ struct mtpFile_t {
         // Now, check the FormType
 
         uint32_t formType;
-        std::cout << "Starting formType at " << f.tellg() << std::endl;
+        LOG_DEBUG(logCategory_t::Mtp, "Starting formType at " << f.tellg());
         if (!readValueBE<uint32_t>(f, formType)) {
             std::cerr << "Failed to read FormType within 'FORM' chunk." << std::endl;
             return false;
         }
 
         std::string formTypeStr = intToFourCC(formType, true);
-        std::cout << "FormType: " << formTypeStr << std::endl;
+        LOG_DEBUG(logCategory_t::Mtp, "FormType: " << formTypeStr);
 
         if (formType != static_cast<uint32_t>(MeshResourceType::MTP_)) { // 'MPT '
             std::cerr << "Unexpected FORM Type {" << intToFourCC(formType, true) << "}\n";
@@ -4814,7 +4952,7 @@ struct mtpFile_t {
         }
 
         // Read chunks until the end of the 'FORM' chunk
-        std::streampos end_pos = f.tellg() + static_cast<std::streamoff>(data.size) - 4; // Subtract 4 bytes for FormType already read
+        size_t end_pos = f.tellg() + static_cast<size_t>(data.size) - 4; // Subtract 4 bytes for FormType already read
 
         while (f.tellg() < end_pos && f.good()) {
             mtpChunk_t chunk;
@@ -4823,7 +4961,7 @@ struct mtpFile_t {
                 return false;
             }
             res.push_back(chunk);
-            std::cout << "-----------------------------------------------------\n";
+            LOG_DEBUG(logCategory_t::Mtp, "-----------------------------------------------------");
         }
 
         return f.good();
@@ -4857,6 +4995,7 @@ struct mtpFile_t {
 
 
 
+#ifndef MEFVIEW_HEADLESS
 void assign_parent_indices(size_t bone_index,
     const std::vector<std::vector<size_t>>& bone_children,
     std::vector<int>& parent_indices) {
@@ -4867,9 +5006,7 @@ void assign_parent_indices(size_t bone_index,
 }
 
 void swapBGRtoRGB(unsigned char* data, size_t size) {
-    for (size_t i = 0; i < size; i += 4) { // Assuming 4 bytes per pixel (RGBA)
-        std::swap(data[i], data[i + 2]); // Swap B and R
-    }
+    pixelSwapRB32(data, size / 4); // Assuming 4 bytes per pixel (RGBA)
 }
 
 class ImageBox : public Fl_Box {
@@ -4985,9 +5122,10 @@ private:
 
     struct TextureEntry {
         std::string name;
-        tgaFile_t tga;
+        size_t index;   // Entry in resFile, decoded when first displayed
     };
 
+    resFile_t resFile;
     std::vector<TextureEntry> textures;
 
     // Callback functions
@@ -5146,25 +5284,22 @@ private:
         textures.clear();
         textureList->clear();
 
-        resFile_t resFile;
-        if (!resFile.read(filename)) {
+        if (!resFile.open(filename)) {
             fl_alert("Failed to parse RES file: %s", filename.c_str());
             return;
         }
 
-        for (size_t i = 0; i < resFile.chunks.size(); ++i) {
-            const resChunk_t& chunk = resFile.chunks[i];
-            if (chunk.chunk_type != 0x59444F42) { // 'BODY'
-                continue; // Only process 'BODY' chunks
-            }
-
-            if (chunk.texture.image_data.empty()) {
-                continue; // Skip if texture data is empty
+        // Only the table of contents is read here; textures decode on selection
+        for (size_t i = 0; i < resFile.size(); ++i) {
+            const resEntry_t& res = resFile.entry(i);
+            std::string file_type = getFilename::Type(res.filename);
+            if (!matchPattern(file_type, ".tex") && !matchPattern(file_type, ".tga")) {
+                continue; // Skip anything that is not a texture
             }
 
             TextureEntry entry;
-            entry.name = getFilename::File(chunk.filename.empty() ? "Texture " + std::to_string(i + 1) : chunk.filename);
-            entry.tga = chunk.texture;
+            entry.name = getFilename::File(res.filename.empty() ? "Texture " + std::to_string(i + 1) : res.filename);
+            entry.index = i;
             textures.push_back(entry);
         }
 
@@ -5199,19 +5334,25 @@ private:
         imageBox->redraw();
 
         TextureEntry& entry = textures[index];
+        const resChunk_t* chunk = resFile.get(entry.index);
+        if (chunk == nullptr || !chunk->texture || chunk->texture->image_data.empty()) {
+            fl_alert("Failed to decode texture: %s", entry.name.c_str());
+            return;
+        }
+        const tgaFile_t& tga = *chunk->texture;
 
-        int width = entry.tga.width;
-        int height = entry.tga.height;
+        int width = tga.width;
+        int height = tga.height;
         int depth = 4; // Assuming RGBA data
 
         // Ensure that image_data size matches width * height * depth
-        if (entry.tga.image_data.size() != static_cast<size_t>(width * height * depth)) {
+        if (tga.image_data.size() != static_cast<size_t>(width * height * depth)) {
             fl_alert("Texture data size mismatch for texture: %s", entry.name.c_str());
             return;
         }
 
         // Create FLTK image from texture data
-        Fl_RGB_Image* textureImage = new Fl_RGB_Image(entry.tga.image_data.data(), width, height, depth);
+        Fl_RGB_Image* textureImage = new Fl_RGB_Image(tga.image_data.data(), width, height, depth);
         textureImage->alloc_array = 0; // FLTK does not manage the data
 
         // Create checkerboard background
@@ -5267,7 +5408,7 @@ private:
         imageBox->redraw(); // Make sure to redraw the imageBox to display the new image
 
         // Set the infoBox label with the metadata
-        std::string info = "Name: " + entry.name + "\nWidth: " + std::to_string(width) + "\nHeight: " + std::to_string(height) + "\nPixel Depth: " + std::to_string(entry.tga.pixel_depth) + " bits\nImage Type: " + (entry.tga.image_type == 2 ? "Uncompressed True-Color" : "Other");
+        std::string info = "Name: " + entry.name + "\nWidth: " + std::to_string(width) + "\nHeight: " + std::to_string(height) + "\nPixel Depth: " + std::to_string(tga.pixel_depth) + " bits\nImage Type: " + (tga.image_type == 2 ? "Uncompressed True-Color" : "Other");
         infoBox->copy_label(info.c_str());
 
         // Force the whole window to redraw
@@ -5311,7 +5452,8 @@ private:
                     filename += ".tga"; // Append .tga if no extension or wrong extension
                 }
 
-                if (textures[index].tga.save(filename.c_str())) {
+                resChunk_t* chunk = resFile.get(textures[index].index);
+                if (chunk != nullptr && chunk->texture && chunk->texture->save(filename.c_str())) {
                     fl_message("Saved texture as %s", filename.c_str());
                 } else {
                     fl_alert("Failed to save texture as %s", filename.c_str());
@@ -5390,29 +5532,36 @@ private:
 
 
 
-bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
-    // Clear existing meshes
-    glWindow->meshes.clear();
-
-    // Extract mesh data directly from mefFile
+// CPU-side mesh arrays; building them does not touch GL, so it can run on a loader thread
+struct meshGeometry_t {
     std::vector<glm::vec3> vertices;
     std::vector<glm::vec3> normals;
     std::vector<glm::vec2> tverts; // Texture coordinates
     std::vector<glm::ivec3> faces;
     std::vector<int> materialIDs;  // Material IDs for each face
-    std::vector<Materialm> materials;  // Materials
+    std::vector<std::string> materialTextures;  // Texture bound to each material, "" for none
+};
+
+// Geometry of a stand-alone MEF: one untextured material per sub-mesh
+bool buildMeshFromMEF(const mefFile_t& mefFile, meshGeometry_t& geometry) {
+    // Extract mesh data directly from mefFile
+    std::vector<glm::vec3>& vertices = geometry.vertices;
+    std::vector<glm::vec3>& normals = geometry.normals;
+    std::vector<glm::vec2>& tverts = geometry.tverts;
+    std::vector<glm::ivec3>& faces = geometry.faces;
+    std::vector<int>& materialIDs = geometry.materialIDs;
 
     float mscale = 0.0003934f; // Scaling factor if needed
 
     // Retrieve necessary chunks
-    const mefMeshChunk_t* hier_chunk = mefFile.get_content("HIER");
-    const mefMeshChunk_t* bnam_chunk = mefFile.get_content("BNAM");
-    const mefMeshChunk_t* vrtx_chunk = mefFile.get_content("VRTX");
-    const mefMeshChunk_t* face_chunk = mefFile.get_content("FACE");
-    const mefMeshChunk_t* rend_chunk = mefFile.get_content("REND");
+    const mefMeshHier_t* hier = mefFile.get<mefMeshHier_t>();
+    const mefMeshBNam_t* bnam = mefFile.get<mefMeshBNam_t>();
+    const mefMeshVrtx_t* vrtx = mefFile.get<mefMeshVrtx_t>();
+    const mefMeshFace_t* face = mefFile.get<mefMeshFace_t>();
+    const mefMeshRend_t* rend = mefFile.get<mefMeshRend_t>();
 
     // Check for required chunks
-    if (!vrtx_chunk || !face_chunk || !rend_chunk) {
+    if (!vrtx || !face || !rend) {
         std::cerr << "Required chunks are missing." << std::endl;
         return false;
     }
@@ -5422,11 +5571,8 @@ bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
     std::vector<std::array<float, 3>> bone_positions;
     std::vector<int> parent_indices;
 
-    if (hier_chunk && bnam_chunk) {
-        mefMeshHier_t* hier = dynamic_cast<mefMeshHier_t*>(hier_chunk->res);
-        mefMeshBNam_t* bnam = dynamic_cast<mefMeshBNam_t*>(bnam_chunk->res);
-
-        if (hier && bnam && hier->num_children.size() == bnam->names.size()) {
+    if (hier && bnam) {
+        if (hier->num_children.size() == bnam->names.size()) {
             size_t num_bones = hier->num_children.size();
             bone_names = bnam->names;
             bone_positions.resize(num_bones);
@@ -5479,17 +5625,6 @@ bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
         std::cout << "Bone hierarchy not available. Using mesh without bone transformations." << std::endl;
     }
 
-    // Cast to appropriate types
-    const mefMeshVrtx_t* vrtx = dynamic_cast<const mefMeshVrtx_t*>(vrtx_chunk->res);
-    const mefMeshFace_t* face = dynamic_cast<const mefMeshFace_t*>(face_chunk->res);
-    const mefMeshRend_t* rend = dynamic_cast<const mefMeshRend_t*>(rend_chunk->res);
-
-
-    if (!vrtx || !face || !rend) {
-        std::cerr << "Failed to cast resource chunks." << std::endl;
-        return false;
-    }
-
     // Process each sub-mesh in REND
     const auto& submeshes = rend->entry;
     size_t globalVertexOffset = 0; // To keep track of vertex indices across sub-meshes
@@ -5505,10 +5640,7 @@ bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
 
         // **Assign a unique material ID for this sub-mesh**
         int materialID = currentMaterialID++;
-        Materialm newMaterial;
-        newMaterial.applyRandomColors(); // Assign random colors since we may not have textures
-
-        materials.push_back(newMaterial);
+        geometry.materialTextures.push_back(std::string()); // Random colors since we may not have textures
 
         // **Process vertices for this sub-mesh**
         for (size_t i = vertPos; i < vertPos + vertCount; ++i) {
@@ -5564,11 +5696,30 @@ bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
         globalVertexOffset += vertCount;
     }
 
+    return true;
+}
+
+bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
+    tracePhase_t phase("load_mesh");
+
+    // Clear existing meshes
+    glWindow->meshes.clear();
+
+    meshGeometry_t geometry;
+    if (!buildMeshFromMEF(mefFile, geometry)) {
+        return false;
+    }
+
+    std::vector<Materialm> materials(geometry.materialTextures.size());
+    for (auto& material : materials) {
+        material.applyRandomColors(); // Assign random colors since we may not have textures
+    }
+
     // Make the OpenGL context current before adding the mesh
 	glWindow->make_current();
 
 	// Add the mesh to the viewer
-	glWindow->addMesh(vertices, faces, materialIDs, tverts, materials, normals);
+	glWindow->addMesh(geometry.vertices, geometry.faces, geometry.materialIDs, geometry.tverts, materials, geometry.normals);
 
     //Mesh newMesh(vertices, faces, materialIDs, tverts, materials, normals);
     //glWindow->meshes.push_back(newMesh);
@@ -5582,29 +5733,28 @@ bool loadMeshFromMEF(const mefFile_t& mefFile, MyGlWindow* glWindow) {
     return true;
 }
 
-bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow, const std::vector<std::string>& textureNames, const std::unordered_map<int, std::vector<int>>& modelToTextureIndices, const std::unordered_map<std::string, tgaFile_t>& textureMap, int modelIndex ) {
-    // Clear existing meshes
-    glWindow->clearMeshes();
+// Geometry of a level model; sub-mesh n uses material n, one per texture in materialTextures
+bool buildMeshFromMEFWithMaterial(const mefFile_t& mefFile, const std::vector<std::string>& materialTextures, meshGeometry_t& geometry) {
+    tracePhase_t phase("build_mesh");
 
     // Extract mesh data directly from mefFile
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec3> normals;
-    std::vector<glm::vec2> tverts; // Texture coordinates
-    std::vector<glm::ivec3> faces;
-    std::vector<int> materialIDs;  // Material IDs for each face
-    std::vector<Materialm> materials;  // Materials
+    std::vector<glm::vec3>& vertices = geometry.vertices;
+    std::vector<glm::vec3>& normals = geometry.normals;
+    std::vector<glm::vec2>& tverts = geometry.tverts;
+    std::vector<glm::ivec3>& faces = geometry.faces;
+    std::vector<int>& materialIDs = geometry.materialIDs;
 
     float mscale = 0.0003934f; // Scaling factor if needed
 
     // Retrieve necessary chunks
-    const mefMeshChunk_t* hier_chunk = mefFile.get_content("HIER");
-    const mefMeshChunk_t* bnam_chunk = mefFile.get_content("BNAM");
-    const mefMeshChunk_t* vrtx_chunk = mefFile.get_content("VRTX");
-    const mefMeshChunk_t* face_chunk = mefFile.get_content("FACE");
-    const mefMeshChunk_t* rend_chunk = mefFile.get_content("REND");
+    const mefMeshHier_t* hier = mefFile.get<mefMeshHier_t>();
+    const mefMeshBNam_t* bnam = mefFile.get<mefMeshBNam_t>();
+    const mefMeshVrtx_t* vrtx = mefFile.get<mefMeshVrtx_t>();
+    const mefMeshFace_t* face = mefFile.get<mefMeshFace_t>();
+    const mefMeshRend_t* rend = mefFile.get<mefMeshRend_t>();
 
     // Check for required chunks
-    if (!vrtx_chunk || !face_chunk || !rend_chunk) {
+    if (!vrtx || !face || !rend) {
         std::cerr << "Required chunks are missing." << std::endl;
         return false;
     }
@@ -5614,11 +5764,8 @@ bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow
     std::vector<std::array<float, 3>> bone_positions;
     std::vector<int> parent_indices;
 
-    if (hier_chunk && bnam_chunk) {
-        mefMeshHier_t* hier = dynamic_cast<mefMeshHier_t*>(hier_chunk->res);
-        mefMeshBNam_t* bnam = dynamic_cast<mefMeshBNam_t*>(bnam_chunk->res);
-
-        if (hier && bnam && hier->num_children.size() == bnam->names.size()) {
+    if (hier && bnam) {
+        if (hier->num_children.size() == bnam->names.size()) {
             size_t num_bones = hier->num_children.size();
             bone_names = bnam->names;
             bone_positions.resize(num_bones);
@@ -5669,71 +5816,12 @@ bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow
         std::cout << "Bone hierarchy not available. Using mesh without bone transformations." << std::endl;
     }
 
-    // Cast to appropriate types
-    const mefMeshVrtx_t* vrtx = dynamic_cast<const mefMeshVrtx_t*>(vrtx_chunk->res);
-    const mefMeshFace_t* face = dynamic_cast<const mefMeshFace_t*>(face_chunk->res);
-    const mefMeshRend_t* rend = dynamic_cast<const mefMeshRend_t*>(rend_chunk->res);
-
-    if (!vrtx || !face || !rend) {
-        std::cerr << "Failed to cast resource chunks." << std::endl;
-        return false;
-    }
-
-    // Retrieve texture indices for the current model
-    auto texIndicesIter = modelToTextureIndices.find(modelIndex);
-    std::vector<int> texIndices;
-    if (texIndicesIter != modelToTextureIndices.end()) {
-        texIndices = texIndicesIter->second;
-    }
-    else {
-        std::cerr << "No texture indices found for model index: " << modelIndex << std::endl;
-        // Optionally, continue without textures
-    }
-
-    // Load textures and create materials
-    // Assuming one material per texture
-    // Alternatively, if multiple textures per material, adjust accordingly
-    // For simplicity, assign one texture per material
-    for (int texIndex : texIndices) {
-        if (texIndex >= 0 && texIndex < static_cast<int>(textureNames.size())) {
-            std::string texName = textureNames[texIndex];
-            auto texIter = textureMap.find(texName);
-            if (texIter != textureMap.end()) {
-                Materialm material;
-                // Convert TGA data to OpenGL texture
-                const tgaFile_t& tga = texIter->second;
-
-                material.loadTextureFromMemory(
-                    tga.image_data.data(),
-                    tga.width,
-                    tga.height,
-                    4 // channels
-                );
-                materials.push_back(material);
-            }
-            else {
-                std::cerr << "Texture not found in textureMap: " << texName << std::endl;
-                // Optionally, use a default material
-                Materialm defaultMaterial;
-                defaultMaterial.applyRandomColors(); // Assign random colors if texture is missing
-                materials.push_back(defaultMaterial);
-            }
-        }
-        else {
-            std::cerr << "Texture index out of range: " << texIndex << std::endl;
-            // Optionally, use a default material
-            Materialm defaultMaterial;
-            defaultMaterial.applyRandomColors(); // Assign random colors if texture index is invalid
-            materials.push_back(defaultMaterial);
-        }
-    }
-
-    // If no textures were found or assigned, create a default material
-    if (materials.empty()) {
-        Materialm defaultMaterial;
-        defaultMaterial.applyRandomColors(); // Assign random colors
-        materials.push_back(defaultMaterial);
+    // If no textures were assigned, fall back to a single untextured material
+    geometry.materialTextures = materialTextures;
+    if (geometry.materialTextures.empty()) {
+        geometry.materialTextures.push_back(std::string());
     }
+    size_t materialCount = geometry.materialTextures.size();
 
     // Process each sub-mesh in REND
     const auto& submeshes = rend->entry;
@@ -5750,11 +5838,11 @@ bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow
         // **Assign a material based on the texture indices**
         // Assign a material ID per submesh, based on the texture indices
         int materialID = 0; // Default material
-        if (smeshIndex < static_cast<size_t>(materials.size())) {
+        if (smeshIndex < materialCount) {
             materialID = smeshIndex; // Each submesh has its own material
         }
-        else if (!materials.empty()) {
-            materialID = static_cast<int>(materials.size() - 1); // Use the last material
+        else if (materialCount > 0) {
+            materialID = static_cast<int>(materialCount - 1); // Use the last material
         }
         else {
             // Should not reach here, but ensure materialID is valid
@@ -5765,9 +5853,6 @@ bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow
         for (size_t i = vertPos; i < vertPos + vertCount; ++i) {
             if (i >= vrtx->entry.size()) {
                 std::cerr << "Vertex index out of range: " << i << std::endl;
-
-
-                glWindow->clearMeshes();
                 return false;
             }
             const auto& vertex_entry = vrtx->entry[i];
@@ -5818,27 +5903,79 @@ bool loadMeshFromMEFWithMaterial( const mefFile_t& mefFile, MyGlWindow* glWindow
         globalVertexOffset += vertCount;
     }
 
-    // Make the OpenGL context current before adding the mesh
-    glWindow->make_current();
+    return true;
+}
+
+// Interleaves geometry into the buffers Mesh uploads, the form stored in the geometry cache
+bool interleaveMeshGeometry(const meshGeometry_t& geometry, std::vector<geomCacheVertex_t>& interleaved, std::vector<std::vector<uint32_t>>& materialIndices) {
+    if (geometry.faces.empty() || geometry.normals.size() != geometry.vertices.size() || geometry.tverts.size() != geometry.vertices.size()) {
+        std::cerr << "Error: Mesh has no faces or mismatched vertex arrays." << std::endl;
+        return false;
+    }
+    for (const auto& face : geometry.faces) {
+        for (int index : { face.x, face.y, face.z }) {
+            if (index < 0 || static_cast<size_t>(index) >= geometry.vertices.size()) {
+                std::cerr << "Error: Face index out of range: " << index << std::endl;
+                return false;
+            }
+        }
+    }
 
-    // Add the mesh to the viewer, passing materials
-    glWindow->addMesh(vertices, faces, materialIDs, tverts, materials, normals);
+    geomInterleave(reinterpret_cast<const float*>(geometry.vertices.data()),
+                   reinterpret_cast<const float*>(geometry.normals.data()),
+                   nullptr,
+                   reinterpret_cast<const float*>(geometry.tverts.data()),
+                   reinterpret_cast<const int*>(geometry.faces.data()),
+                   geometry.faces.size(),
+                   geometry.materialIDs.data(),
+                   geometry.materialTextures.size(),
+                   interleaved,
+                   materialIndices);
+    return true;
+}
 
-    // Set up the meshes (create VAOs, VBOs, etc.)
-    glWindow->setupMeshes();
+// Shows render-ready geometry, mapped from the cache or just built; only textures and buffers are uploaded here
+bool loadMeshFromGeomCache(std::shared_ptr<const geomCacheEntry_t> cache, MyGlWindow* glWindow, const std::unordered_map<std::string, textureRef_t>& textureMap) {
+    tracePhase_t phase("upload_mesh");
 
-    // Optionally, zoom to extents
-    glWindow->zoomExtents();
+    glWindow->clearMeshes();
+    glWindow->make_current();
+
+    traceClock_t::time_point uploadBegin = traceClock_t::now();
+    std::vector<Materialm> materials;
+    for (size_t i = 0; i < cache->materialCount(); ++i) {
+        Materialm material;
+        auto texIter = cache->texture(i).empty() ? textureMap.end() : textureMap.find(cache->texture(i));
+        if (texIter != textureMap.end()) {
+            const tgaFile_t& tga = *texIter->second;
+            std::vector<const unsigned char*> mipLevels;
+            for (const auto& level : tga.mips) {
+                mipLevels.push_back(level.data());
+            }
+            material.loadTextureFromMemory(tga.image_data.data(), tga.width, tga.height, 4, mipLevels);
+        } else {
+            if (!cache->texture(i).empty()) {
+                std::cerr << "Texture not found in textureMap: " << cache->texture(i) << std::endl;
+            }
+            material.applyRandomColors();
+        }
+        materials.push_back(material);
+    }
+    traceRecordSince("upload_textures", uploadBegin);
 
+    if (!glWindow->addCachedMesh(cache, materials)) {
+        return false;
+    }
+    glWindow->zoomExtents();
     return true;
 }
 
 bool loadMEFFile(const char* fileName, MyGlWindow* glWindow) {
-    // Open the file in binary mode
-    std::ifstream file(fileName, std::ios::binary);
+    // Map the file into memory
+    mappedFile_t file;
 
     // Check if the file opened successfully
-    if (!file.is_open()) {
+    if (!file.open(fileName)) {
         std::cerr << "Failed to open input mesh file: " << fileName << std::endl;
         return false;
     }
@@ -5847,9 +5984,11 @@ bool loadMEFFile(const char* fileName, MyGlWindow* glWindow) {
     mefFile_t mefFile;
 
     // Read the file content
-    if (!mefFile.readData(file)) {
+    byteStream_t stream(file);
+    bool parsed = mefFile.readData(stream);
+    logFlush(std::cerr);
+    if (!parsed) {
         std::cerr << "Failed to read content from input file: " << fileName << std::endl;
-        file.close();
         return false;
     }
     file.close();
@@ -5865,285 +6004,748 @@ bool loadMEFFile(const char* fileName, MyGlWindow* glWindow) {
 
 
 
-bool loadMTP( const char* fileName, Fl_Browser* modelList, MyGlWindow* glWindow ) {
-    std::string basePath = getFilename::Path(fileName);   // Get the base path of the MTP file
-    std::string baseName = getFilename::File(fileName);   // Get the base name (without extension)
+// Render-ready model built on the loader thread; only the GL upload is left for the UI thread
+struct preparedModel_t {
+    int modelIndex = -1;
+    geomCacheEntry_t geometry;
+    std::vector<std::pair<std::string, textureRef_t>> textures;  // Decoded for this model, not yet in textureMap
+};
 
-    std::cout << "File: \t" << fileName << std::endl;
-    std::cout << "Base Path: \t" << basePath << std::endl;
-    std::cout << "Base Name: \t" << baseName << std::endl;
+// Supplies the models of an archive or level; every method runs on the loader thread
+struct modelSource_t {
+    virtual ~modelSource_t() {}
 
-    // Open the MTP file
-    std::ifstream mtpFileStream(fileName, std::ios::binary);
-    if (!mtpFileStream) {
-        std::cerr << "Error: Unable to open MTP file: " << fileName << std::endl;
-        return false;
-    }
+    // Indexes the archives and returns one list entry per model
+    virtual bool open(std::vector<std::string>& modelNames) = 0;
 
-    mtpFile_t mtp;
-    if (!mtp.read(mtpFileStream)) {
-        std::cerr << "Error: Failed to read MTP file: " << fileName << std::endl;
-        return false;
-    }
-    mtpFileStream.close();
+    // Parses the model and everything it needs into model
+    virtual bool build(int modelIndex, preparedModel_t& model) = 0;
 
-    // Declare and initialize modelToTextureIndices
-    std::unordered_map<int, std::vector<int>> modelToTextureIndices;
+    // Decodes ahead for models likely to be shown next; textures not yet sent go into textures
+    virtual void prefetch(const std::vector<int>& modelIndices, std::vector<std::pair<std::string, textureRef_t>>& textures) = 0;
+};
 
-    // Parse the INST chunk to populate modelToTextureIndices
-    const mtpInstanceTable_t* instTable = nullptr;
-    for (const auto& chunk : mtp.res) {
-        if (chunk.type_debug == "INST") {
-            instTable = static_cast<mtpInstanceTable_t*>(chunk.res);
-            break;
+/**
+ * Loads models on a background thread so the window stays responsive.
+ * The loader thread opens the source, then builds whichever model was
+ * requested last; progress, list entries and finished models are posted to
+ * the UI thread with Fl::awake, where only the textures and buffers are
+ * uploaded. Models not yet started when a newer one is requested are skipped.
+ * While no request is waiting the remaining models are decoded in small
+ * batches, nearest to the selection first (set MEFVIEW_PREFETCH=0 to disable).
+ */
+class modelLoader_t {
+public:
+    modelLoader_t(MyGlWindow* glWindow, Fl_Browser* modelList) : glWindow(glWindow), modelList(modelList), focus(0), prefetchRemaining(0), pending(0), stopping(false), failure(false), shownFirst(false), onFirstFrame(nullptr) {
+        // Enables Fl::awake; called once on the UI thread before Fl::run
+        Fl::lock();
+        const char* prefetchSetting = std::getenv("MEFVIEW_PREFETCH");
+        prefetchEnabled = prefetchSetting == nullptr || std::string(prefetchSetting) != "0";
+        if (glWindow->top_window() != nullptr && glWindow->top_window()->label() != nullptr) {
+            title = glWindow->top_window()->label();
         }
     }
 
-    if (instTable) {
-        for (const auto& instance : instTable->instances) {
-            int modelIndex = instance.index; // Index into MODS (model names)
-
-            // Convert vector<unsigned int> to vector<int> and store in modelToTextureIndices
-            std::vector<int> textureIndices(instance.indices.begin(), instance.indices.end());
-            modelToTextureIndices[modelIndex] = textureIndices; // Texture indices from TEXF
+    // Must run after Fl::run has returned, so no posted message is still in flight
+    ~modelLoader_t() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) {
+            worker.join();
         }
-    } else {
-        std::cerr << "INST chunk not found in MTP file." << std::endl;
-        return false;
     }
 
+    modelLoader_t(const modelLoader_t&) = delete;
+    modelLoader_t& operator=(const modelLoader_t&) = delete;
 
-    // Extract model and texture names from MTP data
-    std::vector<std::string> modelNames;
-    std::vector<std::string> textureNames;
+    // Opens source on the loader thread; the first model is shown as soon as it is built
+    void start(std::unique_ptr<modelSource_t> modelSource) {
+        source = std::move(modelSource);
+        worker = std::thread(&modelLoader_t::run, this);
+    }
 
-    for (const auto& chunk : mtp.res) {
-        if (chunk.type_debug == "MODS") {
-            mtpStringTable_t* modTable = static_cast<mtpStringTable_t*>(chunk.res);
-            modelNames = modTable->names;
-        } else if (chunk.type_debug == "TEXF") {
-            mtpStringTable_t* texTable = static_cast<mtpStringTable_t*>(chunk.res);
-            textureNames = texTable->names;
+    // Shows modelIndex once it has been built
+    void request(int modelIndex) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = modelIndex;
         }
+        wake.notify_all();
     }
 
-    if (modelNames.empty()) {
-        std::cerr << "No models found in MTP file." << std::endl;
-        return false;
+    // traceArmFirstFrame(callback) is called once the first model has been uploaded
+    void armFirstFrame(void (*callback)()) {
+        onFirstFrame = callback;
     }
 
-    if (textureNames.empty()) {
-        std::cerr << "No textures found in MTP file." << std::endl;
-        return false;
+    // True when the source could not be opened
+    bool failed() const {
+        return failure;
     }
 
-    // Construct the path to the model and texture resource files
-    std::string modelResPath = basePath + "models/" + baseName + ".res";
-    std::string textureResPath = basePath + "textures/" + baseName + ".res";
+    // Browser callback: load the selected model
+    static void onSelect(Fl_Widget* widget, void* data) {
+        int selectedIndex = static_cast<Fl_Browser*>(widget)->value(); // 1-based index
+        if (selectedIndex > 0) {
+            static_cast<modelLoader_t*>(data)->request(selectedIndex - 1);
+        }
+    }
 
-    std::cout << "Model RES Path: \t" << modelResPath << std::endl;
-    std::cout << "Texture RES Path: \t" << textureResPath << std::endl;
+private:
+    enum class messageType_t { Names, Progress, Model, Textures, Failed };
 
-    if (!os::doesFileExist(modelResPath)) {
-        std::cerr << "Model RES file does not exist: " << modelResPath << std::endl;
-        return false;
-    }
+    struct message_t {
+        messageType_t type;
+        std::vector<std::string> names;
+        std::string text;
+        std::unique_ptr<preparedModel_t> model;
+    };
 
-    if (!os::doesFileExist(textureResPath)) {
-        std::cerr << "Texture RES file does not exist: " << textureResPath << std::endl;
-        return false;
+    static constexpr size_t NAME_BATCH = 256;
+
+    void post(message_t message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            mailbox.push_back(std::move(message));
+        }
+        Fl::awake(onAwake, this);
     }
 
-    // Read the model resource file
-    resFile_t modelResFile;
-    if (!modelResFile.read(modelResPath.c_str())) {
-        std::cerr << "Failed to read model RES file: " << modelResPath << std::endl;
-        return false;
+    void postProgress(const std::string& text) {
+        message_t message;
+        message.type = messageType_t::Progress;
+        message.text = text;
+        post(std::move(message));
     }
 
-    // Read the texture resource file
-    resFile_t textureResFile;
-    std::unordered_map<std::string, tgaFile_t> textureMap;
-    if (os::doesFileExist(textureResPath)) {
-        if (!textureResFile.read(textureResPath.c_str())) {
-            std::cerr << "Failed to read texture RES file: " << textureResPath << std::endl;
-            return false;
-        } else {
-            // Populate the textureMap
-            for (const auto& chunk : textureResFile.chunks) {
-                if (!chunk.texture.image_data.empty()) {
-                    std::string fullFilename = chunk.filename; // e.g., "LOCAL:textures/100_04_1_argb8888.tex"
-
-                    // Normalize the filename
-                    // Remove prefix "LOCAL:textures/" and suffix ".tex"
-                    std::string baseName = fullFilename;
-
-                    // Remove prefix if it exists
-//                    const std::string prefix = "LOCAL:textures/";
-//                    if (baseName.find(prefix) == 0) {
-//                        baseName = baseName.substr(prefix.length());
-//                    }
-//
-//                    // Remove suffix if it exists
-//                    const std::string suffix = ".tex";
-//                    if (baseName.size() >= suffix.size() && baseName.compare(baseName.size() - suffix.size(), suffix.size(), suffix) == 0) {
-//                        baseName = baseName.substr(0, baseName.size() - suffix.size());
-//                    }
-                    baseName = getFilename::File(baseName);
-                    // Now baseName should be "100_04_1_argb8888"
-
-                    // Insert into textureMap using normalized name
-                    textureMap[baseName] = chunk.texture;
+    // Loader thread
+    void run() {
+        postProgress("Loading...");
+
+        std::vector<std::string> names;
+        bool opened;
+        {
+            tracePhase_t phase("open_source");
+            opened = source->open(names);
+        }
+        logFlush(std::cerr);
+        if (!opened || names.empty()) {
+            message_t message;
+            message.type = messageType_t::Failed;
+            post(std::move(message));
+            return;
+        }
+
+        // Hand the list over in batches so a long level fills in while it is still arriving
+        for (size_t first = 0; first < names.size(); first += NAME_BATCH) {
+            message_t message;
+            message.type = messageType_t::Names;
+            size_t last = std::min(names.size(), first + NAME_BATCH);
+            message.names.assign(names.begin() + first, names.begin() + last);
+            post(std::move(message));
+        }
+
+        prefetched.assign(names.size(), 0);
+        prefetchRemaining = prefetchEnabled ? names.size() : 0;
+
+        for (;;) {
+            int modelIndex;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || pending >= 0 || prefetchRemaining > 0; });
+                if (stopping) {
+                    return;
+                }
+                modelIndex = pending;
+                pending = -1;
+            }
+            if (modelIndex < 0) {
+                prefetchNext();
+                continue;
+            }
+            if (modelIndex >= static_cast<int>(names.size())) {
+                continue;
+            }
+
+            // Prefetching continues outward from the model being looked at
+            focus = modelIndex;
+            if (prefetchEnabled && !prefetched[modelIndex]) {
+                prefetched[modelIndex] = 1;
+                prefetchRemaining--;
+            }
+
+            postProgress("Loading " + names[modelIndex] + "...");
+            std::unique_ptr<preparedModel_t> model(new preparedModel_t());
+            model->modelIndex = modelIndex;
+            bool built = source->build(modelIndex, *model);
+            logFlush(std::cerr);
+
+            message_t message;
+            if (built) {
+                message.type = messageType_t::Model;
+                message.model = std::move(model);
+            } else {
+                std::cerr << "Failed to load model: " << names[modelIndex] << std::endl;
+                // Textures decoded before the failure are not decoded again, later models still need them
+                if (!model->textures.empty()) {
+                    message_t textures;
+                    textures.type = messageType_t::Textures;
+                    textures.model = std::move(model);
+                    post(std::move(textures));
                 }
+                message.type = messageType_t::Progress;
+                message.text = "Failed to load " + names[modelIndex];
             }
+            post(std::move(message));
         }
     }
 
-    // Extract MEF models from the model resource file
-    std::vector<mefFile_t> mefModels;
-    int modelIndex = 0;
-    for (const auto& chunk : modelResFile.chunks) {
-        if (chunk.chunk_type != static_cast<uint32_t>(MeshResourceType::BODY)) { // 'BODY'
-            continue; // Only process 'BODY' chunks
+    // Loader thread: decodes the next few models nearest the focus, so choosing them later is quick
+    void prefetchNext() {
+        int count = static_cast<int>(prefetched.size());
+        size_t batchSize = std::max(2u, threadPool_t::shared().size());
+        std::vector<int> batch;
+        for (int distance = 0; batch.size() < batchSize && (focus - distance >= 0 || focus + distance < count); ++distance) {
+            for (int candidate : { focus + distance, focus - distance }) {
+                if (candidate >= 0 && candidate < count && !prefetched[candidate] && batch.size() < batchSize) {
+                    prefetched[candidate] = 1;
+                    prefetchRemaining--;
+                    batch.push_back(candidate);
+                }
+            }
         }
 
-        if (!chunk.model.content.empty()) {
-            mefModels.push_back(chunk.model);
-            ++modelIndex;
+        message_t message;
+        message.type = messageType_t::Textures;
+        message.model.reset(new preparedModel_t());
+        source->prefetch(batch, message.model->textures);
+        logFlush(std::cerr);
+        LOG_DEBUG(logCategory_t::General, "Prefetched " << batch.size() << " models, " << prefetchRemaining << " left");
+        if (!message.model->textures.empty()) {
+            post(std::move(message));
         }
     }
 
-    if (mefModels.empty()) {
-        std::cerr << "Failed to find any meshes in the model RES file." << std::endl;
-        return false;
+    // UI thread
+    static void onAwake(void* data) {
+        modelLoader_t* loader = static_cast<modelLoader_t*>(data);
+        std::deque<message_t> messages;
+        {
+            std::lock_guard<std::mutex> lock(loader->mutex);
+            messages.swap(loader->mailbox);
+        }
+        for (auto& message : messages) {
+            loader->handle(message);
+        }
     }
 
-    // Populate the list box with model names
-    modelIndex = 0;
-    for (const auto& mefModel : mefModels) {
-        std::string modelName;
-        if (modelIndex < static_cast<int>(modelNames.size())) {
-            modelName = modelNames[modelIndex];
-        } else {
-            modelName = "Model " + std::to_string(modelIndex + 1);
+    void handle(message_t& message) {
+        switch (message.type) {
+        case messageType_t::Names: {
+            bool wasEmpty = modelList->size() == 0;
+            for (const auto& name : message.names) {
+                modelList->add(name.c_str());
+            }
+            if (wasEmpty) {
+                modelList->select(1);
+            }
+            break;
+        }
+        case messageType_t::Progress:
+            setStatus(message.text);
+            break;
+        case messageType_t::Model: {
+            preparedModel_t& model = *message.model;
+            for (auto& texture : model.textures) {
+                textureMap.emplace(texture.first, std::move(texture.second));
+            }
+
+            // Skip models the selection has already moved past
+            if (modelList->value() != model.modelIndex + 1) {
+                break;
+            }
+            // The mesh keeps the entry, and with it any mapping, for as long as it is shown
+            std::shared_ptr<preparedModel_t> owner(std::move(message.model));
+            std::shared_ptr<const geomCacheEntry_t> geometry(owner, &model.geometry);
+            if (loadMeshFromGeomCache(geometry, glWindow, textureMap)) {
+                glWindow->redraw();
+                setStatus(std::string());
+                if (!shownFirst && onFirstFrame != nullptr) {
+                    traceArmFirstFrame(onFirstFrame);
+                }
+                shownFirst = true;
+            } else {
+                std::cerr << "Failed to upload model " << (model.modelIndex + 1) << std::endl;
+            }
+            break;
+        }
+        case messageType_t::Textures:
+            for (auto& texture : message.model->textures) {
+                textureMap.emplace(texture.first, std::move(texture.second));
+            }
+            break;
+        case messageType_t::Failed:
+            std::cerr << "Failed to load any model." << std::endl;
+            failure = true;
+            // Nothing to show; closing the windows ends Fl::run
+            while (Fl::first_window() != nullptr) {
+                Fl::first_window()->hide();
+            }
+            break;
         }
-        modelList->add(modelName.c_str());
-        ++modelIndex;
     }
 
-    // Show the window before loading models to ensure glWindow is ready
-    Fl::check();
+    void setStatus(const std::string& text) {
+        Fl_Window* window = glWindow->top_window();
+        if (window != nullptr) {
+            window->copy_label((text.empty() ? title : title + " - " + text).c_str());
+        }
+    }
 
-    // Select the first item in the list
-    modelList->select(1);
+    MyGlWindow* glWindow;
+    Fl_Browser* modelList;
+    std::string title;
+    std::unordered_map<std::string, textureRef_t> textureMap;  // UI thread only
 
-    // Clear existing meshes
-    glWindow->clearMeshes();
+    std::unique_ptr<modelSource_t> source;                  // Loader thread only
+    std::vector<char> prefetched;                           // Loader thread only
+    int focus;                                              // Last model built; prefetch starts here
+    size_t prefetchRemaining;
+    bool prefetchEnabled;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<message_t> mailbox;
+    int pending;                                            // Requested model, -1 when none
+    bool stopping;
 
-    // Load the first model by default with materials
-    if (!loadMeshFromMEFWithMaterial(
-            mefModels[0],
-            glWindow,
-            textureNames,
-            modelToTextureIndices,
-            textureMap,
-            0 // modelIndex for the first model
-        )) {
-        std::cerr << "Failed to load the first mesh with materials from MEF file." << std::endl;
-        return false;
-    }
+    bool failure;
+    bool shownFirst;
+    void (*onFirstFrame)();
+};
 
-    // Set up the callback for model selection
-    struct CallbackData {
-        std::vector<mefFile_t> models;
-        MyGlWindow* glWindow;
-        std::vector<std::string> textureNames;
-        std::unordered_map<int, std::vector<int>> modelToTextureIndices;
-        std::unordered_map<std::string, tgaFile_t> textureMap;
-    };
+// Models of a single RES archive, shown with random material colors
+struct resSource_t : modelSource_t {
+    explicit resSource_t(const std::string& fileName) : fileName(fileName) {}
 
-    // Initialize CallbackData
-    CallbackData* cbData = new CallbackData{
-        std::move(mefModels),
-        glWindow,
-        textureNames,
-        modelToTextureIndices,
-        textureMap
-    };
+    bool open(std::vector<std::string>& modelNames) override {
+        traceClock_t::time_point openBegin = traceClock_t::now();
+        bool opened = resFile.open(fileName);
+        traceRecordSince("open_res", openBegin);
+        if (!opened) {
+            std::cerr << "Failed to parse RES file: " << fileName << std::endl;
+            return false;
+        }
 
-    modelList->callback([](Fl_Widget* widget, void* data) {
-        Fl_Browser* browser = static_cast<Fl_Browser*>(widget);
-        CallbackData* cbData = static_cast<CallbackData*>(data);
-        int selectedIndex = browser->value(); // 1-based index
-
-        if (selectedIndex > 0 && selectedIndex <= static_cast<int>(cbData->models.size())) {
-            // Clear existing meshes
-            cbData->glWindow->clearMeshes();
-
-            // Load the selected mesh with materials
-            if (!loadMeshFromMEFWithMaterial(
-                    cbData->models[selectedIndex - 1],
-                    cbData->glWindow,
-                    cbData->textureNames,
-                    cbData->modelToTextureIndices,
-                    cbData->textureMap,
-                    selectedIndex - 1 // modelIndex
-                )) {
-                std::cerr << "Failed to load selected mesh with materials." << std::endl;
-            } else {
-                cbData->glWindow->redraw();
+        // List MEF models from the table of contents
+        for (size_t i = 0; i < resFile.size(); ++i) {
+            if (!matchPattern(getFilename::Type(resFile.entry(i).filename), ".mef")) {
+                continue; // Only list models
             }
-        }
-    }, cbData);
+            modelEntries.push_back(i);
 
-    return true;
-}
+            // Use model names if available; otherwise, use indices
+            modelNames.push_back("Model " + std::to_string(modelEntries.size()));
+        }
 
-bool checkFileSignature(ifstream &file, unsigned int expectedSignature, unsigned long offset = 0) {
-    // Move to the required offset
-    file.seekg(offset, ios::beg);
-    if (!file) {
-        cerr << "Error: Unable to seek to offset " << offset << "." << endl;
-        return false;
+        if (modelEntries.empty()) {
+            std::cerr << "Failed to find any meshes in the RES file." << std::endl;
+            return false;
+        }
+        return true;
     }
 
-    unsigned int fileSignature = 0;
-    file.read(reinterpret_cast<char*>(&fileSignature), sizeof(fileSignature));
-    if (!file) {
-        cerr << "Error: Unable to read signature from file." << endl;
-        return false;
-    }
+    bool build(int modelIndex, preparedModel_t& model) override {
+        traceClock_t::time_point decodeBegin = traceClock_t::now();
+        resChunk_t* chunk = resFile.get(modelEntries[modelIndex]);
+        traceRecordSince("decode_model", decodeBegin);
+        if (chunk == nullptr) {
+            return false;
+        }
 
-    return fileSignature == expectedSignature;
-}
+        meshGeometry_t geometry;
+        std::vector<geomCacheVertex_t> interleaved;
+        std::vector<std::vector<uint32_t>> materialIndices;
+        if (!buildMeshFromMEF(chunk->model, geometry) || !interleaveMeshGeometry(geometry, interleaved, materialIndices)) {
+            return false;
+        }
+        model.geometry.assign(std::move(interleaved), materialIndices, geometry.materialTextures);
+        return true;
+    }
 
-int determineFileType(const char* fileName) {
-    std::ifstream file(fileName, std::ios::binary);
-    if (!file) {
-        cerr << "Error: Unable to open file: " << fileName << endl;
-        return 1;
+    void prefetch(const std::vector<int>& modelIndices, std::vector<std::pair<std::string, textureRef_t>>&) override {
+        std::vector<size_t> entries;
+        for (int modelIndex : modelIndices) {
+            entries.push_back(modelEntries[modelIndex]);
+        }
+        resFile.decode(entries, &threadPool_t::shared());
     }
 
-    // Checking first 4 bytes for .mef, .res, or .mtp
-    if (checkFileSignature(file, static_cast<uint32_t>(MeshResourceType::NewO))) {
-        cout << "The file is of type .mef (ascii)." << endl;
+    std::string fileName;
+    resFile_t resFile;
+    std::vector<size_t> modelEntries;
+};
 
-        // Read the MEF file
-        mefFile_t mefFile;
+// Models of an MTP level, textured from the level's texture RES
+struct levelSource_t : modelSource_t {
+    explicit levelSource_t(const std::string& mtpPath) : mtpPath(mtpPath) {}
 
-        // Seek back to the beginning of the file
-        file.seekg(0, std::ios::beg);
+    bool open(std::vector<std::string>& modelNames) override {
+        const char* fileName = mtpPath.c_str();
+        std::string basePath = getFilename::Path(fileName);   // Get the base path of the MTP file
+        std::string baseName = getFilename::File(fileName);   // Get the base name (without extension)
 
-        // Read the MEF data
-        if (!mefFile.readData(file)) {
-            std::cerr << "Failed to read MEF file: " << fileName << std::endl;
-            return 1;
+        std::cout << "File: \t" << fileName << std::endl;
+        std::cout << "Base Path: \t" << basePath << std::endl;
+        std::cout << "Base Name: \t" << baseName << std::endl;
+
+        // Open the MTP file
+        mappedFile_t mtpFileMap;
+        if (!mtpFileMap.open(fileName)) {
+            std::cerr << "Error: Unable to open MTP file: " << fileName << std::endl;
+            return false;
         }
-        file.close();
 
-        // Initialize FLTK and OpenGL
-        Fl::visual(FL_DOUBLE | FL_RGB | FL_ALPHA | FL_DEPTH);
-        Fl_Window* window = new Fl_Window(800, 600, "3D Model Viewer");
+        mtpFile_t mtp;
+        byteStream_t mtpFileStream(mtpFileMap);
+        bool parsed;
+        {
+            tracePhase_t phase("parse_mtp");
+            parsed = mtp.read(mtpFileStream);
+        }
+        logFlush(std::cerr);
+        if (!parsed) {
+            std::cerr << "Error: Failed to read MTP file: " << fileName << std::endl;
+            return false;
+        }
+        mtpFileMap.close();
+
+        // Parse the INST chunk to populate modelToTextureIndices
+        const mtpInstanceTable_t* instTable = nullptr;
+        for (const auto& chunk : mtp.res) {
+            if (chunk.type_debug == "INST") {
+                instTable = static_cast<mtpInstanceTable_t*>(chunk.res);
+                break;
+            }
+        }
+
+        if (instTable) {
+            for (const auto& instance : instTable->instances) {
+                int modelIndex = instance.index; // Index into MODS (model names)
+
+                // Convert vector<unsigned int> to vector<int> and store in modelToTextureIndices
+                std::vector<int> textureIndices(instance.indices.begin(), instance.indices.end());
+                modelToTextureIndices[modelIndex] = std::move(textureIndices); // Texture indices from TEXF
+            }
+        } else {
+            std::cerr << "INST chunk not found in MTP file." << std::endl;
+            return false;
+        }
+
+
+        // Extract model and texture names from MTP data
+        std::vector<std::string> mtpModelNames;
+
+        for (const auto& chunk : mtp.res) {
+            if (chunk.type_debug == "MODS") {
+                mtpStringTable_t* modTable = static_cast<mtpStringTable_t*>(chunk.res);
+                mtpModelNames = modTable->names;
+            } else if (chunk.type_debug == "TEXF") {
+                mtpStringTable_t* texTable = static_cast<mtpStringTable_t*>(chunk.res);
+                textureNames = texTable->names;
+            }
+        }
+
+        if (mtpModelNames.empty()) {
+            std::cerr << "No models found in MTP file." << std::endl;
+            return false;
+        }
+
+        if (textureNames.empty()) {
+            std::cerr << "No textures found in MTP file." << std::endl;
+            return false;
+        }
+
+        // Construct the path to the model and texture resource files
+        std::string modelResPath = basePath + "models/" + baseName + ".res";
+        std::string textureResPath = basePath + "textures/" + baseName + ".res";
+
+        std::cout << "Model RES Path: \t" << modelResPath << std::endl;
+        std::cout << "Texture RES Path: \t" << textureResPath << std::endl;
+
+        if (!os::doesFileExist(modelResPath)) {
+            std::cerr << "Model RES file does not exist: " << modelResPath << std::endl;
+            return false;
+        }
+
+        if (!os::doesFileExist(textureResPath)) {
+            std::cerr << "Texture RES file does not exist: " << textureResPath << std::endl;
+            return false;
+        }
+
+        // Index the model resource file; models are decoded when first shown
+        traceClock_t::time_point resBegin = traceClock_t::now();
+        if (!modelResFile.open(modelResPath.c_str())) {
+            std::cerr << "Failed to read model RES file: " << modelResPath << std::endl;
+            return false;
+        }
+
+        traceRecordSince("open_model_res", resBegin);
+        resBegin = traceClock_t::now();
+
+        // Index the texture resource file by normalized name; mips are finished off the GL thread
+        textureResFile.buildMips = true;
+        if (!textureResFile.open(textureResPath.c_str())) {
+            std::cerr << "Failed to read texture RES file: " << textureResPath << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < textureResFile.size(); ++i) {
+            // e.g. "LOCAL:textures/100_04_1_argb8888.tex" -> "100_04_1_argb8888"
+            textureIndex.emplace(getFilename::File(textureResFile.entry(i).filename), i);
+        }
+        traceRecordSince("open_texture_res", resBegin);
+
+        // Collect the MEF models in archive order
+        for (size_t i = 0; i < modelResFile.size(); ++i) {
+            if (matchPattern(getFilename::Type(modelResFile.entry(i).filename), ".mef")) {
+                modelEntries.push_back(i);
+            }
+        }
+
+        if (modelEntries.empty()) {
+            std::cerr << "Failed to find any meshes in the model RES file." << std::endl;
+            return false;
+        }
+
+        // Name the list entries after MODS where it has them
+        for (size_t modelIndex = 0; modelIndex < modelEntries.size(); ++modelIndex) {
+            if (modelIndex < mtpModelNames.size()) {
+                modelNames.push_back(mtpModelNames[modelIndex]);
+            } else {
+                modelNames.push_back("Model " + std::to_string(modelIndex + 1));
+            }
+        }
+        return true;
+    }
+
+    // Texture names the model's materials are bound to, from its INST entry
+    std::vector<std::string> materialTextures(int modelIndex) const {
+        std::vector<std::string> names;
+        auto texIndicesIter = modelToTextureIndices.find(modelIndex);
+        if (texIndicesIter == modelToTextureIndices.end()) {
+            std::cerr << "No texture indices found for model index: " << modelIndex << std::endl;
+            return names;
+        }
+        for (int texIndex : texIndicesIter->second) {
+            if (texIndex >= 0 && texIndex < static_cast<int>(textureNames.size())) {
+                names.push_back(textureNames[texIndex]);
+            } else {
+                std::cerr << "Texture index out of range: " << texIndex << std::endl;
+                names.push_back(std::string());
+            }
+        }
+        return names;
+    }
+
+    // Decodes the textures these models reference that have not been sent to the UI thread yet
+    void decodeTextures(const std::vector<int>& modelIndices, std::vector<std::pair<std::string, textureRef_t>>& textures) {
+        // Gather the textures these models still need
+        std::vector<std::pair<std::string, size_t>> pending;
+        for (int modelIndex : modelIndices) {
+            auto texIndicesIter = modelToTextureIndices.find(modelIndex);
+            if (texIndicesIter == modelToTextureIndices.end()) {
+                continue;
+            }
+            for (int texIndex : texIndicesIter->second) {
+                if (texIndex < 0 || texIndex >= static_cast<int>(textureNames.size())) {
+                    continue;
+                }
+                const std::string& texName = textureNames[texIndex];
+                auto entryIter = textureIndex.find(texName);
+                if (entryIter == textureIndex.end() || !requestedTextures.insert(texName).second) {
+                    continue;
+                }
+                pending.emplace_back(texName, entryIter->second);
+            }
+        }
+        if (pending.empty()) {
+            return;
+        }
+
+        // Decode them across all cores, then hand the pixels to the UI thread
+        tracePhase_t phase("decode_textures");
+        std::vector<size_t> entries;
+        for (const auto& item : pending) {
+            entries.push_back(item.second);
+        }
+        textureResFile.decode(entries, &threadPool_t::shared());
+        for (const auto& item : pending) {
+            resChunk_t* texChunk = textureResFile.get(item.second);
+            if (texChunk != nullptr && texChunk->texture && !texChunk->texture->image_data.empty()) {
+                // Only the view travels; the pixels stay where the archive decoded them
+                textures.emplace_back(item.first, texChunk->texture);
+            }
+        }
+    }
+
+    // Geometry cache entry for the model's BODY, or an empty path when caching is off
+    std::string cachePathFor(size_t entryIndex, uint64_t& key) const {
+        key = geomCacheHash(modelResFile.bodyData(entryIndex), modelResFile.bodySize(entryIndex));
+        return geomCachePath(key);
+    }
+
+    // Only the model itself and the textures its INST entry references are decoded.
+    // Geometry seen before comes from the on-disk cache without decoding the model.
+    bool build(int modelIndex, preparedModel_t& model) override {
+        size_t entryIndex = modelEntries[modelIndex];
+        decodeTextures(std::vector<int>(1, modelIndex), model.textures);
+
+        // The cache is keyed by the BODY bytes; the bindings come from the MTP, so check them too
+        traceClock_t::time_point lookupBegin = traceClock_t::now();
+        uint64_t key;
+        std::string cachePath = cachePathFor(entryIndex, key);
+        std::vector<std::string> bindings = materialTextures(modelIndex);
+        if (bindings.empty()) {
+            bindings.push_back(std::string());
+        }
+        bool hit = model.geometry.open(cachePath, key) && model.geometry.materialCount() == bindings.size();
+        for (size_t i = 0; hit && i < bindings.size(); ++i) {
+            hit = model.geometry.texture(i) == bindings[i];
+        }
+        traceRecordSince("cache_lookup", lookupBegin);
+        traceSetInfo("geometry_cache", hit ? "hit" : "miss");
+        if (hit) {
+            LOG_DEBUG(logCategory_t::Mesh, "Geometry cache hit: " << cachePath);
+            return true;
+        }
+
+        traceClock_t::time_point decodeBegin = traceClock_t::now();
+        resChunk_t* chunk = modelResFile.get(entryIndex);
+        traceRecordSince("decode_model", decodeBegin);
+        if (chunk == nullptr) {
+            std::cerr << "Failed to decode model: " << modelResFile.entry(entryIndex).filename << std::endl;
+            return false;
+        }
+
+        meshGeometry_t geometry;
+        std::vector<geomCacheVertex_t> interleaved;
+        std::vector<std::vector<uint32_t>> materialIndices;
+        if (!buildMeshFromMEFWithMaterial(chunk->model, bindings, geometry) || !interleaveMeshGeometry(geometry, interleaved, materialIndices)) {
+            return false;
+        }
+
+        // Store what was just built so the next visit skips straight to the upload
+        if (!cachePath.empty()) {
+            tracePhase_t phase("cache_store");
+            if (!geomCacheStore(cachePath, key, interleaved, materialIndices, geometry.materialTextures)) {
+                LOG_WARN(logCategory_t::Mesh, "Could not write geometry cache entry: " << cachePath);
+            }
+        }
+        model.geometry.assign(std::move(interleaved), materialIndices, geometry.materialTextures);
+        return true;
+    }
+
+    // Decodes the textures and, unless the geometry cache already has them, the BODY chunks
+    void prefetch(const std::vector<int>& modelIndices, std::vector<std::pair<std::string, textureRef_t>>& textures) override {
+        decodeTextures(modelIndices, textures);
+
+        std::vector<size_t> entries;
+        for (int modelIndex : modelIndices) {
+            uint64_t key;
+            std::string cachePath = cachePathFor(modelEntries[modelIndex], key);
+            // Only the header is checked here; build validates the whole entry before using it
+            if (!geomCacheProbe(cachePath, key)) {
+                entries.push_back(modelEntries[modelIndex]);
+            }
+        }
+        modelResFile.decode(entries, &threadPool_t::shared());
+    }
+
+    std::string mtpPath;
+    resFile_t modelResFile;
+    resFile_t textureResFile;
+    std::vector<size_t> modelEntries;
+    std::unordered_map<std::string, size_t> textureIndex;      // Normalized name -> texture RES entry
+    std::vector<std::string> textureNames;
+    std::unordered_map<int, std::vector<int>> modelToTextureIndices;
+    std::unordered_set<std::string> requestedTextures;         // Already decoded and sent to the UI thread
+};
+
+// Starts loading the level in the background; the list and viewport fill in as models arrive
+void loadMTP(const char* fileName, modelLoader_t& loader) {
+    loader.start(std::unique_ptr<modelSource_t>(new levelSource_t(fileName)));
+}
+#endif // MEFVIEW_HEADLESS
+
+bool checkFileSignature(byteStream_t &file, unsigned int expectedSignature, unsigned long offset = 0) {
+    // Move to the required offset
+    file.clear();
+    file.seekg(offset);
+    if (!file) {
+        cerr << "Error: Unable to seek to offset " << offset << "." << endl;
+        return false;
+    }
+
+    unsigned int fileSignature = 0;
+    file.read(reinterpret_cast<char*>(&fileSignature), sizeof(fileSignature));
+    if (!file) {
+        cerr << "Error: Unable to read signature from file." << endl;
+        return false;
+    }
+
+    return fileSignature == expectedSignature;
+}
+
+#ifndef MEFVIEW_HEADLESS
+static void closeAllWindows(void*) {
+    while (Fl_Window* window = Fl::first_window()) {
+        window->hide();
+    }
+}
+
+// Called from the GL window once the first frame with a model is on screen;
+// only ever fires when the first-frame benchmark armed it
+static void firstFrameShown() {
+    Fl::add_timeout(0.0, closeAllWindows);
+}
+
+int determineFileType(const char* fileName) {
+    mappedFile_t fileMap;
+    if (!fileMap.open(fileName)) {
+        cerr << "Error: Unable to open file: " << fileName << endl;
+        return 1;
+    }
+    byteStream_t file(fileMap);
+
+    // Checking first 4 bytes for .mef, .res, or .mtp
+    if (checkFileSignature(file, static_cast<uint32_t>(MeshResourceType::NewO))) {
+        cout << "The file is of type .mef (ascii)." << endl;
+
+        // Read the MEF file
+        mefFile_t mefFile;
+
+        // Seek back to the beginning of the file
+        file.clear();
+        file.seekg(0);
+
+        // Read the MEF data
+        traceClock_t::time_point parseBegin = traceClock_t::now();
+        bool parsed = mefFile.readData(file);
+        traceRecordSince("parse_mef", parseBegin);
+        logFlush(std::cerr);
+        if (!parsed) {
+            std::cerr << "Failed to read MEF file: " << fileName << std::endl;
+            return 1;
+        }
+        fileMap.close();
+
+        // Initialize FLTK and OpenGL
+        traceClock_t::time_point windowBegin = traceClock_t::now();
+        Fl::visual(FL_DOUBLE | FL_RGB | FL_ALPHA | FL_DEPTH);
+        Fl_Window* window = new Fl_Window(800, 600, "3D Model Viewer");
 
         // Create the GL window inside the main window
         MyGlWindow* glWindow = new MyGlWindow(0, 0, 800, 600, nullptr);
@@ -6152,6 +6754,7 @@ int determineFileType(const char* fileName) {
 
         // Show the main window
         window->show();
+        traceRecordSince("create_window", windowBegin);
 
         // Load the mesh using the loadMeshFromMEF function
         if (!loadMeshFromMEF(mefFile, glWindow)) {
@@ -6160,6 +6763,7 @@ int determineFileType(const char* fileName) {
         }
 
         // Run the application
+        traceArmFirstFrame(firstFrameShown);
         return Fl::run();
 
     } else if (checkFileSignature(file, static_cast<uint32_t>(MeshResourceType::ILFF))) {
@@ -6171,16 +6775,22 @@ int determineFileType(const char* fileName) {
             mefFile_t mefFile;
 
             // Seek back to the beginning of the file
-            file.seekg(0, std::ios::beg);
+            file.clear();
+            file.seekg(0);
 
             // Read the MEF data
-            if (!mefFile.readData(file)) {
+            traceClock_t::time_point parseBegin = traceClock_t::now();
+            bool parsed = mefFile.readData(file);
+            traceRecordSince("parse_mef", parseBegin);
+            logFlush(std::cerr);
+            if (!parsed) {
                 std::cerr << "Failed to read MEF file: " << fileName << std::endl;
                 return 1;
             }
-            file.close();
+            fileMap.close();
 
             // Initialize FLTK and OpenGL
+            traceClock_t::time_point windowBegin = traceClock_t::now();
             Fl::visual(FL_DOUBLE | FL_RGB | FL_ALPHA | FL_DEPTH);
             Fl_Window* window = new Fl_Window(800, 600, "3D Model Viewer");
 
@@ -6191,6 +6801,7 @@ int determineFileType(const char* fileName) {
 
             // Show the main window
             window->show();
+            traceRecordSince("create_window", windowBegin);
 
             // Load the mesh using the loadMeshFromMEF function
             if (!loadMeshFromMEF(mefFile, glWindow)) {
@@ -6199,6 +6810,7 @@ int determineFileType(const char* fileName) {
             }
 
             // Run the application
+            traceArmFirstFrame(firstFrameShown);
             return Fl::run();
             }
         else if (checkFileSignature(file, static_cast<uint32_t>(MeshResourceType::IRES), 16)) {
@@ -6213,14 +6825,8 @@ int determineFileType(const char* fileName) {
             } else {
                 cout << "The .res file contains MEF models." << endl;
 
-                // Read the .res file
-                resFile_t resFile;
-                if (!resFile.read(fileName)) {
-                    std::cerr << "Failed to parse RES file: " << fileName << std::endl;
-                    return 1;
-                }
-
                 // Initialize FLTK and OpenGL
+                traceClock_t::time_point windowBegin = traceClock_t::now();
                 Fl::visual(FL_DOUBLE | FL_RGB | FL_ALPHA | FL_DEPTH);
 
                 // Create the main window
@@ -6245,67 +6851,18 @@ int determineFileType(const char* fileName) {
 
                 // Show the main window
                 window->show();
+                traceRecordSince("create_window", windowBegin);
+                fileMap.close();
 
-                // Extract and list MEF models
-                std::vector<mefFile_t> mefModels;
-                int modelIndex = 0;
-                for (const auto& chunk : resFile.chunks) {
-                    if (chunk.chunk_type != static_cast<uint32_t>(MeshResourceType::BODY)) { // 'BODY'
-                        continue; // Only process 'BODY' chunks
-                    }
-
-                    if (!chunk.model.content.empty()) {
-                        mefModels.push_back(chunk.model);
-
-                        // Use model names if available; otherwise, use indices
-                        std::string modelName = "Model " + std::to_string(++modelIndex);
-                        modelList->add(modelName.c_str());
-                    }
-                }
-
-                if (mefModels.empty()) {
-                    std::cerr << "Failed to find any meshes in the RES file." << std::endl;
-                    return 1;
-                }
-
-                // Select the first item in the list
-                modelList->select(1);
-
-                // Load the first model by default
-                if (!loadMeshFromMEF(mefModels[0], glWindow)) {
-                    std::cerr << "Failed to load the first mesh from MEF file." << std::endl;
-                    return 1;
-                }
-
-                // Set up the callback for model selection
-                struct CallbackData {
-                    std::vector<mefFile_t>* models;
-                    MyGlWindow* glWindow;
-                };
-
-                CallbackData* cbData = new CallbackData{ &mefModels, glWindow };
-
-                modelList->callback([](Fl_Widget* widget, void* data) {
-                    Fl_Browser* browser = static_cast<Fl_Browser*>(widget);
-                    CallbackData* cbData = static_cast<CallbackData*>(data);
-                    int selectedIndex = browser->value(); // 1-based index
-
-                    if (selectedIndex > 0 && selectedIndex <= static_cast<int>(cbData->models->size())) {
-                        // Load the selected mesh
-                        if (!loadMeshFromMEF((*cbData->models)[selectedIndex - 1], cbData->glWindow)) {
-                            std::cerr << "Failed to load selected mesh." << std::endl;
-                        } else {
-                            cbData->glWindow->redraw();
-                        }
-                    }
-                }, cbData);
+                // Index and decode the .res file in the background; models are decoded when selected
+                modelLoader_t loader(glWindow, modelList);
+                loader.armFirstFrame(firstFrameShown);
+                modelList->callback(modelLoader_t::onSelect, &loader);
+                loader.start(std::unique_ptr<modelSource_t>(new resSource_t(fileName)));
 
                 // Run the application
                 int result = Fl::run();
-
-                // Clean up
-                delete cbData;
-                return result;
+                return loader.failed() ? 1 : result;
             }
 
         } else {
@@ -6317,6 +6874,7 @@ int determineFileType(const char* fileName) {
 
 
         // Initialize FLTK and OpenGL
+        traceClock_t::time_point windowBegin = traceClock_t::now();
         Fl::visual(FL_DOUBLE | FL_RGB | FL_ALPHA | FL_DEPTH);
 
         // Create the main window
@@ -6341,15 +6899,23 @@ int determineFileType(const char* fileName) {
 
         // Show the main window
         window->show();
+        traceRecordSince("create_window", windowBegin);
 
-        // Load the MTP file
-        if (!loadMTP(fileName, modelList, glWindow)) {
+        fileMap.close();
+
+        // Load the level in the background; the first model shows as soon as it is built
+        modelLoader_t loader(glWindow, modelList);
+        loader.armFirstFrame(firstFrameShown);
+        modelList->callback(modelLoader_t::onSelect, &loader);
+        loadMTP(fileName, loader);
+
+        // Run the application
+        int result = Fl::run();
+        if (loader.failed()) {
             cerr << "Failed to load MTP file: " << fileName << endl;
             return 1;
         }
-
-        // Run the application
-        return Fl::run();
+        return result;
     } else {
         cout << "Unknown file type." << endl;
         return 1;
@@ -6357,7 +6923,1214 @@ int determineFileType(const char* fileName) {
     return 0;
 }
 
+// "Open file to first frame" benchmark
+//
+//   mefview --first-frame <file> [--json out.json] [--software-gl] [--timeout seconds]
+//
+// Opens the file exactly like the viewer does, closes the window after the
+// first frame showing the model and writes the phase timings as JSON.
+static int runFirstFrame(int argc, char* argv[]) {
+    std::string fileName;
+    std::string jsonPath;
+    bool softwareGL = false;
+    double timeout = 60.0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--first-frame" && i + 1 < argc) {
+            fileName = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--software-gl") {
+            softwareGL = true;
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            timeout = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown first-frame option: " << arg << std::endl;
+            return 2;
+        }
+    }
+    if (fileName.empty()) {
+        std::cerr << "Usage: mefview --first-frame <file> [--json out.json] [--software-gl] [--timeout seconds]" << std::endl;
+        return 2;
+    }
+
+    // Mesa picks these up when the GL context is created, so no GPU is needed
+    if (softwareGL) {
+#ifdef _WIN32
+        _putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+        _putenv_s("GALLIUM_DRIVER", "llvmpipe");
+#else
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+        setenv("GALLIUM_DRIVER", "llvmpipe", 1);
+#endif
+    }
+
+    traceStart();
+    traceSetInfo("file", fileName);
+    traceSetInfo("software_gl", softwareGL ? "1" : "0");
+
+    // Give up instead of hanging when nothing ever gets drawn
+    Fl::add_timeout(timeout, closeAllWindows);
+
+    int status = determineFileType(fileName.c_str());
+    logFlush(std::cerr);
+    if (status == 0 && !traceFirstFrameDone()) {
+        std::cerr << "No frame was drawn within " << timeout << " seconds." << std::endl;
+        status = 1;
+    }
+
+    if (jsonPath.empty()) {
+        traceWriteJson(std::cout);
+    } else {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Error: Unable to write " << jsonPath << std::endl;
+            return 1;
+        }
+        traceWriteJson(out);
+    }
+    return status;
+}
+
+#endif // MEFVIEW_HEADLESS
+
+// Batch command line mode
+//
+//   mefview --dump|--validate|--convert|--repack [-o dir] [-j threads] <file|dir|glob>...
+//
+// Runs the same parsers as the viewer without creating a window or GL context,
+// so it also builds on machines without FLTK (define MEFVIEW_HEADLESS).
+
+enum class batchCommand_t { None, Dump, Validate, Convert, Repack };
+
+enum class assetKind_t { Unknown, Mef, Res, Mtp, Tex };
+
+struct batchOptions_t {
+    batchCommand_t command = batchCommand_t::None;
+    std::string outputDir;      // Empty writes next to each input
+    unsigned threads = 0;       // 0 uses the shared pool
+    bool png = false;           // Convert textures to PNG instead of TGA
+    pngLevel_t pngLevel = pngLevel_t::Default;
+    bool rle = false;           // RLE-compress TGA output
+    std::vector<std::string> inputs;
+};
+
+// Case-insensitive wildcard match supporting '*' and '?'
+bool wildcardMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0;
+    size_t star = std::string::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' ||
+            std::tolower(static_cast<unsigned char>(pattern[p])) == std::tolower(static_cast<unsigned char>(text[t])))) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool isBatchAsset(const std::string& path) {
+    return hasExtension(path, ".mef") || hasExtension(path, ".res") ||
+           hasExtension(path, ".mtp") || hasExtension(path, ".tex");
+}
+
+// Expands files, directories (recursively) and globs in the last path component
+bool collectBatchInputs(const std::vector<std::string>& args, std::vector<std::string>& files) {
+    namespace fs = std::filesystem;
+    bool result = true;
+
+    for (const std::string& arg : args) {
+        std::vector<std::string> found;
+        std::error_code ec;
+
+        if (arg.find_first_of("*?") != std::string::npos) {
+            fs::path pattern(arg);
+            fs::path dir = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+            std::string mask = pattern.filename().string();
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_regular_file(ec) && wildcardMatch(mask, it->path().filename().string())) {
+                    found.push_back(it->path().string());
+                }
+            }
+            if (found.empty()) {
+                std::cerr << "No files match: " << arg << std::endl;
+                result = false;
+            }
+        } else if (fs::is_directory(arg, ec)) {
+            for (fs::recursive_directory_iterator it(arg, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_regular_file(ec) && isBatchAsset(it->path().string())) {
+                    found.push_back(it->path().string());
+                }
+            }
+        } else if (fs::is_regular_file(arg, ec)) {
+            found.push_back(arg);
+        } else {
+            std::cerr << "No such file or directory: " << arg << std::endl;
+            result = false;
+        }
+
+        // Directory order is filesystem dependent; keep reports reproducible
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return result;
+}
+
+assetKind_t detectAsset(byteStream_t& f, const std::string& path) {
+    if (f.size() >= 4) {
+        if (checkFileSignature(f, static_cast<uint32_t>(MeshResourceType::ILFF))) {
+            bool mef = f.size() >= 20 && checkFileSignature(f, static_cast<uint32_t>(MeshResourceType::MECO), 16);
+            return mef ? assetKind_t::Mef : assetKind_t::Res;
+        }
+        if (checkFileSignature(f, static_cast<uint32_t>(MeshResourceType::NewO))) {
+            return assetKind_t::Mef;
+        }
+        if (checkFileSignature(f, 0x4D524F46)) { // 'FORM'
+            return assetKind_t::Mtp;
+        }
+    }
+    return hasExtension(path, ".tex") ? assetKind_t::Tex : assetKind_t::Unknown;
+}
+
+// Output file for input with its extension replaced; uses outputDir when given
+std::string batchOutputPath(const batchOptions_t& opts, const std::string& input, const std::string& ext) {
+    std::filesystem::path in(input);
+    std::filesystem::path dir = opts.outputDir.empty() ? in.parent_path() : std::filesystem::path(opts.outputDir);
+    return (dir / (in.stem().string() + ext)).string();
+}
+
+bool processBatchMef(const batchOptions_t& opts, const std::string& path, byteStream_t& f, std::ostream& out) {
+    mefFile_t mefFile;
+    f.clear();
+    f.seekg(0);
+    if (!mefFile.readData(f)) {
+        out << "FAIL " << path << ": not a readable MEF file\n";
+        return false;
+    }
+
+    switch (opts.command) {
+        case batchCommand_t::Dump:
+            out << path << ": MEF, " << mefFile.content.size() << " chunks\n";
+            for (const auto& chunk : mefFile.content) {
+                out << chunk.to_string() << "\n";
+            }
+            return true;
+        case batchCommand_t::Convert: {
+            std::string objPath = batchOutputPath(opts, path, ".obj");
+            if (!mefFile.exportOBJ(objPath)) {
+                out << "FAIL " << path << ": OBJ export failed\n";
+                return false;
+            }
+            out << "OK   " << path << " -> " << objPath << "\n";
+            return true;
+        }
+        case batchCommand_t::Repack: {
+            std::string mefPath = batchOutputPath(opts, path, ".mef");
+            std::error_code ec;
+            if (std::filesystem::equivalent(path, mefPath, ec)) {
+                out << "FAIL " << path << ": refusing to overwrite the input, use -o\n";
+                return false;
+            }
+            if (!mefFile.writeData(mefPath)) {
+                out << "FAIL " << path << ": could not write " << mefPath << "\n";
+                return false;
+            }
+            out << "OK   " << path << " -> " << mefPath << "\n";
+            return true;
+        }
+        default: {
+            // Serializing what was read must reproduce the input exactly
+            byteWriter_t buffer;
+            mefFile.writeData(buffer);
+            const uint8_t* original = f.data();
+            size_t common = std::min(buffer.size(), f.size());
+            size_t mismatch = std::mismatch(buffer.data(), buffer.data() + common, original).first - buffer.data();
+            if (mismatch < common || buffer.size() != f.size()) {
+                out << "FAIL " << path << ": round trip differs at byte " << mismatch << "\n";
+                return false;
+            }
+            out << "OK   " << path << "\n";
+            return true;
+        }
+    }
+}
+
+bool processBatchRes(const batchOptions_t& opts, const std::string& path, std::ostream& out, threadPool_t* pool) {
+    resFile_t resFile;
+    if (!resFile.open(path)) {
+        out << "FAIL " << path << ": not a readable RES archive\n";
+        return false;
+    }
+
+    if (opts.command == batchCommand_t::Dump) {
+        // Models also list their MESH header; the stream parser stops there, leaving the geometry undecoded
+        std::string meshSummary;
+        mefStreamParser_t meshHeader;
+        meshHeader.on<mefMesh_t>([&meshSummary](const mefMesh_t& mesh) {
+            std::ostringstream oss;
+            oss << "model type " << mesh.model_type << ", " << mesh.num_r_verts << " vertices, " << mesh.num_r_faces
+                << " faces, " << mesh.num_bones << " bones";
+            meshSummary = oss.str();
+            return false;
+        });
+
+        out << path << ": RES, " << resFile.size() << " entries\n";
+        for (size_t i = 0; i < resFile.size(); ++i) {
+            const resEntry_t& e = resFile.entry(i);
+            out << "\t" << i << ": \t\"" << e.filename << "\" " << e.chunk_size << " bytes \"" << e.filepath << "\"\n";
+
+            byteStream_t body = resFile.body(i);
+            if (resFile.bodySize(i) >= 20 && checkFileSignature(body, static_cast<uint32_t>(MeshResourceType::IFLF)) &&
+                checkFileSignature(body, static_cast<uint32_t>(MeshResourceType::MECO), 16)) {
+                meshSummary.clear();
+                body.seekg(0);
+                if (meshHeader.parse(body) && !meshSummary.empty()) {
+                    out << "\t\t" << meshSummary << "\n";
+                }
+            }
+        }
+        return true;
+    }
+    if (opts.command == batchCommand_t::Repack) {
+        out << "SKIP " << path << ": only MEF files are repacked\n";
+        return true;
+    }
+
+    if (!resFile.decodeAll(pool)) {
+        out << "FAIL " << path << ": one or more entries failed to decode\n";
+        return false;
+    }
+    if (opts.command == batchCommand_t::Validate) {
+        out << "OK   " << path << " (" << resFile.size() << " entries)\n";
+        return true;
+    }
+
+    // Each archive converts into a folder named after it
+    std::filesystem::path dir = batchOutputPath(opts, path, "");
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        out << "FAIL " << path << ": cannot create " << dir.string() << "\n";
+        return false;
+    }
+
+    bool result = true;
+    size_t written = 0;
+    // Output names in lower case; entries from different RES directories can share a name
+    std::unordered_set<std::string> usedNames;
+    for (size_t i = 0; i < resFile.size(); ++i) {
+        resChunk_t* chunk = resFile.get(i);
+        if (chunk == nullptr) {
+            continue;
+        }
+
+        const char* ext = nullptr;
+        if (hasExtension(chunk->filename, ".mef")) {
+            ext = ".obj";
+        } else if (hasExtension(chunk->filename, ".tex") || hasExtension(chunk->filename, ".tga")) {
+            ext = opts.png ? ".png" : ".tga";
+        } else {
+            continue;
+        }
+
+        // Entry names may use either separator
+        std::string entryName = chunk->filename;
+        std::replace(entryName.begin(), entryName.end(), '\\', '/');
+        std::string stem = std::filesystem::path(entryName).stem().string();
+        if (stem.empty()) {
+            stem = "entry_" + std::to_string(i);
+        }
+        // A name already written gets the entry index, rather than overwriting the earlier file
+        std::string outName = stem + ext;
+        std::string key = outName;
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (!usedNames.insert(key).second) {
+            outName = stem + "_" + std::to_string(i) + ext;
+            key = outName;
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            usedNames.insert(key);
+            LOG_WARN(logCategory_t::General, path << ": " << chunk->filepath << chunk->filename << " shares its name with an earlier entry, written as " << outName);
+        }
+        std::string outPath = (dir / outName).string();
+
+        bool ok = true;
+        if (hasExtension(chunk->filename, ".mef")) {
+            ok = chunk->model.exportOBJ(outPath);
+        } else if (opts.png) {
+            ok = chunk->texture && chunk->texture->saveAsPNG(outPath, false, false, opts.pngLevel, pool);
+        } else {
+            ok = chunk->texture && chunk->texture->save(outPath.c_str(), opts.rle);
+        }
+
+        if (ok) {
+            written++;
+        } else {
+            out << "FAIL " << path << ": could not convert " << chunk->filename << "\n";
+            result = false;
+        }
+    }
+    out << (result ? "OK   " : "FAIL ") << path << " -> " << dir.string() << " (" << written << " files)\n";
+    return result;
+}
+
+bool processBatchMtp(const batchOptions_t& opts, const std::string& path, byteStream_t& f, std::ostream& out) {
+    mtpFile_t mtp;
+    f.clear();
+    f.seekg(0);
+    if (!mtp.read(f)) {
+        out << "FAIL " << path << ": not a readable MTP file\n";
+        return false;
+    }
+
+    if (opts.command == batchCommand_t::Dump) {
+        out << path << ": MTP, " << mtp.res.size() << " chunks\n";
+        for (const auto& chunk : mtp.res) {
+            out << "\t" << chunk.type_debug << " \t" << chunk.size << " bytes\n";
+        }
+    } else if (opts.command == batchCommand_t::Convert) {
+        out << "SKIP " << path << ": level tables have no export format\n";
+    } else if (opts.command == batchCommand_t::Repack) {
+        out << "SKIP " << path << ": only MEF files are repacked\n";
+    } else {
+        out << "OK   " << path << "\n";
+    }
+    return true;
+}
+
+bool processBatchTex(const batchOptions_t& opts, const std::string& path, byteStream_t& f, std::ostream& out, threadPool_t* pool) {
+    texFile_t texFile;
+    f.clear();
+    f.seekg(0);
+    if (!texFile.read(f, false)) {
+        out << "FAIL " << path << ": not a readable TEX file\n";
+        return false;
+    }
+
+    switch (opts.command) {
+        case batchCommand_t::Dump:
+            out << path << ": TEX, " << texFile.width << "x" << texFile.height
+                << " (cropped " << texFile.croppedWidth << "x" << texFile.croppedHeight
+                << "), type " << texFile.image_type << " (" << texFindFormat(texFile.image_type)->name << ")\n";
+            return true;
+        case batchCommand_t::Convert: {
+            std::string imagePath = batchOutputPath(opts, path, opts.png ? ".png" : ".tga");
+            tgaFile_t tga;
+            bool saved = std::move(texFile).toTga(tga) &&
+                (opts.png ? tga.saveAsPNG(imagePath, false, false, opts.pngLevel, pool) : tga.save(imagePath.c_str(), opts.rle));
+            if (!saved) {
+                out << "FAIL " << path << ": " << (opts.png ? "PNG" : "TGA") << " export failed\n";
+                return false;
+            }
+            out << "OK   " << path << " -> " << imagePath << "\n";
+            return true;
+        }
+        case batchCommand_t::Repack:
+            out << "SKIP " << path << ": only MEF files are repacked\n";
+            return true;
+        default:
+            out << "OK   " << path << "\n";
+            return true;
+    }
+}
+
+// pool spreads the entries and texture segments of this file; it may be the pool running the call
+bool processBatchFile(const batchOptions_t& opts, const std::string& path, std::ostream& out, threadPool_t* pool) {
+    mappedFile_t fileMap;
+    if (!fileMap.open(path)) {
+        out << "FAIL " << path << ": cannot open\n";
+        return false;
+    }
+    byteStream_t f(fileMap);
+
+    switch (detectAsset(f, path)) {
+        case assetKind_t::Mef:
+            return processBatchMef(opts, path, f, out);
+        case assetKind_t::Res:
+            fileMap.close();
+            return processBatchRes(opts, path, out, pool);
+        case assetKind_t::Mtp:
+            return processBatchMtp(opts, path, f, out);
+        case assetKind_t::Tex:
+            return processBatchTex(opts, path, f, out, pool);
+        default:
+            out << "FAIL " << path << ": unknown file type\n";
+            return false;
+    }
+}
+
+void printBatchUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " --dump|--validate|--convert|--repack [options] <file|dir|glob>...\n"
+              << "  --dump          Print the chunk layout of each file\n"
+              << "  --validate      Parse each file fully and report failures; MEF files\n"
+              << "                  must also serialize back to identical bytes\n"
+              << "  --convert       Export MEF to OBJ and TEX to TGA; RES archives convert\n"
+              << "                  into a folder named after the archive\n"
+              << "  --repack        Rewrite MEF files through the MEF writer (needs -o)\n"
+              << "  --png           With --convert, write textures as PNG instead of TGA\n"
+              << "  --png-level L   PNG speed/size trade-off: fast, default or small (implies --png)\n"
+              << "  --rle           With --convert, write RLE-compressed TGAs\n"
+              << "  -o, --output    Directory for converted files (default: next to input)\n"
+              << "  -j, --jobs      Number of worker threads (default: all cores)\n"
+              << "  --log S         Log level and categories, e.g. warning or info,mesh,archive\n"
+              << "                  (overrides MEFVIEW_LOG)\n"
+              << "Directories are searched recursively for .mef, .res, .mtp and .tex files.\n";
+}
+
+int runBatch(int argc, char* argv[]) {
+    batchOptions_t opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dump") {
+            opts.command = batchCommand_t::Dump;
+        } else if (arg == "--validate") {
+            opts.command = batchCommand_t::Validate;
+        } else if (arg == "--convert") {
+            opts.command = batchCommand_t::Convert;
+        } else if (arg == "--repack") {
+            opts.command = batchCommand_t::Repack;
+        } else if (arg == "--png") {
+            opts.png = true;
+        } else if (arg == "--rle") {
+            opts.rle = true;
+        } else if (arg == "--png-level" && i + 1 < argc) {
+            if (!pngParseLevel(argv[++i], opts.pngLevel)) {
+                std::cerr << "Unknown PNG level: " << argv[i] << std::endl;
+                printBatchUsage(argv[0]);
+                return 2;
+            }
+            opts.png = true;
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            opts.outputDir = argv[++i];
+        } else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+            opts.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--log" && i + 1 < argc) {
+            if (!logConfigure(argv[++i])) {
+                std::cerr << "Unknown log level or category in: " << argv[i] << std::endl;
+                printBatchUsage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printBatchUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printBatchUsage(argv[0]);
+            return 2;
+        } else {
+            opts.inputs.push_back(arg);
+        }
+    }
+
+    if (opts.command == batchCommand_t::None || opts.inputs.empty()) {
+        printBatchUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> files;
+    bool inputsOk = collectBatchInputs(opts.inputs, files);
+    if (files.empty()) {
+        std::cerr << "No input files found." << std::endl;
+        return 1;
+    }
+
+    if (!opts.outputDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(opts.outputDir, ec);
+        if (ec) {
+            std::cerr << "Cannot create output directory: " << opts.outputDir << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<threadPool_t> ownPool;
+    threadPool_t* pool = &threadPool_t::shared();
+    if (opts.threads > 0) {
+        ownPool.reset(new threadPool_t(opts.threads));
+        pool = ownPool.get();
+    }
+
+    // Reports are buffered per file and printed in input order. Files share the
+    // pool with their own entries and segments, so one large archive in a batch
+    // still uses every worker.
+    std::vector<std::string> reports(files.size());
+    std::vector<char> ok(files.size(), 0);
+    pool->parallelFor(files.size(), [&](size_t i) {
+        std::ostringstream out;
+        ok[i] = processBatchFile(opts, files[i], out, pool) ? 1 : 0;
+        reports[i] = out.str();
+    });
+
+    size_t failed = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::cout << reports[i];
+        failed += ok[i] ? 0 : 1;
+    }
+    std::cout.flush();
+    logFlush(std::cerr);
+
+    std::cerr << files.size() << " files processed, " << failed << " failed." << std::endl;
+    return (failed == 0 && inputsOk) ? 0 : 1;
+}
+
+#ifdef MEFVIEW_BENCHMARK
+// Parser benchmark
+//
+//   mefview-bench [--corpus dir] [--vertices n] [--texture n] [--models n] [-n iterations] [--seed s]
+//
+// Generates a reproducible synthetic corpus of MEF/RES/MTP/TEX/TGA files (game
+// assets cannot be shipped) and times each loader over it. Meshes are written
+// through the resources' own writeData so the corpus follows the reader's layout.
+
+// Every heap allocation in the benchmark build goes through these counters.
+// The whole replaceable set is defined, so each form of new is paired with its delete.
+static std::atomic<size_t> benchAllocations(0);
+
+static void* benchAllocate(size_t size, size_t alignment) noexcept {
+    benchAllocations.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void benchRelease(void* p, size_t alignment) noexcept {
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(p);
+}
+
+static void* benchAllocateOrThrow(size_t size, size_t alignment) {
+    if (void* p = benchAllocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return benchAllocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return benchAllocateOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return benchAllocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return benchAllocate(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return benchAllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return benchAllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return benchAllocate(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return benchAllocate(size, static_cast<size_t>(align)); }
+
+void operator delete(void* p) noexcept { benchRelease(p, 0); }
+void operator delete[](void* p) noexcept { benchRelease(p, 0); }
+void operator delete(void* p, size_t) noexcept { benchRelease(p, 0); }
+void operator delete[](void* p, size_t) noexcept { benchRelease(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { benchRelease(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { benchRelease(p, 0); }
+void operator delete(void* p, std::align_val_t align) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, std::align_val_t align) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, size_t, std::align_val_t align) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+void operator delete(void* p, std::align_val_t align, const std::nothrow_t&) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, std::align_val_t align, const std::nothrow_t&) noexcept { benchRelease(p, static_cast<size_t>(align)); }
+
+struct benchOptions_t {
+    std::string corpusDir;
+    uint32_t vertices = 20000;  // Per synthetic model
+    uint32_t textureSize = 512; // Edge length of synthetic textures
+    uint32_t models = 16;       // Models and textures per RES archive
+    uint32_t iterations = 20;
+    uint32_t seed = 1234;
+};
+
+struct benchResult_t {
+    std::string name;
+    size_t bytes;       // Input bytes handled per iteration
+    uint32_t iterations;
+    double seconds;
+    size_t allocations;
+};
+
+// Appends a chunk to mef; writeData fills in the payload size and padding
+void benchAddChunk(mefFile_t& mef, MeshResourceType type, mefResourcePtr res) {
+    mefMeshChunk_t chunk;
+    chunk.type = static_cast<uint32_t>(type);
+    chunk.flag = 4;
+    chunk.res = std::move(res);
+    mef.content.push_back(std::move(chunk));
+}
+
+bool benchWriteMef(const std::string& path, uint32_t vertexCount, std::mt19937& rng) {
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    vertexCount = std::max<uint32_t>(3, std::min<uint32_t>(vertexCount, 65535));
+    uint32_t faceCount = vertexCount - 2;
+    uint32_t submeshes = std::max<uint32_t>(1, std::min<uint32_t>(8, faceCount / 64));
+
+    std::unique_ptr<mefMesh_t> header(new mefMesh_t());
+    header->model_type = 0;
+    header->num_r_faces = faceCount;
+    header->num_r_verts = vertexCount;
+    header->model_radius = 100.0f;
+
+    std::unique_ptr<mefMeshVrtx_t> vrtx(new mefMeshVrtx_t());
+    vrtx->entry.resize(vertexCount);
+    for (auto& v : vrtx->entry) {
+        v.position = {coord(rng), coord(rng), coord(rng)};
+        v.normal = {0.0f, 0.0f, 1.0f};
+        v.texcoord0 = {unit(rng), unit(rng)};
+    }
+
+    // A triangle strip unrolled into a list keeps every index in range
+    std::unique_ptr<mefMeshFace_t> face(new mefMeshFace_t());
+    face->entry.resize(faceCount);
+    for (uint32_t i = 0; i < faceCount; ++i) {
+        face->entry[i] = {static_cast<uint16_t>(i), static_cast<uint16_t>(i + 1), static_cast<uint16_t>(i + 2)};
+    }
+
+    std::unique_ptr<mefMeshRend_t> rend(new mefMeshRend_t());
+    rend->entry.resize(submeshes);
+    uint32_t facesPer = faceCount / submeshes;
+    for (uint32_t i = 0; i < submeshes; ++i) {
+        mefMeshRendEntry_t& e = rend->entry[i];
+        e.face_pos = static_cast<uint16_t>(i * facesPer);
+        e.face_count = static_cast<uint16_t>(i + 1 == submeshes ? faceCount - e.face_pos : facesPer);
+        e.vertex_pos = 0;
+        e.vertex_count = static_cast<uint16_t>(vertexCount);
+        e.texture_diffuse_index = static_cast<int16_t>(i);
+    }
+
+    mefFile_t mef;
+    benchAddChunk(mef, MeshResourceType::MESH, mefResourcePtr(header.release()));
+    benchAddChunk(mef, MeshResourceType::VRTX, mefResourcePtr(vrtx.release()));
+    benchAddChunk(mef, MeshResourceType::FACE, mefResourcePtr(face.release()));
+    benchAddChunk(mef, MeshResourceType::REND, mefResourcePtr(rend.release()));
+    return mef.writeData(path);
+}
+
+// TEX header as read by texFile_t::read; image_type 2 is ARGB1555, 67 is ARGB8888
+bool benchWriteTex(const std::string& path, uint32_t size, int32_t imageType, std::mt19937& rng) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+    int16_t edge = static_cast<int16_t>(std::min<uint32_t>(size, 8192));
+    int16_t bytesPerPixel = imageType == 67 ? 4 : 2;
+    writeValue(f, int32_t(0x4C4F4F50)); // ident
+    writeValue(f, int32_t(11));         // version
+    writeValue(f, imageType);
+    writeValue(f, int32_t(0));          // overlayFlags
+    writeValue(f, int32_t(0));          // paletteOffset
+    writeValue(f, int16_t(1));          // scaleFactor
+    writeValue(f, edge);
+    writeValue(f, edge);
+    writeValue(f, edge);
+    writeValue(f, edge);
+    writeValue(f, bytesPerPixel);
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(edge) * edge * bytesPerPixel);
+    for (auto& p : pixels) {
+        p = static_cast<uint8_t>(rng());
+    }
+    f.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    return f.good();
+}
+
+// 32-bit run-length TGA (image type 10) with a mix of runs and raw packets
+bool benchWriteTga(const std::string& path, uint32_t size, std::mt19937& rng) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+    uint16_t edge = static_cast<uint16_t>(std::min<uint32_t>(size, 8192));
+    uint8_t header[18] = {0};
+    header[2] = 10;
+    header[12] = edge & 0xFF;
+    header[13] = edge >> 8;
+    header[14] = edge & 0xFF;
+    header[15] = edge >> 8;
+    header[16] = 32;
+    header[17] = 0x28;
+    f.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    size_t remaining = static_cast<size_t>(edge) * edge;
+    while (remaining > 0) {
+        uint8_t count = static_cast<uint8_t>(std::min<size_t>(remaining, 1 + rng() % 128));
+        bool run = (rng() & 1) != 0;
+        f.put(static_cast<char>((run ? 0x80 : 0x00) | (count - 1)));
+        for (uint32_t i = 0; i < (run ? 1u : count) * 4; ++i) {
+            f.put(static_cast<char>(rng()));
+        }
+        remaining -= count;
+    }
+    return f.good();
+}
+
+bool benchReadFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void benchWriteResChunk(std::ofstream& f, MeshResourceType type, const char* data, uint32_t size) {
+    const uint32_t align = 4;
+    writeValue(f, static_cast<uint32_t>(type));
+    writeValue(f, size);
+    writeValue(f, align);
+    writeValue(f, size);
+    f.write(data, size);
+    for (uint32_t i = 0; i < (align - (size % align)) % align; ++i) {
+        f.put('\0');
+    }
+}
+
+// IRES archive holding copies of the given files under their own names
+bool benchWriteRes(const std::string& path, const std::vector<std::string>& members) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+    writeValue(f, static_cast<uint32_t>(MeshResourceType::ILFF));
+    writeValue(f, uint32_t(0));
+    writeValue(f, uint32_t(4));
+    writeValue(f, uint32_t(0));
+    writeValue(f, static_cast<uint32_t>(MeshResourceType::IRES));
+
+    std::vector<char> body;
+    for (const std::string& member : members) {
+        if (!benchReadFile(member, body)) {
+            std::cerr << "Failed to read " << member << std::endl;
+            return false;
+        }
+        std::string name = std::filesystem::path(member).filename().string();
+        std::string dir = "LOCAL:bench/";
+        benchWriteResChunk(f, MeshResourceType::NAME, name.c_str(), static_cast<uint32_t>(name.size() + 1));
+        benchWriteResChunk(f, MeshResourceType::PATH, dir.c_str(), static_cast<uint32_t>(dir.size() + 1));
+        benchWriteResChunk(f, MeshResourceType::BODY, body.data(), static_cast<uint32_t>(body.size()));
+    }
+
+    // resFile_t counts the size from just after this field
+    uint32_t fileSize = static_cast<uint32_t>(f.tellp()) - 4;
+    f.seekp(4);
+    writeValue(f, fileSize);
+    return f.good();
+}
+
+void benchWriteBE(std::ofstream& f, uint32_t value) {
+    writeValue(f, swapEndian32(value));
+}
+
+void benchWriteStringTable(std::ofstream& f, MeshResourceType type, const std::vector<std::string>& names) {
+    uint32_t size = 4;
+    for (const auto& name : names) {
+        size += static_cast<uint32_t>(name.size() + 1);
+    }
+    benchWriteBE(f, static_cast<uint32_t>(type));
+    benchWriteBE(f, size);
+    writeValue(f, static_cast<uint32_t>(names.size()));
+    for (const auto& name : names) {
+        f.write(name.c_str(), name.size() + 1);
+    }
+}
+
+// Level table with MODS/TEXF name lists, an INST table and a GTT index table
+bool benchWriteMtp(const std::string& path, uint32_t models, std::mt19937& rng) {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+    std::vector<std::string> modelNames, textureNames;
+    for (uint32_t i = 0; i < models; ++i) {
+        modelNames.push_back("model_" + std::to_string(i) + ".mef");
+        textureNames.push_back("texture_" + std::to_string(i) + ".tex");
+    }
+
+    benchWriteBE(f, static_cast<uint32_t>(MeshResourceType::FORM));
+    benchWriteBE(f, 0);
+    benchWriteBE(f, static_cast<uint32_t>(MeshResourceType::MTP_));
+    benchWriteStringTable(f, MeshResourceType::MODS, modelNames);
+    benchWriteStringTable(f, MeshResourceType::TEXF, textureNames);
+
+    benchWriteBE(f, static_cast<uint32_t>(MeshResourceType::INST));
+    benchWriteBE(f, models * 16);
+    for (uint32_t i = 0; i < models; ++i) {
+        writeValue(f, i);
+        writeValue(f, uint32_t(2));
+        writeValue(f, i);
+        writeValue(f, static_cast<uint32_t>(rng() % models));
+    }
+
+    benchWriteBE(f, static_cast<uint32_t>(MeshResourceType::GTT_));
+    benchWriteBE(f, 4 + models * 8);
+    writeValue(f, models);
+    for (uint32_t i = 0; i < models; ++i) {
+        writeValue(f, i);
+        writeValue(f, int32_t(-1));
+    }
+
+    uint32_t formSize = static_cast<uint32_t>(f.tellp()) - 8;
+    f.seekp(4);
+    benchWriteBE(f, formSize);
+    return f.good();
+}
+
+struct benchCorpus_t {
+    std::string mef, res, mtp, tex1555, tex8888, tga;
+};
+
+bool benchGenerateCorpus(const benchOptions_t& opts, benchCorpus_t& corpus) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::create_directories(opts.corpusDir, ec);
+    if (ec) {
+        std::cerr << "Cannot create corpus directory: " << opts.corpusDir << std::endl;
+        return false;
+    }
+    fs::path dir(opts.corpusDir);
+    std::mt19937 rng(opts.seed);
+
+    corpus.mef = (dir / "model.mef").string();
+    corpus.tex1555 = (dir / "texture_1555.tex").string();
+    corpus.tex8888 = (dir / "texture_8888.tex").string();
+    corpus.tga = (dir / "texture_rle.tga").string();
+    corpus.mtp = (dir / "level.mtp").string();
+    corpus.res = (dir / "archive.res").string();
+
+    if (!benchWriteMef(corpus.mef, opts.vertices, rng) ||
+        !benchWriteTex(corpus.tex1555, opts.textureSize, 2, rng) ||
+        !benchWriteTex(corpus.tex8888, opts.textureSize, 67, rng) ||
+        !benchWriteTga(corpus.tga, opts.textureSize, rng) ||
+        !benchWriteMtp(corpus.mtp, opts.models, rng)) {
+        return false;
+    }
+
+    // The archive mixes models and textures of varying size
+    std::vector<std::string> members;
+    for (uint32_t i = 0; i < opts.models; ++i) {
+        std::string model = (dir / ("model_" + std::to_string(i) + ".mef")).string();
+        std::string texture = (dir / ("texture_" + std::to_string(i) + ".tex")).string();
+        if (!benchWriteMef(model, opts.vertices / 4 + rng() % (opts.vertices / 2 + 1), rng) ||
+            !benchWriteTex(texture, std::max<uint32_t>(16, opts.textureSize >> (i % 4)), (i & 1) ? 67 : 2, rng)) {
+            return false;
+        }
+        members.push_back(model);
+        members.push_back(texture);
+    }
+    bool result = benchWriteRes(corpus.res, members);
+    for (const auto& member : members) {
+        fs::remove(member, ec);
+    }
+    return result;
+}
+
+// Runs body once to warm up, then times opts.iterations runs of it
+template <typename Fn>
+benchResult_t benchRun(const std::string& name, size_t bytes, uint32_t iterations, Fn body) {
+    benchResult_t result{name, bytes, iterations, 0.0, 0};
+    if (!body()) {
+        std::cerr << "Benchmark " << name << " failed on its warm-up run" << std::endl;
+        result.iterations = 0;
+        return result;
+    }
+
+    size_t allocationsBefore = benchAllocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    auto end = std::chrono::steady_clock::now();
+    result.allocations = benchAllocations.load() - allocationsBefore;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+size_t benchFileSize(const std::string& path) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+// Inflates the IDAT data of png far enough to compare its first pixel with the image's, in the image's
+// channel order; that pixel is stored unfiltered whatever filter the first row uses, since its left and
+// upper neighbours are zero
+bool benchCheckPngPixel(const std::vector<uint8_t>& png, const tgaFile_t& image) {
+    std::vector<uint8_t> idat;
+    for (size_t pos = 8; pos + 12 <= png.size();) {
+        size_t length = (size_t(png[pos]) << 24) | (png[pos + 1] << 16) | (png[pos + 2] << 8) | png[pos + 3];
+        if (pos + 12 + length > png.size()) {
+            return false;
+        }
+        if (std::memcmp(&png[pos + 4], "IDAT", 4) == 0) {
+            idat.insert(idat.end(), &png[pos + 8], &png[pos + 8] + length);
+        }
+        pos += 12 + length;
+    }
+    uint8_t row[5] = {};
+    z_stream zs = {};
+    if (idat.empty() || inflateInit(&zs) != Z_OK) {
+        return false;
+    }
+    zs.next_in = idat.data();
+    zs.avail_in = static_cast<uInt>(idat.size());
+    zs.next_out = row;
+    zs.avail_out = sizeof(row);
+    inflate(&zs, Z_SYNC_FLUSH);
+    inflateEnd(&zs);
+    const uint8_t* pixel = image.image_data.data();
+    int red = image.bgr ? 2 : 0;
+    return zs.avail_out == 0 && row[1] == pixel[red] && row[2] == pixel[1] && row[3] == pixel[2 - red] && row[4] == pixel[3];
+}
+
+void printBenchUsage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [options]\n"
+              << "  --corpus <dir>    Where the synthetic corpus is written (default: temp dir)\n"
+              << "  --vertices <n>    Vertices per synthetic model (default: 20000)\n"
+              << "  --texture <n>     Edge length of synthetic textures (default: 512)\n"
+              << "  --models <n>      Models and textures in the synthetic RES (default: 16)\n"
+              << "  -n <n>            Timed iterations per benchmark (default: 20)\n"
+              << "  --seed <n>        Corpus random seed (default: 1234)\n";
+}
+
+int runBenchmark(int argc, char* argv[]) {
+    benchOptions_t opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--corpus" && hasValue) {
+            opts.corpusDir = argv[++i];
+        } else if (arg == "--vertices" && hasValue) {
+            opts.vertices = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--texture" && hasValue) {
+            opts.textureSize = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--models" && hasValue) {
+            opts.models = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-n" && hasValue) {
+            opts.iterations = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            printBenchUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        }
+    }
+    if (opts.corpusDir.empty()) {
+        opts.corpusDir = (std::filesystem::temp_directory_path() / "mefview_bench").string();
+    }
+    opts.iterations = std::max<uint32_t>(1, opts.iterations);
+    opts.models = std::max<uint32_t>(1, opts.models);
+    opts.textureSize = std::max<uint32_t>(16, opts.textureSize);
+
+    benchCorpus_t corpus;
+    if (!benchGenerateCorpus(opts, corpus)) {
+        return 1;
+    }
+    std::cout << "Corpus: " << opts.corpusDir << " (seed " << opts.seed << ")\n";
+    std::cout << "Pixel kernels: " << pixelKernelName() << "\n";
+    std::cout << "Checksum kernels: " << checksumKernelName() << "\n";
+
+    // Parsers read from mapped views, so map each input once up front
+    mappedFile_t mefMap, mtpMap, tex1555Map, tex8888Map, tgaMap;
+    if (!mefMap.open(corpus.mef) || !mtpMap.open(corpus.mtp) || !tex1555Map.open(corpus.tex1555) ||
+        !tex8888Map.open(corpus.tex8888) || !tgaMap.open(corpus.tga)) {
+        return 1;
+    }
+
+    tgaFile_t image;
+    if (!image.read(tgaMap.data(), tgaMap.size())) {
+        return 1;
+    }
+    size_t imageBytes = image.image_data.size();
+
+    std::vector<benchResult_t> results;
+    results.push_back(benchRun("mefFile_t::readData", mefMap.size(), opts.iterations, [&] {
+        byteStream_t f(mefMap);
+        mefFile_t mef;
+        return mef.readData(f);
+    }));
+    mefFile_t parsedMef;
+    byteStream_t parsedStream(mefMap);
+    if (!parsedMef.readData(parsedStream)) {
+        return 1;
+    }
+    results.push_back(benchRun("mefFile_t::writeData", mefMap.size(), opts.iterations, [&] {
+        byteWriter_t out;
+        parsedMef.writeData(out);
+        return out.size() == mefMap.size() && std::memcmp(out.data(), mefMap.data(), out.size()) == 0;
+    }));
+    results.push_back(benchRun("resFile_t::read", benchFileSize(corpus.res), opts.iterations, [&] {
+        resFile_t res;
+        return res.read(corpus.res);
+    }));
+    results.push_back(benchRun("mtpFile_t::read", mtpMap.size(), opts.iterations, [&] {
+        byteStream_t f(mtpMap);
+        mtpFile_t mtp;
+        return mtp.read(f);
+    }));
+    results.push_back(benchRun("texFile_t::read 8888", tex8888Map.size(), opts.iterations, [&] {
+        byteStream_t f(tex8888Map);
+        texFile_t tex;
+        return tex.read(f, false);
+    }));
+    results.push_back(benchRun("texFile_t::read 1555", tex1555Map.size(), opts.iterations, [&] {
+        byteStream_t f(tex1555Map);
+        texFile_t tex;
+        return tex.read(f, false); // Includes the 1555 to 8888 conversion
+    }));
+    texFile_t tex1555;
+    byteStream_t tex1555Stream(tex1555Map);
+    if (!tex1555.read(tex1555Stream, false)) {
+        return 1;
+    }
+    size_t pixelCount = static_cast<size_t>(tex1555.width) * tex1555.height;
+    std::vector<uint8_t> pixels16(pixelCount * 2), pixels32(pixelCount * 4);
+    // The synthetic TEX ends with its 16-bit pixels
+    std::memcpy(pixels16.data(), tex1555Map.data() + tex1555Map.size() - pixels16.size(), pixels16.size());
+    results.push_back(benchRun("pixelConvert1555To8888", pixels16.size(), opts.iterations, [&] {
+        pixelConvert1555To8888(pixels16.data(), pixels32.data(), pixelCount, pixelOrder_t::RGBA);
+        return true;
+    }));
+    results.push_back(benchRun("pixelSwapRB32", pixels32.size(), opts.iterations, [&] {
+        pixelSwapRB32(pixels32.data(), pixelCount);
+        return true;
+    }));
+    results.push_back(benchRun("pixelFlipRows", pixels32.size(), opts.iterations, [&] {
+        pixelFlipRows(pixels32.data(), static_cast<size_t>(tex1555.width) * 4, tex1555.height);
+        return true;
+    }));
+    results.push_back(benchRun("tgaFile_t::read RLE", tgaMap.size(), opts.iterations, [&] {
+        tgaFile_t tga;
+        return tga.read(tgaMap.data(), tgaMap.size());
+    }));
+    size_t rleBytes = 0;
+    results.push_back(benchRun("tgaFile_t::write RLE", imageBytes, opts.iterations, [&] {
+        std::vector<uint8_t> rle;
+        bool ok = image.write(rle, true);
+        rleBytes = rle.size();
+        return ok;
+    }));
+    std::cout << "tgaFile_t::write RLE: " << rleBytes << " bytes\n";
+    // The same image cut down to 256 colors comes back as a color-mapped (type 9) file
+    tgaFile_t quantized(image);
+    for (size_t i = 0; i + 3 < quantized.image_data.size(); i += 4) {
+        quantized.image_data[i] &= 0xE0;
+        quantized.image_data[i + 1] &= 0xE0;
+        quantized.image_data[i + 2] &= 0xC0;
+        quantized.image_data[i + 3] = 0xFF;
+    }
+    std::vector<uint8_t> mappedTga;
+    if (!quantized.write(mappedTga, true)) {
+        return 1;
+    }
+    results.push_back(benchRun("tgaFile_t::read RLE mapped", mappedTga.size(), opts.iterations, [&] {
+        tgaFile_t tga;
+        return tga.read(mappedTga.data(), mappedTga.size());
+    }));
+    uint32_t checksum = 0;
+    results.push_back(benchRun("checksumCrc32", imageBytes, opts.iterations, [&] {
+        checksum ^= checksumCrc32(0, image.image_data.data(), imageBytes);
+        return true;
+    }));
+    results.push_back(benchRun("checksumAdler32", imageBytes, opts.iterations, [&] {
+        checksum ^= checksumAdler32(1, image.image_data.data(), imageBytes);
+        return true;
+    }));
+    for (pngLevel_t level : { pngLevel_t::Fast, pngLevel_t::Default, pngLevel_t::Small }) {
+        std::string name = std::string("writeAsPNG ") + pngLevelName(level);
+        size_t pngBytes = 0;
+        results.push_back(benchRun(name, imageBytes, opts.iterations, [&] {
+            std::vector<uint8_t> png;
+            bool ok = image.writeAsPNG(png, false, false, level);
+            pngBytes = png.size();
+            return ok;
+        }));
+        std::cout << name << ": " << pngBytes << " bytes\n";
+    }
+    // Both channel orders: the TGA image is BGRA, the one converted from TEX is RGBA
+    tgaFile_t texImage;
+    std::vector<uint8_t> checkPng, checkTexPng;
+    if (!tex1555.toTga(texImage) || !image.writeAsPNG(checkPng) || !benchCheckPngPixel(checkPng, image) ||
+        !texImage.writeAsPNG(checkTexPng) || !benchCheckPngPixel(checkTexPng, texImage)) {
+        std::cerr << "writeAsPNG: first pixel is not the image's first pixel in RGBA order" << std::endl;
+        return 1;
+    }
+    threadPool_t& pool = threadPool_t::shared();
+    std::string parallelName = "writeAsPNG default x" + std::to_string(pool.size());
+    results.push_back(benchRun(parallelName, imageBytes, opts.iterations, [&] {
+        std::vector<uint8_t> png;
+        return image.writeAsPNG(png, false, false, pngLevel_t::Default, &pool);
+    }));
+    logFlush(std::cerr);
+
+    std::cout << std::left << std::setw(26) << "benchmark"
+              << std::right << std::setw(12) << "input KB"
+              << std::setw(12) << "ms/file"
+              << std::setw(12) << "MB/s"
+              << std::setw(14) << "allocs/file" << "\n";
+    int status = 0;
+    for (const auto& r : results) {
+        if (r.iterations == 0) {
+            std::cout << std::left << std::setw(26) << r.name << std::right << std::setw(12) << "FAILED" << "\n";
+            status = 1;
+            continue;
+        }
+        double perFile = r.seconds / r.iterations;
+        std::cout << std::left << std::setw(26) << r.name << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(1) << r.bytes / 1024.0
+                  << std::setw(12) << std::setprecision(3) << perFile * 1000.0
+                  << std::setw(12) << std::setprecision(1) << (perFile > 0.0 ? r.bytes / perFile / (1024.0 * 1024.0) : 0.0)
+                  << std::setw(14) << r.allocations / r.iterations << "\n";
+    }
+    return status;
+}
+#endif // MEFVIEW_BENCHMARK
+
 int main(int argc, char *argv[]) {
+    // Log level and categories for every mode, e.g. MEFVIEW_LOG=info,mesh
+    if (const char* logSetting = std::getenv("MEFVIEW_LOG")) {
+        if (!logConfigure(logSetting)) {
+            std::cerr << "Ignoring MEFVIEW_LOG, unknown level or category: " << logSetting << std::endl;
+        }
+    }
+
+#if defined(MEFVIEW_BENCHMARK)
+    return runBenchmark(argc, argv);
+#elif defined(MEFVIEW_HEADLESS)
+    return runBatch(argc, argv);
+#else
+    if (argc > 1 && std::strcmp(argv[1], "--first-frame") == 0) {
+        return runFirstFrame(argc, argv);
+    }
+
+    // Any other option switches to the batch tool instead of opening a window
+    if (argc > 1 && argv[1][0] == '-') {
+        return runBatch(argc, argv);
+    }
+
     std::string filename;
 
     if (argc < 2) {
@@ -6384,4 +8157,5 @@ int main(int argc, char *argv[]) {
 
     // Proceed with determining the file type
     return determineFileType(filename.c_str());
+#endif // MEFVIEW_HEADLESS
 }
@@ -0,0 +1,300 @@
+#include "checksum.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CHECKSUM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile each SIMD version for its own instruction set; MSVC needs no flag
+#if defined(__GNUC__) || defined(__clang__)
+#define CHECKSUM_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CHECKSUM_TARGET(isa)
+#endif
+
+namespace {
+
+const uint32_t ADLER_MOD = 65521;
+
+// Largest run of bytes whose sums cannot overflow 32 bits before the modulo
+const size_t ADLER_NMAX = 5552;
+
+struct checksumKernels_t {
+    const char* name;
+    uint32_t (*crc32)(uint32_t, const uint8_t*, size_t);
+    uint32_t (*adler32)(uint32_t, const uint8_t*, size_t);
+};
+
+// Slicing-by-8 tables for the reflected polynomial 0xEDB88320: table[k][n] is
+// the CRC of byte n followed by k zero bytes
+struct crcTables_t {
+    uint32_t table[8][256];
+};
+
+constexpr crcTables_t makeCrcTables() {
+    crcTables_t tables{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        tables.table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+        for (int k = 1; k < 8; ++k) {
+            uint32_t c = tables.table[k - 1][n];
+            tables.table[k][n] = (c >> 8) ^ tables.table[0][c & 0xFF];
+        }
+    }
+    return tables;
+}
+
+// Built by the compiler, so there is no first-use initialisation to race on
+constexpr crcTables_t crcTables = makeCrcTables();
+
+inline uint32_t load32le(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint32_t crc32Slice8(uint32_t crc, const uint8_t* data, size_t size) {
+    const auto& t = crcTables.table;
+    crc = ~crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint32_t lo = load32le(data) ^ crc;
+        uint32_t hi = load32le(data + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    for (; size > 0; ++data, --size) {
+        crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t adler32Scalar(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        size_t n = std::min(size, ADLER_NMAX);
+        size -= n;
+        for (; n >= 4; n -= 4, data += 4) {
+            a += data[0];
+            b += a;
+            a += data[1];
+            b += a;
+            a += data[2];
+            b += a;
+            a += data[3];
+            b += a;
+        }
+        for (; n > 0; --n, ++data) {
+            a += *data;
+            b += a;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+    return (b << 16) | a;
+}
+
+const checksumKernels_t scalarKernels = { "scalar", crc32Slice8, adler32Scalar };
+
+#ifdef CHECKSUM_X86
+
+CHECKSUM_TARGET("sse2") inline uint32_t horizontalSum32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+}
+
+/**
+ * Per 16-byte block, a grows by the byte sum and b by 16 * a plus the bytes
+ * weighted 16..1. The sums of a at the start of each block are collected in
+ * prefix, so the scalar state is only updated once per run.
+ */
+CHECKSUM_TARGET("sse2") uint32_t adler32Sse2(uint32_t adler, const uint8_t* data, size_t size) {
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i weightsLo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i weightsHi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    while (size >= 16) {
+        size_t blocks = std::min(size, ADLER_NMAX) / 16;
+        size -= blocks * 16;
+        __m128i sum = zero;
+        __m128i weighted = zero;
+        __m128i prefix = zero;
+        for (size_t k = 0; k < blocks; ++k, data += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            prefix = _mm_add_epi32(prefix, sum);
+            sum = _mm_add_epi32(sum, _mm_sad_epu8(v, zero));
+            weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weightsLo));
+            weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weightsHi));
+        }
+        uint64_t newB = b + 16ull * blocks * a + 16ull * horizontalSum32(prefix) + horizontalSum32(weighted);
+        b = static_cast<uint32_t>(newB % ADLER_MOD);
+        a = (a + horizontalSum32(sum)) % ADLER_MOD;
+    }
+    return adler32Scalar((b << 16) | a, data, size);
+}
+
+/**
+ * Folds 64-byte blocks into four 128-bit lanes with carry-less multiplies,
+ * then folds those to one lane and Barrett-reduces it to 32 bits (Intel,
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ").
+ * size must be at least 64 and a multiple of 16; crc is the raw, inverted
+ * register value.
+ */
+CHECKSUM_TARGET("sse2,pclmul") uint32_t crc32FoldPclmul(const uint8_t* data, size_t size, uint32_t crc) {
+    alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    data += 64;
+    size -= 64;
+
+    for (; size >= 64; data += 64, size -= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+    }
+
+    // Fold the four lanes into one
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x4), x5);
+
+    for (; size >= 16; data += 16, size -= 16) {
+        x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+    }
+
+    // 128 to 64 bits
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2);
+
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+uint32_t crc32Pclmul(uint32_t crc, const uint8_t* data, size_t size) {
+    if (size >= 64) {
+        size_t folded = size & ~static_cast<size_t>(15);
+        crc = ~crc32FoldPclmul(data, folded, ~crc);
+        data += folded;
+        size -= folded;
+    }
+    return crc32Slice8(crc, data, size);
+}
+
+const checksumKernels_t sse2Kernels = { "sse2", crc32Slice8, adler32Sse2 };
+const checksumKernels_t pclmulKernels = { "pclmul", crc32Pclmul, adler32Sse2 };
+
+bool cpuHasSse2() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasPclmul() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 1)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul");
+#endif
+}
+
+#endif // CHECKSUM_X86
+
+const checksumKernels_t& selectKernels() {
+    std::string limit;
+    if (const char* env = std::getenv("MEFVIEW_SIMD")) {
+        limit = env;
+    }
+    if (limit == "scalar") {
+        return scalarKernels;
+    }
+#ifdef CHECKSUM_X86
+    if (cpuHasSse2()) {
+        return limit != "sse2" && cpuHasPclmul() ? pclmulKernels : sse2Kernels;
+    }
+#endif
+    return scalarKernels;
+}
+
+const checksumKernels_t& kernels() {
+    static const checksumKernels_t& selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+const char* checksumKernelName() {
+    return kernels().name;
+}
+
+uint32_t checksumCrc32(uint32_t crc, const uint8_t* data, size_t size) {
+    return kernels().crc32(crc, data, size);
+}
+
+uint32_t checksumAdler32(uint32_t adler, const uint8_t* data, size_t size) {
+    return kernels().adler32(adler, data, size);
+}
+
+uint32_t checksumAdler32Combine(uint32_t adler1, uint32_t adler2, uint64_t size2) {
+    uint64_t rem = size2 % ADLER_MOD;
+    uint64_t a1 = adler1 & 0xFFFF;
+    uint64_t b1 = adler1 >> 16;
+    uint64_t a2 = adler2 & 0xFFFF;
+    uint64_t b2 = adler2 >> 16;
+    // The second range's b also counts a1 once for each of its bytes
+    uint64_t a = (a1 + a2 + ADLER_MOD - 1) % ADLER_MOD;
+    uint64_t b = (rem * a1 + b1 + b2 + ADLER_MOD - rem) % ADLER_MOD;
+    return static_cast<uint32_t>((b << 16) | a);
+}
@@ -0,0 +1,405 @@
+#include "geomcache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t GEOMCACHE_MAGIC = 0x43454F47;  // 'GEOC'
+
+// Bump whenever the geometry built from a BODY changes (scale, axis swap, layout)
+const uint32_t GEOMCACHE_VERSION = 2;
+
+const size_t GEOMCACHE_ALIGN = 16;
+
+struct geomCacheHeader_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t vertex_stride;     // sizeof(geomCacheVertex_t) at write time
+    uint32_t vertex_count;
+    uint32_t material_count;
+    uint32_t index_count;       // Summed over all materials
+    uint64_t material_offset;   // geomCacheMaterialRecord_t[material_count]
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t file_size;
+    float bounds_min[3];
+    float bounds_max[3];
+};
+
+struct geomCacheMaterialRecord_t {
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t name_offset;       // From the start of the file
+    uint32_t name_length;
+};
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t mixWord(uint64_t word) {
+    word *= 0xC2B2AE3D27D4EB4Full;
+    word = rotl64(word, 31);
+    return word * 0x9E3779B185EBCA87ull;
+}
+
+std::string withTrailingSlash(std::string path) {
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') {
+        path += '/';
+    }
+    return path;
+}
+
+bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// Creates every missing directory along path
+bool makeDirectories(const std::string& path) {
+    for (size_t pos = 1; pos < path.size(); ++pos) {
+        if ((path[pos] == '/' || path[pos] == '\\') && path[pos - 1] != ':') {
+            if (!makeDirectory(path.substr(0, pos))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Bounding box of the positions; all zero without vertices
+void vertexBounds(const geomCacheVertex_t* vertices, size_t count, float* boundsMin, float* boundsMax) {
+    for (int k = 0; k < 3; ++k) {
+        boundsMin[k] = count ? vertices[0].position[k] : 0.0f;
+        boundsMax[k] = boundsMin[k];
+    }
+    for (size_t i = 1; i < count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            boundsMin[k] = std::min(boundsMin[k], vertices[i].position[k]);
+            boundsMax[k] = std::max(boundsMax[k], vertices[i].position[k]);
+        }
+    }
+}
+
+// Name to write path's contents under before the rename; unique per process and call,
+// so viewers storing the same key at once never write into each other's file
+std::string temporaryPath(const std::string& path) {
+    static std::atomic<unsigned> counter(0);
+#ifdef _WIN32
+    unsigned long pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%lu.%u.tmp", pid, counter++);
+    return path + suffix;
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+} // namespace
+
+void geomInterleave(const float* positions, const float* normals, const float* colors, const float* texcoords, const int* faces, size_t faceCount, const int* faceMaterials, size_t materialCount, std::vector<geomCacheVertex_t>& interleaved, std::vector<std::vector<uint32_t>>& materialIndices) {
+    interleaved.resize(faceCount * 3);
+    for (size_t corner = 0; corner < faceCount * 3; ++corner) {
+        size_t index = static_cast<size_t>(faces[corner]);
+        geomCacheVertex_t& vertex = interleaved[corner];
+        for (int k = 0; k < 3; ++k) {
+            vertex.position[k] = positions[index * 3 + k];
+            vertex.normal[k] = normals[index * 3 + k];
+            vertex.color[k] = colors ? colors[index * 3 + k] : 1.0f;
+        }
+        vertex.texcoord[0] = texcoords[index * 2];
+        vertex.texcoord[1] = texcoords[index * 2 + 1];
+    }
+
+    materialIndices.assign(materialCount, std::vector<uint32_t>());
+    for (size_t f = 0; f < faceCount; ++f) {
+        int material = faceMaterials[f];
+        if (material >= 0 && static_cast<size_t>(material) < materialCount) {
+            uint32_t baseIndex = static_cast<uint32_t>(f * 3);
+            materialIndices[material].push_back(baseIndex);
+            materialIndices[material].push_back(baseIndex + 1);
+            materialIndices[material].push_back(baseIndex + 2);
+        }
+    }
+}
+
+uint64_t geomCacheHash(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull ^ (static_cast<uint64_t>(size) * 0x9E3779B185EBCA87ull);
+    size_t pos = 0;
+    for (; pos + 8 <= size; pos += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + pos, 8);
+        hash ^= mixWord(word);
+        hash = rotl64(hash, 27) * 0x9E3779B185EBCA87ull + 0x85EBCA77C2B2AE63ull;
+    }
+    if (pos < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + pos, size - pos);
+        hash ^= mixWord(word);
+    }
+
+    // Final avalanche so nearby inputs spread over the whole key
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+std::string geomCacheDirectory() {
+    const char* configured = std::getenv("MEFVIEW_CACHE_DIR");
+    if (configured != nullptr) {
+        return *configured ? withTrailingSlash(configured) : std::string();
+    }
+#ifdef _WIN32
+    const char* local = std::getenv("LOCALAPPDATA");
+    if (local != nullptr && *local) {
+        return std::string(local) + "\\mefview\\geometry\\";
+    }
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg != nullptr && *xdg) {
+        return withTrailingSlash(xdg) + "mefview/geometry/";
+    }
+    const char* home = std::getenv("HOME");
+    if (home != nullptr && *home) {
+        return withTrailingSlash(home) + ".cache/mefview/geometry/";
+    }
+#endif
+    return "mefview_cache/geometry/";
+}
+
+std::string geomCachePath(uint64_t key) {
+    std::string directory = geomCacheDirectory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.geo", static_cast<unsigned long long>(key));
+    return directory + name;
+}
+
+bool geomCacheStore(const std::string& path, uint64_t key, const std::vector<geomCacheVertex_t>& vertices, const std::vector<std::vector<uint32_t>>& materialIndices, const std::vector<std::string>& textures) {
+    if (path.empty() || materialIndices.size() != textures.size()) {
+        return false;
+    }
+
+    geomCacheHeader_t header = {};
+    header.magic = GEOMCACHE_MAGIC;
+    header.version = GEOMCACHE_VERSION;
+    header.key = key;
+    header.vertex_stride = sizeof(geomCacheVertex_t);
+    header.vertex_count = static_cast<uint32_t>(vertices.size());
+    header.material_count = static_cast<uint32_t>(textures.size());
+    vertexBounds(vertices.data(), vertices.size(), header.bounds_min, header.bounds_max);
+
+    size_t indexTotal = 0;
+    for (const auto& indices : materialIndices) {
+        indexTotal += indices.size();
+    }
+    header.index_count = static_cast<uint32_t>(indexTotal);
+
+    byteWriter_t out;
+    out.reserve(sizeof(header) + textures.size() * 64 + vertices.size() * sizeof(geomCacheVertex_t) + indexTotal * sizeof(uint32_t) + 3 * GEOMCACHE_ALIGN);
+    out.append(sizeof(header));
+
+    // Material table, then the names it points at
+    header.material_offset = out.tellp();
+    size_t recordsAt = out.tellp();
+    out.append(textures.size() * sizeof(geomCacheMaterialRecord_t));
+    uint32_t firstIndex = 0;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        geomCacheMaterialRecord_t record;
+        record.first_index = firstIndex;
+        record.index_count = static_cast<uint32_t>(materialIndices[i].size());
+        record.name_offset = static_cast<uint32_t>(out.tellp());
+        record.name_length = static_cast<uint32_t>(textures[i].size());
+        out.write(textures[i].data(), textures[i].size());
+        out.patch(recordsAt + i * sizeof(record), &record, sizeof(record));
+        firstIndex += record.index_count;
+    }
+
+    // Bulk arrays start on aligned offsets so the mapped pointers are too
+    out.pad(0, GEOMCACHE_ALIGN);
+    header.vertex_offset = out.tellp();
+    if (!vertices.empty()) {
+        std::memcpy(out.append(vertices.size() * sizeof(geomCacheVertex_t)), vertices.data(), vertices.size() * sizeof(geomCacheVertex_t));
+    }
+
+    out.pad(0, GEOMCACHE_ALIGN);
+    header.index_offset = out.tellp();
+    for (const auto& indices : materialIndices) {
+        if (!indices.empty()) {
+            std::memcpy(out.append(indices.size() * sizeof(uint32_t)), indices.data(), indices.size() * sizeof(uint32_t));
+        }
+    }
+
+    header.file_size = out.tellp();
+    out.patch(0, &header, sizeof(header));
+
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos && !makeDirectories(path.substr(0, slash + 1))) {
+        std::cerr << "Failed to create cache directory for: " << path << std::endl;
+        return false;
+    }
+
+    std::string temporary = temporaryPath(path);
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file for writing: " << temporary << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        if (!file) {
+            std::cerr << "Failed to write file: " << temporary << std::endl;
+            file.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    if (!replaceFile(temporary, path)) {
+        std::cerr << "Failed to move cache entry into place: " << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool geomCacheProbe(const std::string& path, uint64_t key) {
+    if (path.empty()) {
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    geomCacheHeader_t header;
+    if (size < sizeof(header) || !in.seekg(0) || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    return header.magic == GEOMCACHE_MAGIC && header.version == GEOMCACHE_VERSION && header.key == key
+        && header.vertex_stride == sizeof(geomCacheVertex_t) && header.file_size == size;
+}
+
+bool geomCacheEntry_t::open(const std::string& path, uint64_t key) {
+    close();
+    if (path.empty()) {
+        return false;
+    }
+
+    // A miss is the common case; probe first so mappedFile_t does not report it
+    if (!std::ifstream(path, std::ios::binary).is_open() || !file.open(path)) {
+        return false;
+    }
+
+    geomCacheHeader_t header;
+    if (file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    const uint64_t size = file.size();
+    const uint64_t vertexBytes = static_cast<uint64_t>(header.vertex_count) * sizeof(geomCacheVertex_t);
+    const uint64_t indexBytes = static_cast<uint64_t>(header.index_count) * sizeof(uint32_t);
+    const uint64_t recordBytes = static_cast<uint64_t>(header.material_count) * sizeof(geomCacheMaterialRecord_t);
+    if (header.magic != GEOMCACHE_MAGIC || header.version != GEOMCACHE_VERSION || header.key != key
+        || header.vertex_stride != sizeof(geomCacheVertex_t) || header.file_size != size
+        || header.material_offset > size || recordBytes > size - header.material_offset
+        || header.vertex_offset > size || vertexBytes > size - header.vertex_offset
+        || header.index_offset > size || indexBytes > size - header.index_offset
+        || header.vertex_offset % GEOMCACHE_ALIGN != 0 || header.index_offset % GEOMCACHE_ALIGN != 0) {
+        close();
+        return false;
+    }
+
+    ranges.resize(header.material_count);
+    textures.resize(header.material_count);
+    for (size_t i = 0; i < header.material_count; ++i) {
+        geomCacheMaterialRecord_t record;
+        std::memcpy(&record, file.data() + header.material_offset + i * sizeof(record), sizeof(record));
+        if (record.name_offset > size || record.name_length > size - record.name_offset
+            || record.first_index > header.index_count || record.index_count > header.index_count - record.first_index) {
+            close();
+            return false;
+        }
+        ranges[i] = std::make_pair(static_cast<size_t>(record.first_index), static_cast<size_t>(record.index_count));
+        textures[i].assign(reinterpret_cast<const char*>(file.data()) + record.name_offset, record.name_length);
+    }
+
+    // Every index must land inside the vertex buffer before it reaches the GPU
+    const uint32_t* indices = reinterpret_cast<const uint32_t*>(file.data() + header.index_offset);
+    for (size_t i = 0; i < header.index_count; ++i) {
+        if (indices[i] >= header.vertex_count) {
+            close();
+            return false;
+        }
+    }
+
+    vertex_data = reinterpret_cast<const geomCacheVertex_t*>(file.data() + header.vertex_offset);
+    index_data = indices;
+    vertex_count = header.vertex_count;
+    std::memcpy(bounds_min, header.bounds_min, sizeof(bounds_min));
+    std::memcpy(bounds_max, header.bounds_max, sizeof(bounds_max));
+    return true;
+}
+
+void geomCacheEntry_t::assign(std::vector<geomCacheVertex_t>&& vertices, const std::vector<std::vector<uint32_t>>& materialIndices, const std::vector<std::string>& materialTextures) {
+    close();
+    owned_vertices = std::move(vertices);
+    for (size_t i = 0; i < materialIndices.size(); ++i) {
+        ranges.push_back(std::make_pair(owned_indices.size(), materialIndices[i].size()));
+        owned_indices.insert(owned_indices.end(), materialIndices[i].begin(), materialIndices[i].end());
+    }
+    textures = materialTextures;
+    textures.resize(ranges.size());
+    vertex_data = owned_vertices.data();
+    index_data = owned_indices.data();
+    vertex_count = owned_vertices.size();
+    vertexBounds(vertex_data, vertex_count, bounds_min, bounds_max);
+}
+
+void geomCacheEntry_t::close() {
+    file.close();
+    owned_vertices.clear();
+    owned_indices.clear();
+    vertex_data = nullptr;
+    index_data = nullptr;
+    vertex_count = 0;
+    ranges.clear();
+    textures.clear();
+    std::fill(bounds_min, bounds_min + 3, 0.0f);
+    std::fill(bounds_max, bounds_max + 3, 0.0f);
+}
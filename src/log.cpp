@@ -0,0 +1,197 @@
+#include "log.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+std::atomic<int> logMinLevel(static_cast<int>(logLevel_t::Info));
+std::atomic<unsigned> logCategoryMask(~0u);
+
+namespace {
+
+const char* levelName(logLevel_t level) {
+    switch (level) {
+        case logLevel_t::Debug: return "debug";
+        case logLevel_t::Info: return "info";
+        case logLevel_t::Warning: return "warning";
+        case logLevel_t::Error: return "error";
+        default: return "";
+    }
+}
+
+const char* categoryName(logCategory_t category) {
+    switch (category) {
+        case logCategory_t::General: return "general";
+        case logCategory_t::Mesh: return "mesh";
+        case logCategory_t::Texture: return "texture";
+        case logCategory_t::Archive: return "archive";
+        case logCategory_t::Mtp: return "mtp";
+        case logCategory_t::Render: return "render";
+        default: return "";
+    }
+}
+
+constexpr size_t RING_SLOTS = 1024;  // must be a power of two
+constexpr size_t RING_TEXT = 256;
+
+struct ringSlot_t {
+    std::atomic<size_t> sequence;
+    logCategory_t category;
+    uint16_t length;
+    char text[RING_TEXT];
+};
+
+// Bounded multi-producer queue; each slot's sequence number tells producers and
+// the consumer whether it is free, filled, or still being written.
+struct warningRing_t {
+    std::array<ringSlot_t, RING_SLOTS> slots;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+
+    warningRing_t() : head(0), tail(0), dropped(0) {
+        for (size_t i = 0; i < RING_SLOTS; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void push(logCategory_t category, const std::string& message) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        ringSlot_t* slot;
+        for (;;) {
+            slot = &slots[pos & (RING_SLOTS - 1)];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        size_t length = std::min(message.size(), RING_TEXT);
+        std::memcpy(slot->text, message.data(), length);
+        slot->length = static_cast<uint16_t>(length);
+        slot->category = category;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    bool pop(std::ostream& out) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        ringSlot_t& slot = slots[pos & (RING_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        head.store(pos + 1, std::memory_order_relaxed);
+
+        out << "[warning][" << categoryName(slot.category) << "] ";
+        out.write(slot.text, slot.length);
+        out << '\n';
+        slot.sequence.store(pos + RING_SLOTS, std::memory_order_release);
+        return true;
+    }
+};
+
+warningRing_t& warningRing() {
+    static warningRing_t ring;
+    return ring;
+}
+
+std::mutex consoleMutex;
+std::mutex flushMutex;
+
+} // namespace
+
+void logSetLevel(logLevel_t level) {
+    logMinLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void logSetCategory(logCategory_t category, bool enabled) {
+    unsigned bit = 1u << static_cast<int>(category);
+    if (enabled) {
+        logCategoryMask.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        logCategoryMask.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+bool logConfigure(const std::string& setting) {
+    int level = logMinLevel.load(std::memory_order_relaxed);
+    unsigned categories = 0;
+    size_t begin = 0;
+    while (begin <= setting.size()) {
+        size_t end = std::min(setting.find(',', begin), setting.size());
+        std::string name = setting.substr(begin, end - begin);
+        begin = end + 1;
+        if (name.empty()) {
+            continue;
+        }
+
+        bool known = false;
+        for (int l = static_cast<int>(logLevel_t::Debug); l <= static_cast<int>(logLevel_t::Off) && !known; ++l) {
+            const char* candidate = l == static_cast<int>(logLevel_t::Off) ? "off" : levelName(static_cast<logLevel_t>(l));
+            if (name == candidate) {
+                level = l;
+                known = true;
+            }
+        }
+        for (int c = 0; c < static_cast<int>(logCategory_t::Count) && !known; ++c) {
+            if (name == categoryName(static_cast<logCategory_t>(c))) {
+                categories |= 1u << c;
+                known = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+
+    logSetLevel(static_cast<logLevel_t>(level));
+    for (int c = 0; c < static_cast<int>(logCategory_t::Count); ++c) {
+        logSetCategory(static_cast<logCategory_t>(c), categories == 0 || (categories & (1u << c)) != 0);
+    }
+    return true;
+}
+
+void logWrite(logLevel_t level, logCategory_t category, const std::string& message) {
+    if (level == logLevel_t::Warning) {
+        warningRing().push(category, message);
+        return;
+    }
+
+    std::ostream& out = (level == logLevel_t::Error) ? std::cerr : std::cout;
+    std::lock_guard<std::mutex> lock(consoleMutex);
+    if (level != logLevel_t::Info) {
+        out << "[" << levelName(level) << "][" << categoryName(category) << "] ";
+    }
+    out << message << '\n';
+}
+
+size_t logFlush(std::ostream& out) {
+    // Only one consumer may drain the ring at a time
+    std::lock_guard<std::mutex> lock(flushMutex);
+    warningRing_t& ring = warningRing();
+    size_t count = 0;
+    while (ring.pop(out)) {
+        count++;
+    }
+
+    size_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        out << "[warning] " << dropped << " further warnings were dropped" << '\n';
+    }
+    out.flush();
+    return count;
+}
+
+size_t logDropped() {
+    return warningRing().dropped.load(std::memory_order_relaxed);
+}
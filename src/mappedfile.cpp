@@ -0,0 +1,127 @@
+#include "mappedfile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+mappedFile_t::mappedFile_t() : view(nullptr), length(0), hFile(INVALID_HANDLE_VALUE), hMapping(nullptr) {}
+#else
+mappedFile_t::mappedFile_t() : view(nullptr), length(0), fd(-1) {}
+#endif
+
+mappedFile_t::~mappedFile_t() {
+    close();
+}
+
+mappedFile_t::mappedFile_t(mappedFile_t&& other) noexcept : mappedFile_t() {
+    *this = std::move(other);
+}
+
+mappedFile_t& mappedFile_t::operator=(mappedFile_t&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(view, other.view);
+        std::swap(length, other.length);
+#ifdef _WIN32
+        std::swap(hFile, other.hFile);
+        std::swap(hMapping, other.hMapping);
+#else
+        std::swap(fd, other.fd);
+#endif
+    }
+    return *this;
+}
+
+bool mappedFile_t::open(const std::string& filePath) {
+    close();
+
+#ifdef _WIN32
+    hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+        std::cerr << "Failed to get size or file is empty: " << filePath << std::endl;
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hMapping == NULL) {
+        std::cerr << "Failed to create file mapping: " << filePath << std::endl;
+        close();
+        return false;
+    }
+
+    view = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (view == nullptr) {
+        std::cerr << "Failed to map view of file: " << filePath << std::endl;
+        close();
+        return false;
+    }
+#else
+    fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Failed to get size or file is empty: " << filePath << std::endl;
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << filePath << std::endl;
+        close();
+        return false;
+    }
+    madvise(addr, length, MADV_SEQUENTIAL);
+    view = static_cast<const uint8_t*>(addr);
+#endif
+
+    return true;
+}
+
+void mappedFile_t::close() {
+#ifdef _WIN32
+    if (view) {
+        UnmapViewOfFile(view);
+    }
+    if (hMapping) {
+        CloseHandle(hMapping);
+        hMapping = nullptr;
+    }
+    if (hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(hFile);
+        hFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (view) {
+        munmap(const_cast<uint8_t*>(view), length);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    view = nullptr;
+    length = 0;
+}
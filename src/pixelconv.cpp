@@ -0,0 +1,599 @@
+#include "pixelconv.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PIXELCONV_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile each SIMD version for its own instruction set; MSVC needs no flag
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXELCONV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXELCONV_TARGET(isa)
+#endif
+
+namespace {
+
+struct pixelKernels_t {
+    const char* name;
+    void (*convert1555)(const uint8_t*, uint8_t*, size_t, bool);
+    void (*convert565)(const uint8_t*, uint8_t*, size_t, bool);
+    void (*convert4444)(const uint8_t*, uint8_t*, size_t, bool);
+    void (*expand24)(const uint8_t*, uint8_t*, size_t);
+    void (*intensity8)(const uint8_t*, uint8_t*, size_t);
+    void (*indexed8)(const uint8_t*, const uint32_t*, uint8_t*, size_t);
+    void (*swapRB32)(uint8_t*, size_t);
+    void (*reverse32)(uint8_t*, size_t);
+    void (*swapRows)(uint8_t*, uint8_t*, size_t);
+    void (*downsampleRow)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+    void (*fill32)(uint8_t*, uint32_t, size_t);
+};
+
+inline uint16_t load16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline void store8888(uint8_t* dst, uint8_t r, uint8_t g, uint8_t b, uint8_t a, bool bgra) {
+    dst[0] = bgra ? b : r;
+    dst[1] = g;
+    dst[2] = bgra ? r : b;
+    dst[3] = a;
+}
+
+// Scalar reference versions; the SIMD versions finish their tails with these
+
+void convert1555Scalar(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t p = load16(src + i * 2);
+        store8888(dst + i * 4, static_cast<uint8_t>(((p >> 10) & 0x1F) << 3), static_cast<uint8_t>(((p >> 5) & 0x1F) << 3),
+                  static_cast<uint8_t>((p & 0x1F) << 3), (p & 0x8000) ? 255 : 0, bgra);
+    }
+}
+
+void convert565Scalar(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t p = load16(src + i * 2);
+        unsigned r = p >> 11, g = (p >> 5) & 0x3F, b = p & 0x1F;
+        store8888(dst + i * 4, static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)),
+                  static_cast<uint8_t>((b << 3) | (b >> 2)), 255, bgra);
+    }
+}
+
+void convert4444Scalar(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t p = load16(src + i * 2);
+        store8888(dst + i * 4, static_cast<uint8_t>(((p >> 8) & 0xF) * 17), static_cast<uint8_t>(((p >> 4) & 0xF) * 17),
+                  static_cast<uint8_t>((p & 0xF) * 17), static_cast<uint8_t>((p >> 12) * 17), bgra);
+    }
+}
+
+void expand24Scalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+void intensity8Scalar(const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        std::memset(dst + i * 4, src[i], 4);
+    }
+}
+
+void indexed8Scalar(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(dst + i * 4, &palette[indices[i]], 4);
+    }
+}
+
+void swapRB32Scalar(uint8_t* data, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        std::swap(data[i * 4], data[i * 4 + 2]);
+    }
+}
+
+void reverse32Scalar(uint8_t* data, size_t count) {
+    for (size_t i = 0, j = count; i + 1 < j; ++i) {
+        --j;
+        uint32_t a, b;
+        std::memcpy(&a, data + i * 4, 4);
+        std::memcpy(&b, data + j * 4, 4);
+        std::memcpy(data + i * 4, &b, 4);
+        std::memcpy(data + j * 4, &a, 4);
+    }
+}
+
+void swapRowsScalar(uint8_t* a, uint8_t* b, size_t bytes) {
+    std::swap_ranges(a, a + bytes, b);
+}
+
+// Averages 2x2 blocks of two source rows into count output pixels
+void downsampleRowScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count * 4; ++i) {
+        size_t c = (i / 4) * 8 + (i % 4);
+        dst[i] = static_cast<uint8_t>((row0[c] + row0[c + 4] + row1[c] + row1[c + 4] + 2) >> 2);
+    }
+}
+
+void fill32Scalar(uint8_t* dst, uint32_t value, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(dst + i * 4, &value, 4);
+    }
+}
+
+const pixelKernels_t scalarKernels = {
+    "scalar", convert1555Scalar, convert565Scalar, convert4444Scalar, expand24Scalar, intensity8Scalar, indexed8Scalar,
+    swapRB32Scalar, reverse32Scalar, swapRowsScalar, downsampleRowScalar, fill32Scalar
+};
+
+#ifdef PIXELCONV_X86
+
+// SSE2: 8 pixels of 16 bits per register. Each channel is computed in the low
+// byte of a 16-bit lane, then the lanes are interleaved into 32-bit pixels.
+
+PIXELCONV_TARGET("sse2") inline void store8888Sse2(uint8_t* dst, __m128i r, __m128i g, __m128i b, __m128i a, bool bgra) {
+    __m128i c0 = bgra ? b : r;
+    __m128i c2 = bgra ? r : b;
+    __m128i lo = _mm_or_si128(c0, _mm_slli_epi16(g, 8));
+    __m128i hi = _mm_or_si128(c2, _mm_slli_epi16(a, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(lo, hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(lo, hi));
+}
+
+PIXELCONV_TARGET("sse2") void convert1555Sse2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m128i mask = _mm_set1_epi16(0xF8);
+    const __m128i low = _mm_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(p, 7), mask);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(p, 2), mask);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(p, 3), mask);
+        __m128i a = _mm_and_si128(_mm_srai_epi16(p, 15), low);
+        store8888Sse2(dst + i * 4, r, g, b, a, bgra);
+    }
+    convert1555Scalar(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+PIXELCONV_TARGET("sse2") void convert565Sse2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m128i mask5 = _mm_set1_epi16(0xF8);
+    const __m128i mask6 = _mm_set1_epi16(0xFC);
+    const __m128i alpha = _mm_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i r = _mm_and_si128(_mm_srli_epi16(p, 8), mask5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(p, 3), mask6);
+        __m128i b = _mm_and_si128(_mm_slli_epi16(p, 3), mask5);
+        r = _mm_or_si128(r, _mm_srli_epi16(r, 5));
+        g = _mm_or_si128(g, _mm_srli_epi16(g, 6));
+        b = _mm_or_si128(b, _mm_srli_epi16(b, 5));
+        store8888Sse2(dst + i * 4, r, g, b, alpha, bgra);
+    }
+    convert565Scalar(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+PIXELCONV_TARGET("sse2") void convert4444Sse2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m128i nibble = _mm_set1_epi16(0x0F);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        __m128i a = _mm_srli_epi16(p, 12);
+        __m128i r = _mm_and_si128(_mm_srli_epi16(p, 8), nibble);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(p, 4), nibble);
+        __m128i b = _mm_and_si128(p, nibble);
+        a = _mm_or_si128(a, _mm_slli_epi16(a, 4));
+        r = _mm_or_si128(r, _mm_slli_epi16(r, 4));
+        g = _mm_or_si128(g, _mm_slli_epi16(g, 4));
+        b = _mm_or_si128(b, _mm_slli_epi16(b, 4));
+        store8888Sse2(dst + i * 4, r, g, b, a, bgra);
+    }
+    convert4444Scalar(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+// Unpacking a register with itself twice turns each byte into four copies
+PIXELCONV_TARGET("sse2") void intensity8Sse2(const uint8_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, v);
+        __m128i hi = _mm_unpackhi_epi8(v, v);
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i * 4);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(lo, lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hi));
+    }
+    intensity8Scalar(src + i, dst + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("sse2") void swapRB32Sse2(uint8_t* data, size_t count) {
+    const __m128i keep = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+    const __m128i swap = _mm_set1_epi32(0x00FF00FF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i * 4);
+        __m128i v = _mm_loadu_si128(p);
+        __m128i rb = _mm_and_si128(v, swap);
+        rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(v, keep), rb));
+    }
+    swapRB32Scalar(data + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("sse2") void reverse32Sse2(uint8_t* data, size_t count) {
+    size_t i = 0, j = count;
+    for (; j - i >= 8; i += 4, j -= 4) {
+        __m128i* front = reinterpret_cast<__m128i*>(data + i * 4);
+        __m128i* back = reinterpret_cast<__m128i*>(data + (j - 4) * 4);
+        __m128i f = _mm_shuffle_epi32(_mm_loadu_si128(front), 0x1B);
+        __m128i b = _mm_shuffle_epi32(_mm_loadu_si128(back), 0x1B);
+        _mm_storeu_si128(front, b);
+        _mm_storeu_si128(back, f);
+    }
+    reverse32Scalar(data + i * 4, j - i);
+}
+
+PIXELCONV_TARGET("sse2") void swapRowsSse2(uint8_t* a, uint8_t* b, size_t bytes) {
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + i), vb);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(b + i), va);
+    }
+    swapRowsScalar(a + i, b + i, bytes - i);
+}
+
+// Widens both rows to 16 bits, adds them, then adds each pixel to its right-hand neighbour
+PIXELCONV_TARGET("sse2") inline __m128i sumBlocksSse2(__m128i a, __m128i b) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+PIXELCONV_TARGET("sse2") void downsampleRowSse2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t count) {
+    const __m128i round = _mm_set1_epi16(2);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i* a = reinterpret_cast<const __m128i*>(row0 + i * 8);
+        const __m128i* b = reinterpret_cast<const __m128i*>(row1 + i * 8);
+        __m128i first = sumBlocksSse2(_mm_loadu_si128(a), _mm_loadu_si128(b));
+        __m128i second = sumBlocksSse2(_mm_loadu_si128(a + 1), _mm_loadu_si128(b + 1));
+        first = _mm_srli_epi16(_mm_add_epi16(first, round), 2);
+        second = _mm_srli_epi16(_mm_add_epi16(second, round), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(first, second));
+    }
+    downsampleRowScalar(row0 + i * 8, row1 + i * 8, dst + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("sse2") void fill32Sse2(uint8_t* dst, uint32_t value, size_t count) {
+    __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), v);
+    }
+    fill32Scalar(dst + i * 4, value, count - i);
+}
+
+const pixelKernels_t sse2Kernels = {
+    "sse2", convert1555Sse2, convert565Sse2, convert4444Sse2, expand24Scalar, intensity8Sse2, indexed8Scalar,
+    swapRB32Sse2, reverse32Sse2, swapRowsSse2, downsampleRowSse2, fill32Sse2
+};
+
+// AVX2: 16 pixels of 16 bits per register. The unpacks work within 128-bit
+// lanes, so the two results are recombined across lanes before storing.
+
+PIXELCONV_TARGET("avx2") inline void store8888Avx2(uint8_t* dst, __m256i r, __m256i g, __m256i b, __m256i a, bool bgra) {
+    __m256i c0 = bgra ? b : r;
+    __m256i c2 = bgra ? r : b;
+    __m256i lo = _mm256_or_si256(c0, _mm256_slli_epi16(g, 8));
+    __m256i hi = _mm256_or_si256(c2, _mm256_slli_epi16(a, 8));
+    __m256i first = _mm256_unpacklo_epi16(lo, hi);   // Pixels 0-3 and 8-11
+    __m256i second = _mm256_unpackhi_epi16(lo, hi);  // Pixels 4-7 and 12-15
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(first, second, 0x31));
+}
+
+PIXELCONV_TARGET("avx2") void convert1555Avx2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m256i mask = _mm256_set1_epi16(0xF8);
+    const __m256i low = _mm256_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi16(p, 7), mask);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(p, 2), mask);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi16(p, 3), mask);
+        __m256i a = _mm256_and_si256(_mm256_srai_epi16(p, 15), low);
+        store8888Avx2(dst + i * 4, r, g, b, a, bgra);
+    }
+    convert1555Sse2(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+PIXELCONV_TARGET("avx2") void convert565Avx2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m256i mask5 = _mm256_set1_epi16(0xF8);
+    const __m256i mask6 = _mm256_set1_epi16(0xFC);
+    const __m256i alpha = _mm256_set1_epi16(0xFF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi16(p, 8), mask5);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(p, 3), mask6);
+        __m256i b = _mm256_and_si256(_mm256_slli_epi16(p, 3), mask5);
+        r = _mm256_or_si256(r, _mm256_srli_epi16(r, 5));
+        g = _mm256_or_si256(g, _mm256_srli_epi16(g, 6));
+        b = _mm256_or_si256(b, _mm256_srli_epi16(b, 5));
+        store8888Avx2(dst + i * 4, r, g, b, alpha, bgra);
+    }
+    convert565Sse2(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+PIXELCONV_TARGET("avx2") void convert4444Avx2(const uint8_t* src, uint8_t* dst, size_t count, bool bgra) {
+    const __m256i nibble = _mm256_set1_epi16(0x0F);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+        __m256i a = _mm256_srli_epi16(p, 12);
+        __m256i r = _mm256_and_si256(_mm256_srli_epi16(p, 8), nibble);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(p, 4), nibble);
+        __m256i b = _mm256_and_si256(p, nibble);
+        a = _mm256_or_si256(a, _mm256_slli_epi16(a, 4));
+        r = _mm256_or_si256(r, _mm256_slli_epi16(r, 4));
+        g = _mm256_or_si256(g, _mm256_slli_epi16(g, 4));
+        b = _mm256_or_si256(b, _mm256_slli_epi16(b, 4));
+        store8888Avx2(dst + i * 4, r, g, b, a, bgra);
+    }
+    convert4444Sse2(src + i * 2, dst + i * 4, count - i, bgra);
+}
+
+// Four 3-byte pixels from each 16-byte half are spread into 4-byte slots and the alpha is or'ed in
+PIXELCONV_TARGET("avx2") void expand24Avx2(const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+    // The second half reads 16 bytes from pixel i + 4, so stop while that stays inside the source
+    for (; i + 10 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 12));
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        v = _mm256_or_si256(_mm256_shuffle_epi8(v, spread), alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), v);
+    }
+    expand24Scalar(src + i * 3, dst + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("avx2") void indexed8Avx2(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count) {
+    const int* table = reinterpret_cast<const int*>(palette);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_i32gather_epi32(table, index, 4));
+    }
+    indexed8Scalar(indices + i, palette, dst + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("avx2") void swapRB32Avx2(uint8_t* data, size_t count) {
+    const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i * 4);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), swap));
+    }
+    swapRB32Sse2(data + i * 4, count - i);
+}
+
+PIXELCONV_TARGET("avx2") void reverse32Avx2(uint8_t* data, size_t count) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = 0, j = count;
+    for (; j - i >= 16; i += 8, j -= 8) {
+        __m256i* front = reinterpret_cast<__m256i*>(data + i * 4);
+        __m256i* back = reinterpret_cast<__m256i*>(data + (j - 8) * 4);
+        __m256i f = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(front), reverse);
+        __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(back), reverse);
+        _mm256_storeu_si256(front, b);
+        _mm256_storeu_si256(back, f);
+    }
+    reverse32Sse2(data + i * 4, j - i);
+}
+
+PIXELCONV_TARGET("avx2") void swapRowsAvx2(uint8_t* a, uint8_t* b, size_t bytes) {
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a + i), vb);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(b + i), va);
+    }
+    swapRowsSse2(a + i, b + i, bytes - i);
+}
+
+PIXELCONV_TARGET("avx2") void fill32Avx2(uint8_t* dst, uint32_t value, size_t count) {
+    __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), v);
+    }
+    fill32Sse2(dst + i * 4, value, count - i);
+}
+
+const pixelKernels_t avx2Kernels = {
+    "avx2", convert1555Avx2, convert565Avx2, convert4444Avx2, expand24Avx2, intensity8Sse2, indexed8Avx2,
+    swapRB32Avx2, reverse32Avx2, swapRowsAvx2, downsampleRowSse2, fill32Avx2
+};
+
+bool cpuHasSse2() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // The OS must also save the YMM registers on context switches
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // PIXELCONV_X86
+
+const pixelKernels_t& selectKernels() {
+    std::string limit;
+    if (const char* env = std::getenv("MEFVIEW_SIMD")) {
+        limit = env;
+    }
+    if (limit == "scalar") {
+        return scalarKernels;
+    }
+#ifdef PIXELCONV_X86
+    if (limit != "sse2" && cpuHasAvx2()) {
+        return avx2Kernels;
+    }
+    if (cpuHasSse2()) {
+        return sse2Kernels;
+    }
+#endif
+    return scalarKernels;
+}
+
+const pixelKernels_t& kernels() {
+    static const pixelKernels_t& selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+const char* pixelKernelName() {
+    return kernels().name;
+}
+
+void pixelConvert1555To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order) {
+    kernels().convert1555(src, dst, count, order == pixelOrder_t::BGRA);
+}
+
+void pixelConvert565To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order) {
+    kernels().convert565(src, dst, count, order == pixelOrder_t::BGRA);
+}
+
+void pixelConvert4444To8888(const uint8_t* src, uint8_t* dst, size_t count, pixelOrder_t order) {
+    kernels().convert4444(src, dst, count, order == pixelOrder_t::BGRA);
+}
+
+void pixelExpand24To32(const uint8_t* src, uint8_t* dst, size_t count) {
+    kernels().expand24(src, dst, count);
+}
+
+void pixelExpandIntensity8(const uint8_t* src, uint8_t* dst, size_t count) {
+    kernels().intensity8(src, dst, count);
+}
+
+void pixelExpandIndexed8(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count) {
+    kernels().indexed8(indices, palette, dst, count);
+}
+
+void pixelExpandIndexed4(const uint8_t* indices, const uint32_t* palette, uint8_t* dst, size_t count) {
+    // Nibbles are split into bytes a block at a time and looked up like 8-bit indices
+    uint8_t unpacked[512];
+    for (size_t i = 0; i < count; i += sizeof(unpacked)) {
+        size_t block = std::min(count - i, sizeof(unpacked));
+        for (size_t n = 0; n < block; ++n) {
+            uint8_t packed = indices[(i + n) / 2];
+            unpacked[n] = ((i + n) & 1) ? (packed >> 4) : (packed & 0x0F);
+        }
+        kernels().indexed8(unpacked, palette, dst + i * 4, block);
+    }
+}
+
+void pixelSwapRB32(uint8_t* data, size_t count) {
+    kernels().swapRB32(data, count);
+}
+
+void pixelReverse32(uint8_t* data, size_t count) {
+    kernels().reverse32(data, count);
+}
+
+void pixelSwapRows(uint8_t* a, uint8_t* b, size_t rowBytes) {
+    kernels().swapRows(a, b, rowBytes);
+}
+
+void pixelFlipRows(uint8_t* data, size_t rowBytes, size_t rows) {
+    for (size_t top = 0, bottom = rows; top + 1 < bottom; ++top) {
+        --bottom;
+        kernels().swapRows(data + top * rowBytes, data + bottom * rowBytes, rowBytes);
+    }
+}
+
+void pixelFill(uint8_t* dst, const uint8_t* pixel, size_t pixelSize, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (pixelSize == 4) {
+        uint32_t value;
+        std::memcpy(&value, pixel, 4);
+        kernels().fill32(dst, value, count);
+        return;
+    }
+    // Other sizes copy the filled prefix onto itself, doubling it each time
+    std::memcpy(dst, pixel, pixelSize);
+    size_t filled = pixelSize;
+    size_t total = pixelSize * count;
+    while (filled < total) {
+        size_t n = std::min(filled, total - filled);
+        std::memcpy(dst + filled, dst, n);
+        filled += n;
+    }
+}
+
+void pixelDownsample2x(const uint8_t* src, size_t width, size_t height, uint8_t* dst) {
+    size_t outWidth = std::max<size_t>(1, width / 2);
+    size_t outHeight = std::max<size_t>(1, height / 2);
+    size_t rowBytes = width * 4;
+    for (size_t y = 0; y < outHeight; ++y) {
+        const uint8_t* row0 = src + std::min(y * 2, height - 1) * rowBytes;
+        const uint8_t* row1 = src + std::min(y * 2 + 1, height - 1) * rowBytes;
+        uint8_t* out = dst + y * outWidth * 4;
+        if (width > 1) {
+            kernels().downsampleRow(row0, row1, out, outWidth);
+        } else {
+            for (size_t c = 0; c < 4; ++c) {
+                out[c] = static_cast<uint8_t>((row0[c] + row1[c] + 1) >> 1);
+            }
+        }
+    }
+}
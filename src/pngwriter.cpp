@@ -0,0 +1,576 @@
+#include "pngwriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <zlib.h>
+
+#include "checksum.h"
+#include "pixelconv.h"
+#include "threadpool.h"
+
+namespace {
+
+enum pngFilter_t : uint8_t {
+    PNG_FILTER_NONE = 0,
+    PNG_FILTER_SUB = 1,
+    PNG_FILTER_UP = 2,
+    PNG_FILTER_AVERAGE = 3,
+    PNG_FILTER_PAETH = 4,
+    PNG_FILTER_COUNT = 5
+};
+
+// Largest width or height a PNG may declare
+const uint32_t PNG_MAX_DIMENSION = 0x7FFFFFFF;
+
+// Compressed bytes per IDAT chunk; the encoder never holds more than this of its output
+const size_t PNG_IDAT_BYTES = 64 * 1024;
+
+// zlib takes 32-bit lengths, so larger buffers are fed in slices
+const size_t ZLIB_MAX_SLICE = size_t(1) << 30;
+
+// Filtered bytes per independently compressed segment, as in pigz
+const size_t PNG_SEGMENT_BYTES = 128 * 1024;
+
+// Deflate window; each segment is primed with this much of the data before it
+const size_t ZLIB_WINDOW = 32 * 1024;
+
+struct zlibParams_t {
+    int level;
+    int memLevel;
+    int strategy;
+};
+
+zlibParams_t zlibParams(pngLevel_t level) {
+    switch (level) {
+        case pngLevel_t::Fast:
+            return { 1, 8, Z_DEFAULT_STRATEGY };
+        case pngLevel_t::Small:
+            return { 9, 9, Z_DEFAULT_STRATEGY };
+        default:
+            return { 6, 8, Z_DEFAULT_STRATEGY };
+    }
+}
+
+inline void storeUInt32BE(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+inline uint8_t paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// Filters one scanline of bytes; prev is the unfiltered row above (all zero for the first row)
+void filterRow(uint8_t filter, const uint8_t* row, const uint8_t* prev, size_t bytes, unsigned bpp, uint8_t* out) {
+    size_t lead = std::min<size_t>(bpp, bytes);
+    switch (filter) {
+        case PNG_FILTER_SUB:
+            std::memcpy(out, row, lead);
+            for (size_t i = lead; i < bytes; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - row[i - bpp]);
+            }
+            break;
+        case PNG_FILTER_UP:
+            for (size_t i = 0; i < bytes; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - prev[i]);
+            }
+            break;
+        case PNG_FILTER_AVERAGE:
+            for (size_t i = 0; i < lead; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - (prev[i] >> 1));
+            }
+            for (size_t i = lead; i < bytes; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - ((row[i - bpp] + prev[i]) >> 1));
+            }
+            break;
+        case PNG_FILTER_PAETH:
+            for (size_t i = 0; i < lead; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - prev[i]);
+            }
+            for (size_t i = lead; i < bytes; ++i) {
+                out[i] = static_cast<uint8_t>(row[i] - paethPredictor(row[i - bpp], prev[i], prev[i - bpp]));
+            }
+            break;
+        default:
+            std::memcpy(out, row, bytes);
+            break;
+    }
+}
+
+// Sum of the filtered bytes read as signed values; smaller usually deflates better
+uint64_t filterCost(const uint8_t* data, size_t bytes) {
+    uint64_t cost = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        cost += data[i] < 128 ? data[i] : 256 - data[i];
+    }
+    return cost;
+}
+
+// Row y as it is encoded, after flipV and reverse, read through the caller's row source
+class rowReader_t {
+public:
+    rowReader_t(const pngRowSource_t& rows, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options)
+        : rows(rows), width(width), height(height), channels(channels), flipV(options.flipV), reverse(options.reverse), swapRB(options.swapRB) {}
+
+    // scratch holds one row; the result stays valid until scratch is reused
+    const uint8_t* read(uint32_t y, uint8_t* scratch) const {
+        const uint8_t* row = rows(flipV ? height - 1 - y : y, scratch);
+        if (!reverse && !swapRB) {
+            return row;
+        }
+        if (reverse && row == scratch) {
+            for (uint32_t x = 0; x < width / 2; ++x) {
+                std::swap_ranges(scratch + static_cast<size_t>(x) * channels, scratch + static_cast<size_t>(x + 1) * channels,
+                                 scratch + static_cast<size_t>(width - 1 - x) * channels);
+            }
+        } else if (reverse) {
+            for (uint32_t x = 0; x < width; ++x) {
+                std::memcpy(scratch + static_cast<size_t>(x) * channels, row + static_cast<size_t>(width - 1 - x) * channels, channels);
+            }
+        } else if (row != scratch) {
+            // The caller's row is never modified
+            std::memcpy(scratch, row, static_cast<size_t>(width) * channels);
+        }
+        if (swapRB) {
+            if (channels == 4) {
+                pixelSwapRB32(scratch, width);
+            } else {
+                for (uint32_t x = 0; x < width; ++x) {
+                    std::swap(scratch[static_cast<size_t>(x) * 3], scratch[static_cast<size_t>(x) * 3 + 2]);
+                }
+            }
+        }
+        return scratch;
+    }
+
+private:
+    const pngRowSource_t& rows;
+    uint32_t width;
+    uint32_t height;
+    unsigned channels;
+    bool flipV;
+    bool reverse;
+    bool swapRB;
+};
+
+// Filters one row at a time, keeping the candidate rows of the adaptive search between rows
+class rowFilter_t {
+public:
+    rowFilter_t(size_t stride, unsigned channels, pngLevel_t level)
+        : stride(stride), channels(channels), adaptive(level != pngLevel_t::Fast) {
+        if (adaptive) {
+            for (auto& candidate : candidates) {
+                candidate.resize(stride);
+            }
+        }
+    }
+
+    // out receives the filter byte followed by the filtered row; prev is the row above, all zero for the first
+    void apply(const uint8_t* row, const uint8_t* prev, uint8_t* out) {
+        if (!adaptive) {
+            out[0] = PNG_FILTER_SUB;
+            filterRow(PNG_FILTER_SUB, row, prev, stride, channels, out + 1);
+            return;
+        }
+        uint8_t best = PNG_FILTER_NONE;
+        uint64_t bestCost = UINT64_MAX;
+        for (uint8_t filter = PNG_FILTER_NONE; filter < PNG_FILTER_COUNT; ++filter) {
+            filterRow(filter, row, prev, stride, channels, candidates[filter].data());
+            uint64_t cost = filterCost(candidates[filter].data(), stride);
+            if (cost < bestCost) {
+                best = filter;
+                bestCost = cost;
+            }
+        }
+        out[0] = best;
+        std::memcpy(out + 1, candidates[best].data(), stride);
+    }
+
+private:
+    size_t stride;
+    unsigned channels;
+    bool adaptive;
+    std::vector<uint8_t> candidates[PNG_FILTER_COUNT];
+};
+
+// Filters rows [first, last) into out, stride + 1 bytes per row
+void filterRange(const rowReader_t& reader, size_t stride, unsigned channels, pngLevel_t level, uint32_t first, uint32_t last, uint8_t* out) {
+    rowFilter_t filter(stride, channels, level);
+    std::vector<uint8_t> zeroRow(stride, 0);
+    std::vector<uint8_t> scratch[2] = { std::vector<uint8_t>(stride), std::vector<uint8_t>(stride) };
+    const uint8_t* prev = zeroRow.data();
+    if (first > 0) {
+        prev = reader.read(first - 1, scratch[(first - 1) & 1].data());
+    }
+    for (uint32_t y = first; y < last; ++y) {
+        const uint8_t* row = reader.read(y, scratch[y & 1].data());
+        filter.apply(row, prev, out + (stride + 1) * (y - first));
+        prev = row;
+    }
+}
+
+// Appends length, type, data and the CRC of type and data
+bool writeChunk(const pngSink_t& sink, const char* type, const uint8_t* data, size_t size) {
+    uint8_t header[8];
+    storeUInt32BE(header, static_cast<uint32_t>(size));
+    std::memcpy(header + 4, type, 4);
+    uint8_t crc[4];
+    storeUInt32BE(crc, checksumCrc32(checksumCrc32(0, header + 4, 4), data, size));
+    return sink(header, sizeof(header)) && (size == 0 || sink(data, size)) && sink(crc, sizeof(crc));
+}
+
+// Collects the zlib stream and hands it to the sink as IDAT chunks of at most PNG_IDAT_BYTES
+class idatWriter_t {
+public:
+    explicit idatWriter_t(const pngSink_t& sink) : sink(sink), buffer(PNG_IDAT_BYTES), used(0) {}
+
+    // Free space deflate can write into directly; commit() what was written
+    uint8_t* space() { return buffer.data() + used; }
+    size_t available() const { return buffer.size() - used; }
+
+    bool commit(size_t size) {
+        used += size;
+        return used < buffer.size() || flush();
+    }
+
+    bool write(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            size_t n = std::min(size, available());
+            std::memcpy(space(), data, n);
+            data += n;
+            size -= n;
+            if (!commit(n)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool flush() {
+        if (used == 0) {
+            return true;
+        }
+        size_t size = used;
+        used = 0;
+        return writeChunk(sink, "IDAT", buffer.data(), size);
+    }
+
+private:
+    const pngSink_t& sink;
+    std::vector<uint8_t> buffer;
+    size_t used;
+};
+
+/**
+ * Runs deflate over data, appending to out. Z_FINISH closes the stream;
+ * Z_SYNC_FLUSH ends on a byte boundary so another segment can follow.
+ */
+bool deflateRun(z_stream& zs, const uint8_t* data, size_t size, int flush, std::vector<uint8_t>& out) {
+    size_t produced = out.size();
+    out.resize(produced + deflateBound(&zs, static_cast<uLong>(std::min(size, ZLIB_MAX_SLICE))) + 16);
+    size_t consumed = 0;
+    for (;;) {
+        if (zs.avail_in == 0 && consumed < size) {
+            size_t slice = std::min(size - consumed, ZLIB_MAX_SLICE);
+            zs.next_in = const_cast<Bytef*>(data + consumed);
+            zs.avail_in = static_cast<uInt>(slice);
+            consumed += slice;
+        }
+        if (produced == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        zs.next_out = out.data() + produced;
+        zs.avail_out = static_cast<uInt>(std::min(out.size() - produced, ZLIB_MAX_SLICE));
+        bool lastSlice = consumed == size;
+        int ret = deflate(&zs, lastSlice ? flush : Z_NO_FLUSH);
+        produced = zs.next_out - out.data();
+        if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) {
+            std::cerr << "pngCompress: deflate failed (" << ret << ")" << std::endl;
+            return false;
+        }
+        bool done = flush == Z_FINISH ? ret == Z_STREAM_END : lastSlice && zs.avail_in == 0 && zs.avail_out != 0;
+        if (done) {
+            break;
+        }
+    }
+    out.resize(produced);
+    return true;
+}
+
+// Same for one row at a time, with the output going straight into IDAT chunks
+bool deflateInto(z_stream& zs, const uint8_t* data, size_t size, int flush, idatWriter_t& idat) {
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(size);
+    for (;;) {
+        size_t available = idat.available();
+        zs.next_out = idat.space();
+        zs.avail_out = static_cast<uInt>(available);
+        int ret = deflate(&zs, flush);
+        if (ret != Z_OK && ret != Z_BUF_ERROR && ret != Z_STREAM_END) {
+            std::cerr << "pngWriteRows: deflate failed (" << ret << ")" << std::endl;
+            return false;
+        }
+        bool full = zs.avail_out == 0;
+        if (!idat.commit(available - zs.avail_out)) {
+            return false;
+        }
+        bool done = flush == Z_FINISH ? ret == Z_STREAM_END : zs.avail_in == 0 && !full;
+        if (done) {
+            return true;
+        }
+    }
+}
+
+bool deflateInitRaw(z_stream& zs, const zlibParams_t& params) {
+    std::memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, params.level, Z_DEFLATED, -15, params.memLevel, params.strategy) != Z_OK) {
+        std::cerr << "pngCompress: deflateInit2 failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Compresses one segment as raw deflate data, primed with the dictionary bytes that precede it
+bool deflateSegment(const uint8_t* dictionary, size_t dictionarySize, const uint8_t* data, size_t size, const zlibParams_t& params, bool last, std::vector<uint8_t>& out) {
+    z_stream zs;
+    if (!deflateInitRaw(zs, params)) {
+        return false;
+    }
+    bool ok = dictionarySize == 0 || deflateSetDictionary(&zs, dictionary, static_cast<uInt>(dictionarySize)) == Z_OK;
+    ok = ok && deflateRun(zs, data, size, last ? Z_FINISH : Z_SYNC_FLUSH, out);
+    deflateEnd(&zs);
+    return ok;
+}
+
+// Two-byte zlib header for a 32 KB window; FLEVEL mirrors what zlib itself writes for the level
+void zlibHeader(uint8_t* out, const zlibParams_t& params) {
+    const unsigned cmf = 0x78;
+    unsigned flevel = params.level < 2 ? 0 : params.level < 6 ? 1 : params.level == 6 ? 2 : 3;
+    unsigned flg = flevel << 6;
+    flg += 31 - ((cmf << 8) | flg) % 31;
+    out[0] = static_cast<uint8_t>(cmf);
+    out[1] = static_cast<uint8_t>(flg);
+}
+
+// Filters and compresses row by row; only the previous row is kept
+bool encodeStream(const rowReader_t& reader, uint32_t height, size_t stride, unsigned channels, pngLevel_t level, idatWriter_t& idat) {
+    zlibParams_t params = zlibParams(level);
+    z_stream zs;
+    if (!deflateInitRaw(zs, params)) {
+        return false;
+    }
+
+    uint8_t header[2];
+    zlibHeader(header, params);
+    bool ok = idat.write(header, sizeof(header));
+
+    rowFilter_t filter(stride, channels, level);
+    std::vector<uint8_t> zeroRow(stride, 0);
+    std::vector<uint8_t> scratch[2] = { std::vector<uint8_t>(stride), std::vector<uint8_t>(stride) };
+    std::vector<uint8_t> filtered(stride + 1);
+    const uint8_t* prev = zeroRow.data();
+    uint32_t adler = 1;
+    for (uint32_t y = 0; ok && y < height; ++y) {
+        const uint8_t* row = reader.read(y, scratch[y & 1].data());
+        filter.apply(row, prev, filtered.data());
+        adler = checksumAdler32(adler, filtered.data(), filtered.size());
+        ok = deflateInto(zs, filtered.data(), filtered.size(), y + 1 == height ? Z_FINISH : Z_NO_FLUSH, idat);
+        prev = row;
+    }
+    deflateEnd(&zs);
+
+    uint8_t trailer[4];
+    storeUInt32BE(trailer, adler);
+    return ok && idat.write(trailer, sizeof(trailer));
+}
+
+/**
+ * Filters and compresses segments of rowsPerSegment rows on the pool and
+ * stitches them into one zlib stream: every segment but the last ends with a
+ * sync flush, and the Adler-32 of the whole is combined from the segments'.
+ * Segments are processed a batch at a time so memory stays bounded.
+ */
+bool encodeSegments(const rowReader_t& reader, uint32_t height, size_t stride, unsigned channels, pngLevel_t level, threadPool_t& pool, uint32_t rowsPerSegment, idatWriter_t& idat) {
+    size_t rowBytes = stride + 1;
+    size_t segmentCount = (height + rowsPerSegment - 1) / rowsPerSegment;
+    size_t batch = static_cast<size_t>(pool.size()) * 2;
+    zlibParams_t params = zlibParams(level);
+
+    uint8_t header[2];
+    zlibHeader(header, params);
+    if (!idat.write(header, sizeof(header))) {
+        return false;
+    }
+
+    std::vector<uint8_t> filtered;
+    std::vector<uint8_t> window; // Tail of the previous batch, primes its first segment
+    std::vector<std::vector<uint8_t>> parts(batch);
+    std::vector<uint32_t> adlers(batch);
+    uint32_t adler = 1;
+    for (size_t firstSegment = 0; firstSegment < segmentCount; firstSegment += batch) {
+        size_t count = std::min(batch, segmentCount - firstSegment);
+        uint32_t firstRow = static_cast<uint32_t>(firstSegment * rowsPerSegment);
+        uint32_t lastRow = static_cast<uint32_t>(std::min<size_t>(height, (firstSegment + count) * rowsPerSegment));
+        filtered.resize(rowBytes * (lastRow - firstRow));
+
+        // Rows only depend on the unfiltered row above, so segments filter independently
+        pool.parallelFor(count, [&](size_t s) {
+            uint32_t first = firstRow + static_cast<uint32_t>(s * rowsPerSegment);
+            uint32_t last = std::min(lastRow, first + rowsPerSegment);
+            filterRange(reader, stride, channels, level, first, last, filtered.data() + rowBytes * (first - firstRow));
+        });
+
+        std::atomic<bool> failed(false);
+        pool.parallelFor(count, [&](size_t s) {
+            size_t begin = rowBytes * rowsPerSegment * s;
+            size_t end = std::min(filtered.size(), begin + rowBytes * rowsPerSegment);
+            const uint8_t* dictionary = window.data();
+            size_t dictionarySize = window.size();
+            if (s > 0) {
+                dictionarySize = std::min(begin, ZLIB_WINDOW);
+                dictionary = filtered.data() + begin - dictionarySize;
+            }
+            parts[s].clear();
+            adlers[s] = checksumAdler32(1, filtered.data() + begin, end - begin);
+            if (!deflateSegment(dictionary, dictionarySize, filtered.data() + begin, end - begin, params, firstSegment + s + 1 == segmentCount, parts[s])) {
+                failed = true;
+            }
+        });
+        if (failed) {
+            return false;
+        }
+
+        for (size_t s = 0; s < count; ++s) {
+            if (!idat.write(parts[s].data(), parts[s].size())) {
+                return false;
+            }
+            size_t begin = rowBytes * rowsPerSegment * s;
+            adler = checksumAdler32Combine(adler, adlers[s], std::min(filtered.size(), begin + rowBytes * rowsPerSegment) - begin);
+        }
+        size_t keep = std::min(filtered.size(), ZLIB_WINDOW);
+        window.assign(filtered.end() - keep, filtered.end());
+    }
+
+    uint8_t trailer[4];
+    storeUInt32BE(trailer, adler);
+    return idat.write(trailer, sizeof(trailer));
+}
+
+} // namespace
+
+bool pngParseLevel(const std::string& name, pngLevel_t& level) {
+    if (name == "fast") {
+        level = pngLevel_t::Fast;
+    } else if (name == "default") {
+        level = pngLevel_t::Default;
+    } else if (name == "small") {
+        level = pngLevel_t::Small;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* pngLevelName(pngLevel_t level) {
+    switch (level) {
+        case pngLevel_t::Fast:
+            return "fast";
+        case pngLevel_t::Small:
+            return "small";
+        default:
+            return "default";
+    }
+}
+
+bool pngCompress(const uint8_t* data, size_t size, pngLevel_t level, std::vector<uint8_t>& out) {
+    zlibParams_t params = zlibParams(level);
+    out.resize(2);
+    zlibHeader(out.data(), params);
+    if (!deflateSegment(nullptr, 0, data, size, params, true, out)) {
+        return false;
+    }
+    uint8_t trailer[4];
+    storeUInt32BE(trailer, checksumAdler32(1, data, size));
+    out.insert(out.end(), trailer, trailer + sizeof(trailer));
+    return true;
+}
+
+bool pngWriteRows(const pngRowSource_t& rows, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options, const pngSink_t& sink) {
+    if (channels != 3 && channels != 4) {
+        std::cerr << "pngWriteRows: Only RGB and RGBA images are supported" << std::endl;
+        return false;
+    }
+    if (width == 0 || height == 0 || width > PNG_MAX_DIMENSION || height > PNG_MAX_DIMENSION) {
+        std::cerr << "pngWriteRows: Invalid image size " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t ihdr[13];
+    storeUInt32BE(ihdr, width);
+    storeUInt32BE(ihdr + 4, height);
+    ihdr[8] = 8;                        // Bit depth
+    ihdr[9] = channels == 4 ? 6 : 2;    // Colour type: RGBA or RGB
+    ihdr[10] = 0;                       // Compression: deflate
+    ihdr[11] = 0;                       // Filter method: adaptive
+    ihdr[12] = 0;                       // No interlace
+    if (!sink(signature, sizeof(signature)) || !writeChunk(sink, "IHDR", ihdr, sizeof(ihdr))) {
+        return false;
+    }
+
+    size_t stride = static_cast<size_t>(width) * channels;
+    uint32_t rowsPerSegment = static_cast<uint32_t>(std::max<size_t>(1, PNG_SEGMENT_BYTES / (stride + 1)));
+    rowReader_t reader(rows, width, height, channels, options);
+    idatWriter_t idat(sink);
+    bool ok;
+    if (options.pool != nullptr && options.pool->size() > 1 && height > rowsPerSegment) {
+        ok = encodeSegments(reader, height, stride, channels, options.level, *options.pool, rowsPerSegment, idat);
+    } else {
+        ok = encodeStream(reader, height, stride, channels, options.level, idat);
+    }
+    return ok && idat.flush() && writeChunk(sink, "IEND", nullptr, 0);
+}
+
+bool pngEncode(const uint8_t* pixels, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options, std::vector<uint8_t>& out) {
+    size_t stride = static_cast<size_t>(width) * channels;
+    out.clear();
+    return pngWriteRows([=](uint32_t y, uint8_t*) { return pixels + y * stride; }, width, height, channels, options,
+                        [&out](const uint8_t* data, size_t size) {
+                            out.insert(out.end(), data, data + size);
+                            return true;
+                        });
+}
+
+bool pngSave(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, unsigned channels, const pngOptions_t& options) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open file for writing: " << path << std::endl;
+        return false;
+    }
+
+    size_t stride = static_cast<size_t>(width) * channels;
+    bool ok = pngWriteRows([=](uint32_t y, uint8_t*) { return pixels + y * stride; }, width, height, channels, options,
+                           [&file](const uint8_t* data, size_t size) {
+                               file.write(reinterpret_cast<const char*>(data), size);
+                               return static_cast<bool>(file);
+                           });
+    if (!file) {
+        std::cerr << "Error: Failed to write data to file: " << path << std::endl;
+        return false;
+    }
+    return ok;
+}
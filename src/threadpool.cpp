@@ -0,0 +1,110 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+
+threadPool_t::threadPool_t(unsigned threads) : active(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&threadPool_t::workerLoop, this);
+    }
+}
+
+threadPool_t::~threadPool_t() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+threadPool_t& threadPool_t::shared() {
+    static threadPool_t pool;
+    return pool;
+}
+
+void threadPool_t::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void threadPool_t::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return tasks.empty() && active == 0; });
+}
+
+void threadPool_t::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // Helpers and the caller pull indices from a shared counter, which keeps
+    // uneven items (a large texture next to a tiny one) from stalling a batch
+    std::atomic<size_t> next(0);
+    auto drain = [&next, count, &fn] {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    // Counts only this call's helpers, so other work on the pool is not waited for
+    size_t pending = std::min<size_t>(count - 1, workers.size());
+    for (size_t t = pending; t > 0; --t) {
+        submit([this, &drain, &pending] {
+            drain();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                helperDone.notify_all();
+            }
+        });
+    }
+
+    drain();
+
+    // A helper may still be queued behind tasks of callers that are themselves
+    // waiting, e.g. when called from a worker; running queued tasks here keeps
+    // every waiting caller making progress
+    std::unique_lock<std::mutex> lock(mutex);
+    while (pending > 0) {
+        if (!tasks.empty()) {
+            runOne(lock);
+        } else {
+            helperDone.wait(lock);
+        }
+    }
+}
+
+void threadPool_t::runOne(std::unique_lock<std::mutex>& lock) {
+    std::function<void()> task = std::move(tasks.front());
+    tasks.pop_front();
+    ++active;
+    lock.unlock();
+
+    task();
+
+    lock.lock();
+    --active;
+    if (tasks.empty() && active == 0) {
+        allDone.notify_all();
+    }
+}
+
+void threadPool_t::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (stopping && tasks.empty()) {
+            return;
+        }
+        runOne(lock);
+    }
+}
@@ -0,0 +1,160 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceActive(false);
+
+namespace {
+
+struct traceEntry_t {
+    std::string name;
+    traceClock_t::time_point begin;
+    traceClock_t::time_point end;
+};
+
+struct traceState_t {
+    std::mutex mutex;
+    traceClock_t::time_point origin;
+    std::vector<traceEntry_t> entries;
+    std::map<std::string, std::string> info;
+    traceClock_t::time_point armedAt;
+    void (*onFirstFrame)() = nullptr;
+    bool armed = false;
+    bool done = false;
+};
+
+traceState_t& traceState() {
+    static traceState_t state;
+    return state;
+}
+
+double millisecondsBetween(traceClock_t::time_point from, traceClock_t::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void traceStart() {
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.origin = traceClock_t::now();
+    state.entries.clear();
+    traceActive.store(true, std::memory_order_relaxed);
+}
+
+void traceRecord(const char* name, traceClock_t::time_point begin, traceClock_t::time_point end) {
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.entries.push_back({name, begin, end});
+}
+
+void traceSetInfo(const std::string& key, const std::string& value) {
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.info[key] = value;
+}
+
+void traceArmFirstFrame(void (*onFirstFrame)()) {
+    if (!traceEnabled()) {
+        return;
+    }
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.armedAt = traceClock_t::now();
+    state.onFirstFrame = onFirstFrame;
+    state.armed = true;
+}
+
+bool traceFrameArmed() {
+    if (!traceEnabled()) {
+        return false;
+    }
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.armed && !state.done;
+}
+
+void traceFrameDrawn() {
+    void (*callback)() = nullptr;
+    {
+        traceState_t& state = traceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.armed || state.done) {
+            return;
+        }
+        state.done = true;
+        state.entries.push_back({"first_frame", state.armedAt, traceClock_t::now()});
+        callback = state.onFirstFrame;
+    }
+    if (callback) {
+        callback();
+    }
+}
+
+bool traceFirstFrameDone() {
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.done;
+}
+
+void traceWriteJson(std::ostream& out) {
+    traceState_t& state = traceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    std::vector<traceEntry_t> entries = state.entries;
+    std::stable_sort(entries.begin(), entries.end(), [](const traceEntry_t& a, const traceEntry_t& b) {
+        return a.begin < b.begin;
+    });
+
+    traceClock_t::time_point last = state.origin;
+    for (const auto& entry : entries) {
+        last = std::max(last, entry.end);
+    }
+
+    out << "{\"info\": {";
+    bool first = true;
+    for (const auto& item : state.info) {
+        out << (first ? "" : ", ");
+        writeJsonString(out, item.first);
+        out << ": ";
+        writeJsonString(out, item.second);
+        first = false;
+    }
+    out << "}, \"first_frame\": " << (state.done ? "true" : "false");
+    out << ", \"total_ms\": " << millisecondsBetween(state.origin, last);
+    out << ", \"phases\": [";
+    for (size_t i = 0; i < entries.size(); i++) {
+        out << (i ? ", " : "") << "{\"name\": ";
+        writeJsonString(out, entries[i].name);
+        out << ", \"start_ms\": " << millisecondsBetween(state.origin, entries[i].begin)
+            << ", \"ms\": " << millisecondsBetween(entries[i].begin, entries[i].end) << "}";
+    }
+    out << "]}\n";
+    out.flush();
+}
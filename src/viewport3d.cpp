@@ -1,6 +1,7 @@
 #include "viewport3d.h"
 #include "Texture2D.h"
 #include "resource.h"
+#include "trace.h"
 
 
 
@@ -107,13 +108,13 @@ void Materialm::apply() const {
 //    }
 //}
 
-void Materialm::loadTextureFromMemory(const unsigned char* data, int width, int height, int channels) {
-    diffuseMapTexture = loadTextureFromMemoryInternal(data, width, height, channels);
+void Materialm::loadTextureFromMemory(const unsigned char* data, int width, int height, int channels, const std::vector<const unsigned char*>& mipLevels) {
+    diffuseMapTexture = loadTextureFromMemoryInternal(data, width, height, channels, mipLevels);
     useTexture = (diffuseMapTexture != 0);
 }
 
 
-GLuint Materialm::loadTextureFromMemoryInternal(const unsigned char* data, int width, int height, int channels) {
+GLuint Materialm::loadTextureFromMemoryInternal(const unsigned char* data, int width, int height, int channels, const std::vector<const unsigned char*>& mipLevels) {
     GLuint textureID = 0;
     glGenTextures(1, &textureID);
 
@@ -132,7 +133,18 @@ GLuint Materialm::loadTextureFromMemoryInternal(const unsigned char* data, int w
 
         // Load the texture data into OpenGL
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        if (mipLevels.empty()) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        } else {
+            // Submit the supplied chain; a chain that stops short of 1x1 is capped so the texture stays complete
+            int levelWidth = width, levelHeight = height;
+            for (size_t i = 0; i < mipLevels.size(); ++i) {
+                levelWidth = std::max(1, levelWidth / 2);
+                levelHeight = std::max(1, levelHeight / 2);
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i + 1), format, levelWidth, levelHeight, 0, format, GL_UNSIGNED_BYTE, mipLevels[i]);
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(mipLevels.size()));
+        }
 
         // Set texture parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Wrap mode on S axis
@@ -225,6 +237,15 @@ Mesh::Mesh(const std::vector<glm::vec3>& vertices, const std::vector<glm::ivec3>
     addRenderMode(Normal);
 }
 
+Mesh::Mesh(std::shared_ptr<const geomCacheEntry_t> cached, const std::vector<Materialm>& materials)
+    : materials(materials), VAO(0), VBO(0), EBO(0), UVVBO(0), UVVAO(0), transform(glm::mat4(1.0f)), isSelected(false),
+      showMaterial(true), showBackfaceCull(false), isTransparent(false), showBoundBox(true), showPivotAxis(true),
+      cachedGeometry(std::move(cached)) {
+    // The entry carries its bounds, so the vertices are never read on the CPU
+    minVertex = glm::vec3(cachedGeometry->boundsMin()[0], cachedGeometry->boundsMin()[1], cachedGeometry->boundsMin()[2]);
+    maxVertex = glm::vec3(cachedGeometry->boundsMax()[0], cachedGeometry->boundsMax()[1], cachedGeometry->boundsMax()[2]);
+    addRenderMode(Normal);
+}
 
 Mesh::~Mesh() {
     // Delete VBO
@@ -260,11 +281,48 @@ glm::vec3 Mesh::evaluateBezierPatch(const std::vector<glm::vec3>& controlPoints,
 }
 
 int Mesh::getVertexCount() const {
-    return vertices.size() / 3;
+    return vertices.empty() && cachedGeometry ? cachedGeometry->vertexCount() : vertices.size() / 3;
 }
 
 int Mesh::getFaceCount() const {
-    return faces.size();
+    return static_cast<int>(triangleCount());
+}
+
+size_t Mesh::triangleCount() const {
+    return faces.empty() && cachedGeometry ? cachedGeometry->vertexCount() / 3 : faces.size();
+}
+
+void Mesh::expandCachedGeometry() {
+    if (!cachedGeometry || !faces.empty()) {
+        return;
+    }
+    size_t vertexCount = cachedGeometry->vertexCount();
+    const geomCacheVertex_t* source = cachedGeometry->vertices();
+    vertices.resize(vertexCount * 3);
+    normals.resize(vertexCount * 3);
+    tverts.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            vertices[i * 3 + k] = source[i].position[k];
+            normals[i * 3 + k] = source[i].normal[k];
+        }
+        tverts[i] = glm::vec2(source[i].texcoord[0], source[i].texcoord[1]);
+    }
+
+    faces.resize(vertexCount / 3);
+    for (size_t f = 0; f < faces.size(); ++f) {
+        int base = static_cast<int>(f * 3);
+        faces[f] = glm::ivec3(base, base + 1, base + 2);
+    }
+    uvFaces = faces;
+
+    faceMaterialIndices.assign(faces.size(), 0);
+    for (size_t m = 0; m < cachedGeometry->materialCount(); ++m) {
+        const uint32_t* indices = cachedGeometry->indices(m);
+        for (size_t i = 0; i < cachedGeometry->indexCount(m); i += 3) {
+            faceMaterialIndices[indices[i] / 3] = static_cast<int>(m);
+        }
+    }
 }
 
 
@@ -824,94 +882,73 @@ void Mesh::toggleMaterial() { showMaterial = !showMaterial; }
 void Mesh::toggleBackfaceCull() { showBackfaceCull = !showBackfaceCull; }
 
 void Mesh::setupMesh() {
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    glGenBuffers(1, &VBO);
-    // No global EBO generation here, as we're using material-specific EBOs
-
-    struct Vertex {
-        glm::vec3 Position;
-        glm::vec3 Normal;
-        glm::vec3 Color;
-        glm::vec2 TexCoord;
-    };
-
-    std::vector<Vertex> interleavedVertices; // Local variable
-    // Since we're handling EBOs per material, we don't need a single indices array
-
-    // Populate interleavedVertices
     if (colors.empty()) {
         colors.resize(vertices.size() * 3, 1.0f);
     }
 
-    for (size_t i = 0; i < faces.size(); ++i) {
-        glm::ivec3 face = faces[i];
-        for (int j = 0; j < 3; ++j) {
-            unsigned int vertexIndex = face[j];
+    std::vector<geomCacheVertex_t> interleavedVertices;
+    std::vector<std::vector<uint32_t>> materialIndices;
+    buildGpuBuffers(interleavedVertices, materialIndices);
 
-            Vertex vertex;
-            vertex.Position = glm::vec3(vertices[vertexIndex * 3],
-                                        vertices[vertexIndex * 3 + 1],
-                                        vertices[vertexIndex * 3 + 2]);
-            vertex.Normal = glm::vec3(normals[vertexIndex * 3],
-                                      normals[vertexIndex * 3 + 1],
-                                      normals[vertexIndex * 3 + 2]);
-            vertex.Color = glm::vec3(colors[vertexIndex * 3],
-                                     colors[vertexIndex * 3 + 1],
-                                     colors[vertexIndex * 3 + 2]);
-            vertex.TexCoord = tverts[vertexIndex];
-
-            interleavedVertices.push_back(vertex);
-        }
+    std::vector<const uint32_t*> indexData;
+    std::vector<size_t> indexCounts;
+    for (const auto& indices : materialIndices) {
+        indexData.push_back(indices.data());
+        indexCounts.push_back(indices.size());
     }
+    uploadGpuBuffers(interleavedVertices.data(), interleavedVertices.size(), indexData, indexCounts);
+}
+
+void Mesh::buildGpuBuffers(std::vector<geomCacheVertex_t>& interleaved, std::vector<std::vector<uint32_t>>& materialIndices) const {
+    // One vertex per face corner; the buffer is not shared between faces
+    const float* colorData = colors.size() >= vertices.size() ? colors.data() : nullptr;
+    geomInterleave(vertices.data(), normals.data(), colorData, reinterpret_cast<const float*>(tverts.data()),
+                   reinterpret_cast<const int*>(faces.data()), faces.size(), faceMaterialIndices.data(), materials.size(),
+                   interleaved, materialIndices);
+}
+
+void Mesh::uploadGpuBuffers(const geomCacheVertex_t* interleaved, size_t vertexCount, const std::vector<const uint32_t*>& materialIndices, const std::vector<size_t>& materialIndexCounts) {
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    glGenBuffers(1, &VBO);
+    // No global EBO generation here, as we're using material-specific EBOs
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER,
-                 interleavedVertices.size() * sizeof(Vertex),
-                 interleavedVertices.data(),
+                 vertexCount * sizeof(geomCacheVertex_t),
+                 interleaved,
                  GL_STATIC_DRAW);
 
     // Define vertex attributes
     // Position
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(geomCacheVertex_t), (void*)offsetof(geomCacheVertex_t, position));
     glEnableVertexAttribArray(0);
     // Normal
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(geomCacheVertex_t), (void*)offsetof(geomCacheVertex_t, normal));
     glEnableVertexAttribArray(1);
     // Color
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Color));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(geomCacheVertex_t), (void*)offsetof(geomCacheVertex_t, color));
     glEnableVertexAttribArray(2);
     // TexCoord
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoord));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(geomCacheVertex_t), (void*)offsetof(geomCacheVertex_t, texcoord));
     glEnableVertexAttribArray(3);
 
     // Now, create separate EBOs for each material
-    materialEBOs.resize(materials.size(), 0);
-    materialCounts.resize(materials.size(), 0);
-
-    for (size_t i = 0; i < materials.size(); ++i) {
-        std::vector<unsigned int> materialIndices;
-        for (size_t f = 0; f < faces.size(); ++f) {
-            if (faceMaterialIndices[f] == static_cast<int>(i)) {
-                // Each face has 3 vertices; calculate the corresponding indices in interleavedVertices
-                unsigned int baseIndex = static_cast<unsigned int>(f * 3);
-                materialIndices.push_back(baseIndex);
-                materialIndices.push_back(baseIndex + 1);
-                materialIndices.push_back(baseIndex + 2);
-            }
-        }
+    materialEBOs.assign(materials.size(), 0);
+    materialCounts.assign(materials.size(), 0);
 
-        if (!materialIndices.empty()) {
+    for (size_t i = 0; i < materials.size() && i < materialIndices.size(); ++i) {
+        if (materialIndexCounts[i] != 0) {
             GLuint ebo;
             glGenBuffers(1, &ebo);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                         materialIndices.size() * sizeof(unsigned int),
-                         materialIndices.data(),
+                         materialIndexCounts[i] * sizeof(uint32_t),
+                         materialIndices[i],
                          GL_STATIC_DRAW);
             materialEBOs[i] = ebo;
-            materialCounts[i] = static_cast<GLsizei>(materialIndices.size());
+            materialCounts[i] = static_cast<GLsizei>(materialIndexCounts[i]);
         }
     }
 
@@ -1152,7 +1189,7 @@ void Mesh::render(const glm::mat4& view, const glm::mat4& projection, const glm:
 
                 // Bind VAO and draw
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
 
                 // Restore the default polygon mode
@@ -1166,7 +1203,7 @@ void Mesh::render(const glm::mat4& view, const glm::mat4& projection, const glm:
                 glUseProgram(shaderProgram);
                 setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 glDisable(GL_POLYGON_OFFSET_FILL);
 
@@ -1179,7 +1216,7 @@ void Mesh::render(const glm::mat4& view, const glm::mat4& projection, const glm:
                 glLineWidth(0.5f);  // Set wire thickness
 
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
 
                 // Restore the default polygon mode
@@ -1195,7 +1232,7 @@ void Mesh::render(const glm::mat4& view, const glm::mat4& projection, const glm:
 
                 // Bind VAO and draw points
                 glBindVertexArray(VAO);
-                glDrawElements(GL_POINTS, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_POINTS, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
 
                 // Reset point size and color
@@ -1208,7 +1245,7 @@ case Normals: {
     glUseProgram(shaderProgram);
     setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 
     // Draw normals
@@ -1236,6 +1273,14 @@ case Normals: {
         glVertex3f(vertex.x, vertex.y, vertex.z);
         glVertex3f(normalEnd.x, normalEnd.y, normalEnd.z);
     }
+    // A cached mesh reads its corners from the entry instead
+    for (size_t i = 0; vertices.empty() && cachedGeometry && i < cachedGeometry->vertexCount(); ++i) {
+        const geomCacheVertex_t& corner = cachedGeometry->vertices()[i];
+        glm::vec3 vertex(corner.position[0], corner.position[1], corner.position[2]);
+        glm::vec3 normalEnd = vertex + 0.1f * glm::normalize(glm::vec3(corner.normal[0], corner.normal[1], corner.normal[2]));
+        glVertex3f(vertex.x, vertex.y, vertex.z);
+        glVertex3f(normalEnd.x, normalEnd.y, normalEnd.z);
+    }
     glEnd();
 
     // Reset color and line width
@@ -1252,7 +1297,7 @@ case Normals: {
                 glUseProgram(shaderProgram);
                 setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 break;
             }
@@ -1270,7 +1315,7 @@ case Normals: {
                 }
 
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
 
                 if (colorOverrideLoc != -1) {
@@ -1284,7 +1329,7 @@ case Normals: {
                 glUseProgram(shaderProgram);
                 setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 drawBoundingBox(view, projection); // Assuming this function is properly implemented
                 break;
@@ -1293,7 +1338,7 @@ case Normals: {
                 glUseProgram(shaderProgram);
                 setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
 
                 // Disable depth testing to ensure pivot is drawn on top
@@ -1314,7 +1359,7 @@ case Normals: {
                 glUseProgram(shaderProgram);
                 setupShader(shaderProgram, view, projection, cameraPos, lightPositions, lightColors);
                 glBindVertexArray(VAO);
-                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(faces.size() * 3), GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(triangleCount() * 3), GL_UNSIGNED_INT, 0);
                 glBindVertexArray(0);
                 break;
             }
@@ -1881,6 +1926,7 @@ void MyGlWindow::linkProgram(GLuint program, GLuint vertexShader, GLuint fragmen
 }
 
 void MyGlWindow::setupMeshes() {
+    tracePhase_t phase("setup_mesh");
     for (auto& mesh : meshes) {
         mesh.setupMesh();
     }
@@ -2302,6 +2348,9 @@ void MyGlWindow::initOpenGL() {
 //    glDeleteShader(outlineShader);
 //    glDeleteShader(outlineFragmentShader);
 
+    // Timed up to the last program link for the first-frame benchmark
+    traceClock_t::time_point shaderBegin = traceClock_t::now();
+
     // Compile Vertex Shader
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     compileShader(vertexShader, gVertexShaderSource);
@@ -2383,6 +2432,7 @@ void MyGlWindow::initOpenGL() {
     glDeleteShader(uvVertexShader);
     glDeleteShader(uvFragmentShader);
 
+    traceRecordSince("compile_shaders", shaderBegin);
 
     meshes.push_back(Mesh()); // Add a default mesh for testing
     setupMeshes();
@@ -2592,6 +2642,9 @@ void MyGlWindow::renderUVs() {
 
     // Render UVs
     for (auto& mesh : meshes) {
+        if (mesh.isSelected) {
+            mesh.expandCachedGeometry();
+        }
         if (mesh.isSelected && !mesh.tverts.empty()) {
             std::vector<glm::vec2> uvLines;
             std::vector<glm::vec2> uvBorders;
@@ -2707,6 +2760,7 @@ void MyGlWindow::renderUVs() {
 
 void MyGlWindow::draw() {
     if (!valid()) {
+        tracePhase_t phase("init_gl");
         initOpenGL();
     }
 
@@ -2721,6 +2775,14 @@ void MyGlWindow::draw() {
 
     glFlush();
     swap_buffers();
+
+    if (traceFrameArmed()) {
+        // Wait for the GPU so the first frame is really on screen
+        glFinish();
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        traceSetInfo("gl_renderer", renderer ? reinterpret_cast<const char*>(renderer) : "unknown");
+        traceFrameDrawn();
+    }
 }
 
 
@@ -2948,6 +3010,20 @@ bool MyGlWindow::rayIntersectsMesh(const glm::vec3& rayOrigin, const glm::vec3&
         return false;
     }
 
+    // A cached mesh is tested against the corners in its entry, three per triangle
+    if (mesh.faces.empty() && mesh.cachedGeometry) {
+        const geomCacheVertex_t* corners = mesh.cachedGeometry->vertices();
+        for (size_t i = 0; i + 2 < mesh.cachedGeometry->vertexCount(); i += 3) {
+            glm::vec3 v0(corners[i].position[0], corners[i].position[1], corners[i].position[2]);
+            glm::vec3 v1(corners[i + 1].position[0], corners[i + 1].position[1], corners[i + 1].position[2]);
+            glm::vec3 v2(corners[i + 2].position[0], corners[i + 2].position[1], corners[i + 2].position[2]);
+            if (rayIntersectsTriangle(rayOrigin, rayDirection, v0, v1, v2, intersectionPoint)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     // If the ray intersects the bounding box, check for intersection with individual triangles
     for (const auto& face : mesh.faces) {
         glm::vec3 v0 = glm::vec3(mesh.vertices[face.x * 3], mesh.vertices[face.x * 3 + 1], mesh.vertices[face.x * 3 + 2]);
@@ -3500,6 +3576,7 @@ Mesh MyGlWindow::addMesh(const std::vector<glm::vec3>& vertices, const std::vect
     }
 
     // Create and add the new mesh
+    tracePhase_t phase("construct_mesh");
     Mesh newMesh(vertices, faces, materialIDs, tverts, materials, normals);
 
     // Store the new mesh
@@ -3507,6 +3584,27 @@ Mesh MyGlWindow::addMesh(const std::vector<glm::vec3>& vertices, const std::vect
     return newMesh;
 }
 
+bool MyGlWindow::addCachedMesh(std::shared_ptr<const geomCacheEntry_t> cache, const std::vector<Materialm>& materials) {
+    if (!cache || cache->vertexCount() == 0 || cache->vertexCount() % 3 != 0 || cache->materialCount() != materials.size()) {
+        std::cerr << "Error: Cached mesh does not match its materials." << std::endl;
+        return false;
+    }
+
+    tracePhase_t phase("construct_mesh");
+
+    // The buffers go from the entry straight to the GPU; the mesh keeps the entry for picking and the UV view
+    std::vector<const uint32_t*> indexData(materials.size());
+    std::vector<size_t> indexCounts(materials.size());
+    for (size_t m = 0; m < materials.size(); ++m) {
+        indexData[m] = cache->indices(m);
+        indexCounts[m] = cache->indexCount(m);
+    }
+
+    meshes.push_back(Mesh(cache, materials));
+    meshes.back().uploadGpuBuffers(cache->vertices(), cache->vertexCount(), indexData, indexCounts);
+    return true;
+}
+
 void MyGlWindow::loadMeshTextures() {
     make_current(); // Ensure context is current before loading textures
             //std::cout << "NumMeshes: \t" << meshes.size() << std::endl;